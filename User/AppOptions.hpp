@@ -0,0 +1,420 @@
+#pragma once
+
+#include "BufferArena.hpp"
+#include "CaptureWriter.hpp"
+#include "ChannelSpec.hpp"
+#include "FanoutServer.hpp"
+#include "PatternMatcher.hpp"
+#include "SocketTransport.hpp"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QString>
+#include <QStringList>
+#include <QThread>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <memory>
+
+/*
+ * 命令行选项：
+ * - --record            录制会话（.ndcap）到 --record-dir；
+ * - --record-dir DIR    录制目录，默认 ./output；
+ * - --replay FILE       回放会话抓包，代替 TCP 服务器；
+ * - --replay-speed X    回放倍速，"max" 表示全速；
+ * - --replay-from S     从录制开始后第 S 秒（可为小数）开始回放，
+ *                       经索引二分定位；
+ * - --capture-fsync P   "保存到文件" 的落盘策略：never、always（每块）、
+ *                       或周期毫秒数，默认 1000；
+ * - --capture-rotate-size SIZE 单个抓包文件的最大字节数，默认 256M，
+ *                       0 表示不按大小轮转；
+ * - --capture-rotate-seconds N 单个抓包文件的最长时间，默认 0（不轮转）；
+ * - --port-queue / --topic-size / --server-buffer / --receive-buffer /
+ *   --max-payload / --socket-backlog SIZE   缓冲区容量，支持 K/M 后缀；
+ * - --max-sessions N    同时服务的设备连接数，默认 4；
+ * - --parse-threads N   解析线程数，默认 min(CPU 核数, 4)；
+ * - --channels LIST     终端通道列表 "name[:title][:tunnel][:pty],..."，
+ *                       缺省时读取 channels.cfg，再缺省为三个默认通道；
+ * - --overflow-policy P 通道未指定时的发送队列溢出策略：block（默认）、
+ *                       drop-oldest、drop-newest；
+ * - --view-mode MODE    终端视图加载方式：eager（全部立即创建）、
+ *                       lazy（首次切换到标签时创建，默认）、
+ *                       single（所有通道共用一个页面与渲染进程）；
+ * - --exit-after-startup 输出启动报告后退出（启动基准使用）；
+ * - --transport MODE    发送策略：latency（TCP_NODELAY，逐段 flush，默认）
+ *                       或 throughput（保留 Nagle，每次唤醒汇集为一次写入）；
+ * - --socket-send-buffer / --socket-receive-buffer SIZE
+ *                       socket 的 SO_SNDBUF / SO_RCVBUF，缺省为系统默认；
+ * - --metrics-export TARGET 周期导出指标快照，TARGET 为文件路径
+ *                       （JSON Lines）或 "udp:HOST:PORT"；
+ * - --metrics-interval MS 指标快照周期，默认 1000 毫秒；
+ * - --headless          无界面运行（QCoreApplication，不加载 QML 与
+ *                       WebEngine），通道输出写到 --output 目标；
+ * - --output RULE       无界面模式的通道输出，可重复，"[通道=]目标"，
+ *                       通道为 Topic 名称或 *（缺省），目标为 -（标准
+ *                       输出）、文件路径、tcp:HOST:PORT 或 udp:HOST:PORT；
+ *                       未指定时全部通道写到标准输出；
+ * - --device-filter NAME 无界面模式的设备名过滤器，缺省广播默认消息；
+ * - --rename NAME       无界面模式下设备上线后重命名；
+ * - --restart-minipc    无界面模式下设备上线后重启 MiniPC；
+ * - --pty               所有通道同时暴露为本地伪终端（Unix），
+ *                       也可在 --channels 中按通道加 pty 标记；
+ * - --pty-dir DIR       伪终端符号链接 netdebug-<通道> 所在目录，默认 /tmp；
+ * - --fanout-port PORT  在 127.0.0.1 上为每个通道开放原始字节分发端口，
+ *                       会话 s 的第 i 个通道为 PORT + s * 通道数 + i；
+ * - --fanout-dir DIR    同时在 DIR/netdebug-<通道>.sock 上开放本地
+ *                       socket（QLocalServer）；
+ * - --fanout-buffer SIZE 每个通道共享日志的容量，默认 1M；
+ * - --fanout-policy P   慢订阅者策略：lag（跳过并计数，默认）或 drop（断开）；
+ * - --scrollback SIZE   每个界面通道保留的历史记录总量，默认 256M，
+ *                       0 表示关闭（只保留 xterm.js 自身的 1000 行）；
+ * - --scrollback-dir DIR 历史记录段文件目录，默认为系统临时目录；
+ * - --alert PATTERN     告警模式，可重复，替换默认的 HardFault、ASSERT、
+ *                       i:watchdog；"re:" 前缀为正则，"i:" 前缀忽略大小写；
+ *                       命中时在终端中反色显示并在状态栏计数；
+ * - --no-alerts         关闭告警匹配。
+ */
+struct AppOptions {
+  bool record = false;
+  QString record_dir = "./output";
+  QString replay_file;
+  double replay_speed = 1.0; /* 0 表示全速 */
+  uint64_t replay_from_us = 0;
+  CaptureWriter::Options capture; /* 各通道 "保存到文件" 的写盘参数 */
+  BufferConfig buffers;
+  int max_sessions = 4;
+  int parse_threads = 0; /* 0 表示按 CPU 核数自动选择 */
+  std::vector<ChannelSpec> channels = ChannelSpec::Defaults();
+  QString view_mode = "lazy";
+  bool exit_after_startup = false;
+  QString metrics_export;
+  int metrics_interval_ms = 1000;
+  TransportOptions transport;
+  bool headless = false;
+  QStringList outputs;
+  QString device_filter;
+  QString rename_device;
+  bool restart_minipc = false;
+  QString pty_dir = "/tmp";
+  FanoutOptions fanout;
+  uint64_t scrollback_bytes = 256ull * 1024 * 1024;
+  QString scrollback_dir;
+  QStringList alert_patterns = {"HardFault", "ASSERT", "i:watchdog"};
+  std::shared_ptr<const PatternSet> alerts; /* 编译结果，各会话共享 */
+
+  bool replaying() const { return !replay_file.isEmpty(); }
+
+  /* 是否请求无界面模式（在创建 QCoreApplication 之前判断应用类型） */
+  static bool HeadlessRequested(int argc, char *argv[]) {
+    for (int i = 1; i < argc; ++i) {
+      if (std::strcmp(argv[i], "--headless") == 0) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  static AppOptions Parse(const QCoreApplication &app) {
+    QCommandLineParser parser;
+    parser.setApplicationDescription("XRobot network debug client");
+    parser.addHelpOption();
+
+    QCommandLineOption record_option("record", "Record the session to disk.");
+    QCommandLineOption record_dir_option(
+        "record-dir", "Directory for session captures.", "dir", "./output");
+    QCommandLineOption replay_option("replay", "Replay a session capture.",
+                                     "file");
+    QCommandLineOption speed_option(
+        "replay-speed", "Replay speed multiplier, or \"max\".", "speed", "1");
+    QCommandLineOption replay_from_option(
+        "replay-from", "Start the replay this many seconds into the capture.",
+        "seconds", "0");
+    parser.addOptions({record_option, record_dir_option, replay_option,
+                       speed_option, replay_from_option});
+
+    QCommandLineOption capture_fsync_option(
+        "capture-fsync",
+        "Save-to-file fsync policy: never, always, or an interval in ms.",
+        "policy", "1000");
+    QCommandLineOption capture_rotate_size_option(
+        "capture-rotate-size", "Rotate save-to-file captures at this size, "
+                               "0 to disable.",
+        "size", "256M");
+    QCommandLineOption capture_rotate_seconds_option(
+        "capture-rotate-seconds",
+        "Rotate save-to-file captures after this many seconds, 0 to disable.",
+        "seconds", "0");
+    parser.addOptions({capture_fsync_option, capture_rotate_size_option,
+                       capture_rotate_seconds_option});
+
+    BufferConfig defaults;
+    QCommandLineOption port_queue_option(
+        "port-queue", "Per-terminal port queue size.", "size",
+        QString::number(defaults.port_queue_bytes));
+    QCommandLineOption topic_size_option(
+        "topic-size", "Maximum topic packet size.", "size",
+        QString::number(defaults.topic_max_bytes));
+    QCommandLineOption server_buffer_option(
+        "server-buffer", "Topic server parse buffer size.", "size",
+        QString::number(defaults.server_buffer_bytes));
+    QCommandLineOption receive_buffer_option(
+        "receive-buffer", "TCP receive buffer size.", "size",
+        QString::number(defaults.receive_buffer_bytes));
+    QCommandLineOption max_payload_option(
+        "max-payload", "Maximum payload per outbound packet.", "size",
+        QString::number(defaults.max_payload_bytes));
+    QCommandLineOption socket_backlog_option(
+        "socket-backlog", "Maximum unsent bytes buffered in the TCP socket.",
+        "size", QString::number(defaults.socket_backlog_bytes));
+    parser.addOptions({port_queue_option, topic_size_option,
+                       server_buffer_option, receive_buffer_option,
+                       max_payload_option, socket_backlog_option});
+
+    QCommandLineOption max_sessions_option(
+        "max-sessions", "Maximum concurrent device connections.", "count",
+        "4");
+    QCommandLineOption parse_threads_option(
+        "parse-threads", "Number of protocol parsing threads.", "count", "0");
+    QCommandLineOption channels_option(
+        "channels",
+        "Terminal channels, \"name[:title][:tunnel][:pty][:policy],...\".",
+        "list");
+    QCommandLineOption overflow_policy_option(
+        "overflow-policy",
+        "Default send queue overflow policy: block, drop-oldest or "
+        "drop-newest.",
+        "policy", "block");
+    parser.addOptions({max_sessions_option, parse_threads_option,
+                       channels_option, overflow_policy_option});
+
+    QCommandLineOption view_mode_option(
+        "view-mode", "Terminal view loading: eager, lazy or single.", "mode",
+        "lazy");
+    QCommandLineOption exit_after_startup_option(
+        "exit-after-startup", "Quit after the startup report.");
+    parser.addOptions({view_mode_option, exit_after_startup_option});
+
+    QCommandLineOption metrics_export_option(
+        "metrics-export",
+        "Export metric snapshots to a file or \"udp:HOST:PORT\".", "target");
+    QCommandLineOption metrics_interval_option(
+        "metrics-interval", "Metric snapshot interval in milliseconds.", "ms",
+        "1000");
+    parser.addOptions({metrics_export_option, metrics_interval_option});
+
+    QCommandLineOption transport_option(
+        "transport", "Socket send strategy: latency or throughput.", "mode",
+        "latency");
+    QCommandLineOption socket_send_buffer_option(
+        "socket-send-buffer", "Socket send buffer size (SO_SNDBUF).", "size");
+    QCommandLineOption socket_receive_buffer_option(
+        "socket-receive-buffer", "Socket receive buffer size (SO_RCVBUF).",
+        "size");
+    parser.addOptions({transport_option, socket_send_buffer_option,
+                       socket_receive_buffer_option});
+
+    QCommandLineOption headless_option(
+        "headless", "Run without the GUI, writing channels to --output.");
+    QCommandLineOption output_option(
+        "output",
+        "Headless channel output \"[channel=]target\"; target is -, a file "
+        "path, tcp:HOST:PORT or udp:HOST:PORT.",
+        "rule");
+    QCommandLineOption device_filter_option(
+        "device-filter", "Device name filter for discovery (headless).",
+        "name");
+    QCommandLineOption rename_option(
+        "rename", "Rename the device once it connects (headless).", "name");
+    QCommandLineOption restart_minipc_option(
+        "restart-minipc", "Restart the MiniPC once the device connects "
+                          "(headless).");
+    parser.addOptions({headless_option, output_option, device_filter_option,
+                       rename_option, restart_minipc_option});
+
+    QCommandLineOption pty_option(
+        "pty", "Expose every channel as a local pseudo-terminal.");
+    QCommandLineOption pty_dir_option(
+        "pty-dir", "Directory for netdebug-<channel> PTY links.", "dir",
+        "/tmp");
+    parser.addOptions({pty_option, pty_dir_option});
+
+    FanoutOptions fanout_defaults;
+    QCommandLineOption fanout_port_option(
+        "fanout-port", "First local TCP port of the per-channel fan-out.",
+        "port", "0");
+    QCommandLineOption fanout_dir_option(
+        "fanout-dir", "Directory for per-channel fan-out local sockets.",
+        "dir");
+    QCommandLineOption fanout_buffer_option(
+        "fanout-buffer", "Per-channel fan-out log size.", "size",
+        QString::number(fanout_defaults.log_bytes));
+    QCommandLineOption fanout_policy_option(
+        "fanout-policy", "Slow fan-out subscriber policy: lag or drop.",
+        "policy", "lag");
+    parser.addOptions({fanout_port_option, fanout_dir_option,
+                       fanout_buffer_option, fanout_policy_option});
+
+    QCommandLineOption scrollback_option(
+        "scrollback", "Scrollback history kept per channel, 0 to disable.",
+        "size", "256M");
+    QCommandLineOption scrollback_dir_option(
+        "scrollback-dir", "Directory for scrollback segment files.", "dir");
+    parser.addOptions({scrollback_option, scrollback_dir_option});
+
+    QCommandLineOption alert_option(
+        "alert",
+        "Alert pattern (repeatable); \"re:\" for a regex, \"i:\" to ignore "
+        "case.",
+        "pattern");
+    QCommandLineOption no_alerts_option("no-alerts",
+                                        "Disable alert pattern matching.");
+    parser.addOptions({alert_option, no_alerts_option});
+    parser.process(app);
+
+    AppOptions options;
+    options.record = parser.isSet(record_option);
+    options.record_dir = parser.value(record_dir_option);
+    options.replay_file = parser.value(replay_option);
+
+    const QString speed = parser.value(speed_option);
+    if (speed.compare("max", Qt::CaseInsensitive) == 0) {
+      options.replay_speed = 0;
+    } else {
+      bool ok = false;
+      options.replay_speed = speed.toDouble(&ok);
+      if (!ok || options.replay_speed <= 0) {
+        options.replay_speed = 1.0;
+      }
+    }
+    const double replay_from = parser.value(replay_from_option).toDouble();
+    options.replay_from_us =
+        replay_from > 0 ? static_cast<uint64_t>(replay_from * 1e6) : 0;
+
+    auto size_value = [&parser](const QCommandLineOption &option,
+                                size_t fallback) {
+      const size_t value = ParseSize(parser.value(option));
+      return value > 0 ? value : fallback;
+    };
+
+    if (!ParseFsyncPolicy(parser.value(capture_fsync_option),
+                          &options.capture)) {
+      APP_LOG_WARN("Unknown capture fsync policy, using 1000 ms");
+    }
+    const QString rotate_size =
+        parser.value(capture_rotate_size_option).trimmed();
+    options.capture.rotate_bytes =
+        rotate_size == "0"
+            ? 0
+            : size_value(capture_rotate_size_option, 256ull * 1024 * 1024);
+    options.capture.rotate_seconds =
+        qMax(0, parser.value(capture_rotate_seconds_option).toInt());
+    BufferConfig &buffers = options.buffers;
+    buffers.port_queue_bytes =
+        size_value(port_queue_option, defaults.port_queue_bytes);
+    buffers.topic_max_bytes =
+        size_value(topic_size_option, defaults.topic_max_bytes);
+    buffers.server_buffer_bytes =
+        size_value(server_buffer_option, defaults.server_buffer_bytes);
+    buffers.receive_buffer_bytes =
+        size_value(receive_buffer_option, defaults.receive_buffer_bytes);
+    buffers.max_payload_bytes =
+        size_value(max_payload_option, defaults.max_payload_bytes);
+    buffers.socket_backlog_bytes =
+        size_value(socket_backlog_option, defaults.socket_backlog_bytes);
+    buffers.Normalize();
+
+    options.max_sessions =
+        qBound(1, parser.value(max_sessions_option).toInt(), 64);
+    options.parse_threads = parser.value(parse_threads_option).toInt();
+    if (options.parse_threads <= 0) {
+      options.parse_threads = qBound(1, QThread::idealThreadCount(), 4);
+    }
+    options.parse_threads = qMin(options.parse_threads, options.max_sessions);
+    OverflowPolicy overflow = OverflowPolicy::BLOCK;
+    if (!ParseOverflowPolicy(parser.value(overflow_policy_option),
+                             &overflow)) {
+      APP_LOG_WARN("Unknown overflow policy, using block");
+    }
+    options.channels =
+        ChannelSpec::Resolve(parser.value(channels_option), overflow);
+
+    const QString view_mode = parser.value(view_mode_option).toLower();
+    if (view_mode == "eager" || view_mode == "lazy" || view_mode == "single") {
+      options.view_mode = view_mode;
+    }
+    options.exit_after_startup = parser.isSet(exit_after_startup_option);
+    options.metrics_export = parser.value(metrics_export_option);
+    options.metrics_interval_ms =
+        qBound(100, parser.value(metrics_interval_option).toInt(), 60000);
+
+    if (!ParseTransportMode(parser.value(transport_option),
+                            &options.transport.mode)) {
+      APP_LOG_WARN("Unknown transport mode, using latency");
+    }
+    options.transport.send_buffer_bytes = static_cast<int>(std::min<size_t>(
+        ParseSize(parser.value(socket_send_buffer_option)), INT_MAX));
+    options.transport.receive_buffer_bytes = static_cast<int>(
+        std::min<size_t>(ParseSize(parser.value(socket_receive_buffer_option)),
+                         INT_MAX));
+
+    options.headless = parser.isSet(headless_option);
+    options.outputs = parser.values(output_option);
+    options.device_filter = parser.value(device_filter_option);
+    options.rename_device = parser.value(rename_option);
+    options.restart_minipc = parser.isSet(restart_minipc_option);
+    options.pty_dir = parser.value(pty_dir_option);
+    if (parser.isSet(pty_option)) {
+      for (ChannelSpec &spec : options.channels) {
+        spec.pty = true;
+      }
+    }
+
+    options.fanout.port = parser.value(fanout_port_option).toUShort();
+    options.fanout.dir = parser.value(fanout_dir_option);
+    options.fanout.log_bytes =
+        size_value(fanout_buffer_option, fanout_defaults.log_bytes);
+    if (!ParseFanoutPolicy(parser.value(fanout_policy_option),
+                           &options.fanout.policy)) {
+      APP_LOG_WARN("Unknown fan-out policy, using lag");
+    }
+
+    const QString scrollback = parser.value(scrollback_option).trimmed();
+    if (scrollback != "0") {
+      options.scrollback_bytes = size_value(
+          scrollback_option, static_cast<size_t>(options.scrollback_bytes));
+    } else {
+      options.scrollback_bytes = 0;
+    }
+    options.scrollback_dir = parser.value(scrollback_dir_option);
+
+    if (parser.isSet(no_alerts_option)) {
+      options.alert_patterns.clear();
+    } else if (parser.isSet(alert_option)) {
+      options.alert_patterns = parser.values(alert_option);
+    }
+    QStringList alert_errors;
+    options.alerts = PatternSet::Compile(options.alert_patterns, &alert_errors);
+    for (const QString &error : alert_errors) {
+      APP_LOG_WARN("Ignoring alert pattern %s", error.toUtf8().constData());
+    }
+    return options;
+  }
+
+  /* 解析 "4096" / "64K" / "1M" 形式的容量，非法时返回 0 */
+  static size_t ParseSize(QString text) {
+    text = text.trimmed().toUpper();
+    size_t scale = 1;
+    if (text.endsWith('K')) {
+      scale = 1024;
+      text.chop(1);
+    } else if (text.endsWith('M')) {
+      scale = 1024 * 1024;
+      text.chop(1);
+    }
+    bool ok = false;
+    const qulonglong value = text.toULongLong(&ok);
+    return ok ? static_cast<size_t>(value) * scale : 0;
+  }
+};
@@ -0,0 +1,231 @@
+#include "AsyncLogger.hpp"
+#include "QTTimebase.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace {
+
+/*
+ * 有界多生产者队列（每个槽位带序号，参考 Vyukov MPMC 队列）：
+ * - 生产者通过 CAS 抢占 tail_，填充完毕后以 release 发布序号；
+ * - 唯一消费者为后台线程，按序号判断槽位是否就绪。
+ */
+AsyncLogger::Entry g_slots[AsyncLogger::kCapacity];
+std::atomic<size_t> g_tail{0};
+size_t g_head = 0;
+
+std::atomic<uint64_t> g_dropped{0};
+std::atomic<bool> g_running{false};
+std::atomic<bool> g_sleeping{false};
+std::mutex g_wake_mutex;
+std::condition_variable g_wake;
+std::thread g_thread;
+
+constexpr std::chrono::milliseconds kIdleWait(50);
+constexpr size_t kLineMax = 512;
+
+void DefaultSink(AsyncLogger::Level, const char *text, size_t len) {
+  std::fwrite(text, 1, len, stderr);
+  std::fputc('\n', stderr);
+}
+
+AsyncLogger::Sink g_sink = DefaultSink;
+
+/* 限流汇总条目没有调用方参数，统一走这个格式化函数 */
+size_t FormatSuppressed(const AsyncLogger::Entry &entry, char *out,
+                        size_t cap) {
+  uint32_t count = 0;
+  std::memcpy(&count, entry.args, sizeof(count));
+  int len = std::snprintf(out, cap, "%u messages suppressed", count);
+  if (len < 0) {
+    return 0;
+  }
+  return static_cast<size_t>(len) < cap ? static_cast<size_t>(len) : cap - 1;
+}
+
+const char *BaseName(const char *path) {
+  const char *name = path;
+  for (const char *p = path; *p != '\0'; ++p) {
+    if (*p == '/' || *p == '\\') {
+      name = p + 1;
+    }
+  }
+  return name;
+}
+
+char LevelTag(AsyncLogger::Level level) {
+  switch (level) {
+  case AsyncLogger::Level::Error:
+    return 'E';
+  case AsyncLogger::Level::Warn:
+    return 'W';
+  case AsyncLogger::Level::Info:
+    return 'I';
+  case AsyncLogger::Level::Debug:
+  default:
+    return 'D';
+  }
+}
+
+/* 格式化并输出一个条目（后台线程） */
+void Emit(const AsyncLogger::Entry &entry) {
+  char line[kLineMax];
+  int prefix = std::snprintf(
+      line, sizeof(line), "[%llu.%06llu][%c](%s:%u) ",
+      static_cast<unsigned long long>(entry.time_us / 1000000),
+      static_cast<unsigned long long>(entry.time_us % 1000000),
+      LevelTag(entry.level), BaseName(entry.file), entry.line);
+  if (prefix < 0) {
+    return;
+  }
+  size_t len = static_cast<size_t>(prefix);
+  if (len >= sizeof(line)) {
+    len = sizeof(line) - 1;
+  }
+  len += entry.format(entry, line + len, sizeof(line) - len);
+  g_sink(entry.level, line, len);
+}
+
+/* 排空当前队列中所有已发布的条目，返回处理条数 */
+size_t Drain() {
+  size_t processed = 0;
+  for (;;) {
+    AsyncLogger::Entry &entry = g_slots[g_head & (AsyncLogger::kCapacity - 1)];
+    if (entry.seq.load(std::memory_order_acquire) != g_head + 1) {
+      break;
+    }
+    Emit(entry);
+    entry.seq.store(g_head + AsyncLogger::kCapacity, std::memory_order_release);
+    ++g_head;
+    ++processed;
+  }
+
+  uint64_t dropped = g_dropped.exchange(0, std::memory_order_relaxed);
+  if (dropped > 0) {
+    char line[64];
+    int len = std::snprintf(line, sizeof(line),
+                            "log queue full, %llu messages dropped",
+                            static_cast<unsigned long long>(dropped));
+    if (len > 0) {
+      g_sink(AsyncLogger::Level::Warn, line, static_cast<size_t>(len));
+    }
+  }
+  return processed;
+}
+
+void ThreadMain() {
+  while (g_running.load(std::memory_order_acquire)) {
+    if (Drain() > 0) {
+      continue;
+    }
+    std::unique_lock<std::mutex> lock(g_wake_mutex);
+    g_sleeping.store(true, std::memory_order_seq_cst);
+    g_wake.wait_for(lock, kIdleWait);
+    g_sleeping.store(false, std::memory_order_relaxed);
+  }
+  Drain();
+}
+
+struct SlotInit {
+  SlotInit() {
+    for (size_t i = 0; i < AsyncLogger::kCapacity; ++i) {
+      g_slots[i].seq.store(i, std::memory_order_relaxed);
+    }
+  }
+} g_slot_init;
+
+} // namespace
+
+void AsyncLogger::SetSink(Sink sink) { g_sink = sink ? sink : DefaultSink; }
+
+void AsyncLogger::Start() {
+  if (g_running.exchange(true)) {
+    return;
+  }
+  g_thread = std::thread(ThreadMain);
+}
+
+void AsyncLogger::Stop() {
+  if (!g_running.exchange(false)) {
+    return;
+  }
+  g_wake.notify_one();
+  g_thread.join();
+}
+
+uint64_t AsyncLogger::Dropped() {
+  return g_dropped.load(std::memory_order_relaxed);
+}
+
+uint64_t AsyncLogger::NowMicros() { return LibXR::QTTimebase::NowMicros(); }
+
+/*
+ * 调用点限流：
+ * - 每个窗口内最多放行 APP_LOG_RATE_LIMIT 条；
+ * - 进入新窗口的第一个调用者负责输出上一窗口的抑制汇总。
+ */
+bool AsyncLogger::Admit(Site &site, Level level, const char *file,
+                        uint32_t line, uint64_t now) {
+  constexpr uint64_t kWindowUs = uint64_t(APP_LOG_RATE_WINDOW_MS) * 1000;
+
+  uint64_t start = site.window_start_us.load(std::memory_order_relaxed);
+  if (now - start >= kWindowUs &&
+      site.window_start_us.compare_exchange_strong(
+          start, now, std::memory_order_relaxed)) {
+    site.count.store(0, std::memory_order_relaxed);
+    uint32_t suppressed =
+        site.suppressed.exchange(0, std::memory_order_relaxed);
+    if (suppressed > 0) {
+      Entry *entry = Acquire();
+      if (entry != nullptr) {
+        entry->fmt = nullptr;
+        entry->file = file;
+        entry->line = line;
+        entry->level = level;
+        entry->time_us = now;
+        entry->format = FormatSuppressed;
+        std::memcpy(entry->args, &suppressed, sizeof(suppressed));
+        entry->arg_size = sizeof(suppressed);
+        Publish(entry);
+      }
+    }
+  }
+
+  if (site.count.fetch_add(1, std::memory_order_relaxed) < APP_LOG_RATE_LIMIT) {
+    return true;
+  }
+  site.suppressed.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+AsyncLogger::Entry *AsyncLogger::Acquire() {
+  size_t pos = g_tail.load(std::memory_order_relaxed);
+  for (;;) {
+    Entry &entry = g_slots[pos & (kCapacity - 1)];
+    size_t seq = entry.seq.load(std::memory_order_acquire);
+    intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+    if (diff == 0) {
+      if (g_tail.compare_exchange_weak(pos, pos + 1,
+                                       std::memory_order_relaxed)) {
+        return &entry;
+      }
+    } else if (diff < 0) {
+      g_dropped.fetch_add(1, std::memory_order_relaxed);
+      return nullptr;
+    } else {
+      pos = g_tail.load(std::memory_order_relaxed);
+    }
+  }
+}
+
+void AsyncLogger::Publish(Entry *entry) {
+  /* 抢占时槽位序号等于入队位置，发布后变为“入队位置 + 1” */
+  size_t seq = entry->seq.load(std::memory_order_relaxed);
+  entry->seq.store(seq + 1, std::memory_order_release);
+  if (g_sleeping.load(std::memory_order_seq_cst)) {
+    g_wake.notify_one();
+  }
+}
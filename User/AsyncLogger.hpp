@@ -0,0 +1,256 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+/*
+ * 编译期日志等级（与 LIBXR_LOG_LEVEL 含义一致）：
+ *  0 = 关闭，1 = ERROR，2 = WARN，3 = INFO，4 = DEBUG；
+ * 低于该等级的 APP_LOG_* 宏展开为空语句，参数不会被求值。
+ */
+#ifndef APP_LOG_LEVEL
+#define APP_LOG_LEVEL 3
+#endif
+
+/* 每个调用点在一个时间窗口内允许输出的最大条数 */
+#ifndef APP_LOG_RATE_LIMIT
+#define APP_LOG_RATE_LIMIT 20
+#endif
+
+/* 限流时间窗口（毫秒） */
+#ifndef APP_LOG_RATE_WINDOW_MS
+#define APP_LOG_RATE_WINDOW_MS 1000
+#endif
+
+namespace async_log_detail {
+
+/*
+ * 参数编解码：
+ * - 算术类型、枚举和普通指针按值拷贝；
+ * - C 字符串在入队时拷贝内容（调用方的临时字符串可能立即失效）；
+ * - 解码得到的字符串指针指向条目内部存储，仅在格式化期间有效。
+ */
+template <typename T, typename Enable = void> struct ArgCodec {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "log arguments must be trivially copyable");
+  using Decoded = T;
+
+  static size_t Encode(uint8_t *dst, size_t cap, const T &value) {
+    if (cap < sizeof(T)) {
+      return 0;
+    }
+    std::memcpy(dst, &value, sizeof(T));
+    return sizeof(T);
+  }
+
+  static Decoded Decode(const uint8_t *&src, const uint8_t *end) {
+    T value{};
+    if (static_cast<size_t>(end - src) >= sizeof(T)) {
+      std::memcpy(&value, src, sizeof(T));
+      src += sizeof(T);
+    }
+    return value;
+  }
+};
+
+template <typename T>
+struct ArgCodec<T, typename std::enable_if<
+                       std::is_same<T, const char *>::value ||
+                       std::is_same<T, char *>::value>::type> {
+  using Decoded = const char *;
+
+  static size_t Encode(uint8_t *dst, size_t cap, const char *value) {
+    if (cap == 0) {
+      return 0;
+    }
+    if (value == nullptr) {
+      value = "(null)";
+    }
+    size_t len = std::strlen(value);
+    if (len > cap - 1) {
+      len = cap - 1;
+    }
+    std::memcpy(dst, value, len);
+    dst[len] = '\0';
+    return len + 1;
+  }
+
+  static Decoded Decode(const uint8_t *&src, const uint8_t *end) {
+    if (src >= end) {
+      return "";
+    }
+    const char *value = reinterpret_cast<const char *>(src);
+    src += std::strlen(value) + 1;
+    return value;
+  }
+};
+
+#if defined(__GNUC__) || defined(__clang__)
+/* 仅用于编译期 printf 格式检查，永远不会被调用 */
+__attribute__((format(printf, 1, 2))) inline void CheckFormat(const char *,
+                                                              ...) {}
+#else
+inline void CheckFormat(const char *, ...) {}
+#endif
+
+} // namespace async_log_detail
+
+/*
+ * AsyncLogger：异步日志后端
+ * - 调用线程只把格式串指针和参数写入无锁环形队列（不做格式化）；
+ * - 后台线程负责格式化并写入输出端（sink）；
+ * - 每个调用点独立限流，被抑制的条数在下一个窗口以汇总形式输出；
+ * - 队列满时直接丢弃并计数，永不阻塞调用线程。
+ */
+class AsyncLogger {
+public:
+  enum class Level : uint8_t { Error = 1, Warn = 2, Info = 3, Debug = 4 };
+
+  /* 输出端：收到一行已格式化的文本（不含换行） */
+  using Sink = void (*)(Level level, const char *text, size_t len);
+
+  /* 调用点状态（由宏在每个调用点生成一个静态实例） */
+  struct Site {
+    std::atomic<uint64_t> window_start_us{0};
+    std::atomic<uint32_t> count{0};
+    std::atomic<uint32_t> suppressed{0};
+  };
+
+  static constexpr size_t kArgBytes = 192;
+  static constexpr size_t kCapacity = 1024; /* 必须为 2 的幂 */
+
+  struct Entry {
+    std::atomic<size_t> seq{0};
+    const char *fmt = nullptr;
+    const char *file = nullptr;
+    uint32_t line = 0;
+    Level level = Level::Info;
+    uint64_t time_us = 0;
+    size_t (*format)(const Entry &entry, char *out, size_t cap) = nullptr;
+    uint16_t arg_size = 0;
+    alignas(8) uint8_t args[kArgBytes];
+  };
+
+  /* 设置输出端，需在 Start() 之前调用 */
+  static void SetSink(Sink sink);
+
+  /* 启动后台格式化线程 */
+  static void Start();
+
+  /* 排空队列并停止后台线程 */
+  static void Stop();
+
+  /* 因队列满被丢弃的条数 */
+  static uint64_t Dropped();
+
+  /* 当前单调时间（微秒，与 QTTimebase 同一时钟） */
+  static uint64_t NowMicros();
+
+  template <typename... Args>
+  static void Submit(Site &site, Level level, const char *file, uint32_t line,
+                     const char *fmt, const Args &...args) {
+    const uint64_t now = NowMicros();
+    if (!Admit(site, level, file, line, now)) {
+      return;
+    }
+
+    Entry *entry = Acquire();
+    if (entry == nullptr) {
+      return;
+    }
+
+    entry->fmt = fmt;
+    entry->file = file;
+    entry->line = line;
+    entry->level = level;
+    entry->time_us = now;
+    entry->format = &FormatEntry<typename std::decay<Args>::type...>;
+
+    size_t used = 0;
+    (void)std::initializer_list<int>{
+        (used += async_log_detail::ArgCodec<typename std::decay<Args>::type>::
+             Encode(entry->args + used, kArgBytes - used, args),
+         0)...};
+    entry->arg_size = static_cast<uint16_t>(used);
+
+    Publish(entry);
+  }
+
+private:
+  template <typename... Args>
+  static size_t FormatEntry(const Entry &entry, char *out, size_t cap) {
+    const uint8_t *src = entry.args;
+    const uint8_t *end = entry.args + entry.arg_size;
+    /* 花括号初始化保证参数按从左到右的顺序解码 */
+    std::tuple<typename async_log_detail::ArgCodec<Args>::Decoded...> decoded{
+        async_log_detail::ArgCodec<Args>::Decode(src, end)...};
+    (void)src;
+    (void)end;
+    return Apply(entry.fmt, out, cap, decoded,
+                 std::index_sequence_for<Args...>{});
+  }
+
+  template <typename Tuple, size_t... I>
+  static size_t Apply(const char *fmt, char *out, size_t cap,
+                      const Tuple &tuple, std::index_sequence<I...>) {
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#pragma GCC diagnostic ignored "-Wformat-security"
+#endif
+    int len = std::snprintf(out, cap, fmt, std::get<I>(tuple)...);
+#if defined(__GNUC__) || defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+    if (len < 0) {
+      return 0;
+    }
+    return static_cast<size_t>(len) < cap ? static_cast<size_t>(len) : cap - 1;
+  }
+
+  static bool Admit(Site &site, Level level, const char *file, uint32_t line,
+                    uint64_t now);
+  static Entry *Acquire();
+  static void Publish(Entry *entry);
+};
+
+#define APP_LOG_IMPL(level, fmt, ...)                                          \
+  do {                                                                         \
+    if (false) {                                                               \
+      async_log_detail::CheckFormat(fmt, ##__VA_ARGS__);                       \
+    }                                                                          \
+    static AsyncLogger::Site app_log_site_;                                    \
+    AsyncLogger::Submit(app_log_site_, level, __FILE__, __LINE__, fmt,         \
+                        ##__VA_ARGS__);                                        \
+  } while (0)
+
+#if APP_LOG_LEVEL >= 1
+#define APP_LOG_ERROR(...) APP_LOG_IMPL(AsyncLogger::Level::Error, __VA_ARGS__)
+#else
+#define APP_LOG_ERROR(...) ((void)0)
+#endif
+
+#if APP_LOG_LEVEL >= 2
+#define APP_LOG_WARN(...) APP_LOG_IMPL(AsyncLogger::Level::Warn, __VA_ARGS__)
+#else
+#define APP_LOG_WARN(...) ((void)0)
+#endif
+
+#if APP_LOG_LEVEL >= 3
+#define APP_LOG_INFO(...) APP_LOG_IMPL(AsyncLogger::Level::Info, __VA_ARGS__)
+#else
+#define APP_LOG_INFO(...) ((void)0)
+#endif
+
+#if APP_LOG_LEVEL >= 4
+#define APP_LOG_DEBUG(...) APP_LOG_IMPL(AsyncLogger::Level::Debug, __VA_ARGS__)
+#else
+#define APP_LOG_DEBUG(...) ((void)0)
+#endif
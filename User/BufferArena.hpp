@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+/*
+ * 缓冲区容量配置（运行时由命令行指定）：
+ * - 默认值按 512 字节分包的串口流量估算，而不是按 1 MiB 上限预留；
+ * - 通道较多或内存较小时可整体调小，大流量时可调大。
+ */
+struct BufferConfig {
+  size_t port_queue_bytes = 64 * 1024;      /* 每个终端 ReadPort/WritePort 队列 */
+  size_t write_queue_depth = 64;            /* WritePort 操作队列深度 */
+  size_t topic_max_bytes = 16 * 1024;       /* 单个 Topic 包最大负载 */
+  size_t server_buffer_bytes = 256 * 1024;  /* Topic::Server 解析缓冲区 */
+  size_t receive_buffer_bytes = 256 * 1024; /* TCP 接收缓冲区 */
+  size_t max_payload_bytes = 512;           /* sendText 单包最大负载 */
+  size_t socket_backlog_bytes = 256 * 1024; /* socket 写缓冲上限（bytesToWrite） */
+
+  /* 修正互相依赖的下限 */
+  void Normalize() {
+    max_payload_bytes = std::max<size_t>(max_payload_bytes, 16);
+    topic_max_bytes = std::max(topic_max_bytes, max_payload_bytes + 64);
+    server_buffer_bytes = std::max(server_buffer_bytes, topic_max_bytes * 2);
+    port_queue_bytes = std::max(port_queue_bytes, max_payload_bytes * 4);
+    receive_buffer_bytes = std::max<size_t>(receive_buffer_bytes, 4096);
+    write_queue_depth = std::max<size_t>(write_queue_depth, 4);
+    socket_backlog_bytes =
+        std::max(socket_backlog_bytes, topic_max_bytes + 64);
+  }
+};
+
+/*
+ * BufferArena：共享缓冲区分配器
+ * - 按块（默认 256 KiB）向系统申请，块内顺序切分，整体随所有者释放；
+ * - 每次分配带标签，可随时查询各标签占用，用于启动与运行时的内存报告；
+ * - LibXR 内部自行分配的队列无法从这里切分，通过 Account() 登记容量，
+ *   使报告覆盖全部主要缓冲区。
+ */
+class BufferArena {
+public:
+  struct Usage {
+    const char *tag;
+    size_t bytes;
+    bool external; /* true 表示仅登记、不由 arena 分配 */
+  };
+
+  explicit BufferArena(size_t block_bytes = 256 * 1024)
+      : block_bytes_(block_bytes) {}
+
+  BufferArena(const BufferArena &) = delete;
+  BufferArena &operator=(const BufferArena &) = delete;
+
+  ~BufferArena() {
+    for (const Block &block : blocks_) {
+      ::operator delete(block.data, std::align_val_t(kAlign));
+    }
+  }
+
+  /* 分配 size 字节（kAlign 对齐），失败时抛出 std::bad_alloc */
+  void *Allocate(size_t size, const char *tag) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size = (size + kAlign - 1) / kAlign * kAlign;
+
+    uint8_t *result = nullptr;
+    if (size > block_bytes_ / 2) {
+      /* 大请求单独成块，插在当前块之前，不影响当前块继续切分 */
+      result = NewBlock(size);
+      blocks_.insert(blocks_.empty() ? blocks_.end() : blocks_.end() - 1,
+                     Block{result, size, size});
+    } else {
+      if (blocks_.empty() || blocks_.back().used + size > blocks_.back().size) {
+        blocks_.push_back(Block{NewBlock(block_bytes_), block_bytes_, 0});
+      }
+      Block &block = blocks_.back();
+      result = block.data + block.used;
+      block.used += size;
+    }
+
+    used_ += size;
+    usages_.push_back({tag, size, false});
+    return result;
+  }
+
+  template <typename T> T *AllocateArray(size_t count, const char *tag) {
+    static_assert(alignof(T) <= kAlign, "alignment exceeds arena alignment");
+    return static_cast<T *>(Allocate(sizeof(T) * count, tag));
+  }
+
+  /* 登记由其他分配器持有的缓冲区容量 */
+  void Account(const char *tag, size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    external_ += bytes;
+    usages_.push_back({tag, bytes, true});
+  }
+
+  size_t Used() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return used_;
+  }
+
+  size_t Reserved() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return reserved_;
+  }
+
+  size_t External() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return external_;
+  }
+
+  std::vector<Usage> Usages() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return usages_;
+  }
+
+  static constexpr size_t kAlign = 64;
+
+private:
+  uint8_t *NewBlock(size_t size) {
+    auto *data =
+        static_cast<uint8_t *>(::operator new(size, std::align_val_t(kAlign)));
+    reserved_ += size;
+    return data;
+  }
+
+  struct Block {
+    uint8_t *data;
+    size_t size;
+    size_t used;
+  };
+
+  size_t block_bytes_;
+  mutable std::mutex mutex_;
+  std::vector<Block> blocks_;
+  std::vector<Usage> usages_;
+  size_t used_ = 0;
+  size_t reserved_ = 0;
+  size_t external_ = 0;
+};
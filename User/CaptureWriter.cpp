@@ -0,0 +1,314 @@
+#include "CaptureWriter.hpp"
+#include "AsyncLogger.hpp"
+
+#include <QDateTime>
+#include <QDir>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <new>
+
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr size_t kBlockAlign = 4096;
+
+int64_t NowMs() {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+size_t RoundUpPow2(size_t value) {
+  size_t result = 1;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+} // namespace
+
+CaptureWriter::CaptureWriter(const Options &options) : options_(options) {
+  if (options_.block_bytes < kBlockAlign) {
+    options_.block_bytes = kBlockAlign;
+  }
+  options_.block_bytes =
+      (options_.block_bytes + kBlockAlign - 1) / kBlockAlign * kBlockAlign;
+  options_.ring_bytes =
+      RoundUpPow2(std::max(options_.ring_bytes, options_.block_bytes * 2));
+
+  ring_ = new uint8_t[options_.ring_bytes];
+  mask_ = options_.ring_bytes - 1;
+  block_ = static_cast<uint8_t *>(
+      ::operator new(options_.block_bytes, std::align_val_t(kBlockAlign)));
+
+  thread_ = std::thread(&CaptureWriter::Run, this);
+}
+
+CaptureWriter::~CaptureWriter() {
+  stop_.store(true, std::memory_order_release);
+  {
+    std::lock_guard<std::mutex> lock(wake_mutex_);
+  }
+  wake_.notify_one();
+  thread_.join();
+
+  ::operator delete(block_, std::align_val_t(kBlockAlign));
+  delete[] ring_;
+}
+
+bool CaptureWriter::Append(const void *data, size_t size) {
+  return Append(data, size, nullptr, 0);
+}
+
+bool CaptureWriter::Append(const void *first, size_t first_size,
+                           const void *second, size_t second_size) {
+  const uint64_t head = head_.load(std::memory_order_relaxed);
+  const uint64_t tail = tail_.load(std::memory_order_acquire);
+  const size_t size = first_size + second_size;
+
+  if (failed_.load(std::memory_order_acquire) ||
+      size > options_.ring_bytes - static_cast<size_t>(head - tail)) {
+    dropped_.fetch_add(size, std::memory_order_relaxed);
+    return false;
+  }
+
+  CopyIn(head, first, first_size);
+  CopyIn(head + first_size, second, second_size);
+  head_.store(head + size, std::memory_order_release);
+
+  /* 攒够一块才唤醒写线程，小包由写线程的空闲超时带走 */
+  if (head + size - tail >= options_.block_bytes) {
+    Wake();
+  }
+  return true;
+}
+
+void CaptureWriter::CopyIn(uint64_t position, const void *data, size_t size) {
+  if (size == 0) {
+    return;
+  }
+  const size_t offset = static_cast<size_t>(position) & mask_;
+  const size_t first = std::min(size, options_.ring_bytes - offset);
+  std::memcpy(ring_ + offset, data, first);
+  std::memcpy(ring_, static_cast<const uint8_t *>(data) + first, size - first);
+}
+
+void CaptureWriter::Flush() {
+  flush_requested_.store(true, std::memory_order_release);
+  Wake();
+}
+
+void CaptureWriter::Close() {
+  close_at_.store(head_.load(std::memory_order_acquire),
+                  std::memory_order_release);
+  Wake();
+}
+
+void CaptureWriter::Wake() {
+  if (sleeping_.load(std::memory_order_seq_cst)) {
+    wake_.notify_one();
+  }
+}
+
+/*
+ * 写线程主循环：
+ * - 满块立即写出，不足一块的数据最多滞留 idle_flush_ms；
+ * - 关闭请求在其之前追加的数据全部写出后执行；
+ * - 退出前写出所有残留数据并关闭文件。
+ */
+void CaptureWriter::Run() {
+  for (;;) {
+    const bool stopping = stop_.load(std::memory_order_acquire);
+    const bool flush = flush_requested_.exchange(false);
+    const uint64_t close_at = close_at_.load(std::memory_order_acquire);
+
+    size_t written = 0;
+    size_t chunk = 0;
+    while ((chunk = DrainOnce(false)) > 0) {
+      written += chunk;
+    }
+
+    const uint64_t tail = tail_.load(std::memory_order_relaxed);
+    const bool closing = close_at != UINT64_MAX && tail < close_at;
+    if (stopping || flush || closing || written == 0) {
+      /* 空闲超时、显式刷新或关闭/退出时写出不足一块的残留 */
+      while (DrainOnce(true) > 0) {
+      }
+    }
+
+    if (file_ != nullptr) {
+      const int64_t now = NowMs();
+      if (options_.fsync == FsyncPolicy::Interval && dirty_ &&
+          now - last_sync_ms_ >= options_.fsync_interval_ms) {
+        SyncFile();
+      }
+      if (options_.rotate_seconds > 0 &&
+          now - file_opened_ms_ >= int64_t(options_.rotate_seconds) * 1000) {
+        CloseFile();
+      }
+    }
+
+    if (close_at != UINT64_MAX &&
+        tail_.load(std::memory_order_relaxed) >= close_at) {
+      uint64_t expected = close_at;
+      close_at_.compare_exchange_strong(expected, UINT64_MAX);
+      CloseFile();
+    }
+
+    if (stopping) {
+      break;
+    }
+
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    sleeping_.store(true, std::memory_order_seq_cst);
+    const uint64_t pending = head_.load(std::memory_order_acquire) -
+                             tail_.load(std::memory_order_relaxed);
+    if (pending < options_.block_bytes &&
+        !stop_.load(std::memory_order_acquire) &&
+        !flush_requested_.load(std::memory_order_acquire)) {
+      wake_.wait_for(lock, std::chrono::milliseconds(options_.idle_flush_ms));
+    }
+    sleeping_.store(false, std::memory_order_relaxed);
+  }
+
+  CloseFile();
+}
+
+/*
+ * 从环形缓冲区取出一块写盘：
+ * - partial 为 false 时只处理满块；
+ * - 返回写出的字节数。
+ */
+size_t CaptureWriter::DrainOnce(bool partial) {
+  const uint64_t tail = tail_.load(std::memory_order_relaxed);
+  const uint64_t head = head_.load(std::memory_order_acquire);
+  const size_t available = static_cast<size_t>(head - tail);
+
+  if (available == 0 || (!partial && available < options_.block_bytes)) {
+    return 0;
+  }
+
+  const size_t size = std::min(available, options_.block_bytes);
+  const size_t offset = static_cast<size_t>(tail) & mask_;
+  const size_t first = std::min(size, options_.ring_bytes - offset);
+  std::memcpy(block_, ring_ + offset, first);
+  std::memcpy(block_ + first, ring_, size - first);
+  tail_.store(tail + size, std::memory_order_release);
+
+  WriteOut(block_, size);
+  return size;
+}
+
+/*
+ * 写出一块数据：
+ * - stop_on_error 时打开或写入失败即标记失败，之后的块不再落盘，
+ *   保证文件内容是已追加数据的完整前缀；
+ */
+void CaptureWriter::WriteOut(const uint8_t *data, size_t size) {
+  if (failed_.load(std::memory_order_relaxed)) {
+    dropped_.fetch_add(size, std::memory_order_relaxed);
+    return;
+  }
+
+  if (file_ != nullptr && options_.rotate_bytes > 0 && file_bytes_ > 0 &&
+      file_bytes_ + size > options_.rotate_bytes) {
+    CloseFile();
+  }
+
+  if (file_ == nullptr && !OpenFile()) {
+    dropped_.fetch_add(size, std::memory_order_relaxed);
+    if (options_.stop_on_error) {
+      failed_.store(true, std::memory_order_release);
+    }
+    return;
+  }
+
+  const size_t n = std::fwrite(data, 1, size, file_);
+  if (n != size) {
+    dropped_.fetch_add(size - n, std::memory_order_relaxed);
+    APP_LOG_ERROR("Capture write failed, %zu of %zu bytes written", n, size);
+    if (options_.stop_on_error) {
+      failed_.store(true, std::memory_order_release);
+    }
+  }
+  file_bytes_ += n;
+  dirty_ = true;
+  written_.fetch_add(n, std::memory_order_relaxed);
+
+  if (options_.fsync == FsyncPolicy::EveryWrite) {
+    SyncFile();
+  }
+}
+
+/*
+ * 懒创建抓包文件：
+ * - 文件名为 “时间戳 + 名称 + 扩展名”，时间戳不含冒号以兼容 Windows；
+ * - 同一秒内轮转时追加序号，避免覆盖上一个文件；
+ */
+bool CaptureWriter::OpenFile() {
+  QDir().mkpath(options_.directory);
+
+  const QString stamp =
+      QDateTime::currentDateTime().toString("yyyy-MM-dd_HH-mm-ss");
+  if (stamp == last_stamp_) {
+    ++sequence_;
+  } else {
+    last_stamp_ = stamp;
+    sequence_ = 0;
+  }
+
+  QString path = options_.directory + "/" + stamp + "_" + options_.name;
+  if (sequence_ > 0) {
+    path += QString("_%1").arg(sequence_, 3, 10, QChar('0'));
+  }
+  path += options_.suffix;
+
+  file_ = std::fopen(path.toLocal8Bit().constData(), "wb");
+  if (file_ == nullptr) {
+    APP_LOG_ERROR("Failed to open capture file %s",
+                  path.toLocal8Bit().constData());
+    return false;
+  }
+
+  /* 已按块组织写入，关闭 stdio 缓冲以免二次拷贝 */
+  std::setvbuf(file_, nullptr, _IONBF, 0);
+
+  file_bytes_ = 0;
+  file_opened_ms_ = NowMs();
+  last_sync_ms_ = file_opened_ms_;
+  dirty_ = false;
+  files_.fetch_add(1, std::memory_order_relaxed);
+
+  APP_LOG_INFO("Capture file opened: %s", path.toLocal8Bit().constData());
+  return true;
+}
+
+void CaptureWriter::CloseFile() {
+  if (file_ == nullptr) {
+    return;
+  }
+  if (options_.fsync != FsyncPolicy::Never && dirty_) {
+    SyncFile();
+  }
+  std::fclose(file_);
+  file_ = nullptr;
+}
+
+void CaptureWriter::SyncFile() {
+  std::fflush(file_);
+#if defined(_WIN32)
+  _commit(_fileno(file_));
+#else
+  ::fsync(fileno(file_));
+#endif
+  dirty_ = false;
+  last_sync_ms_ = NowMs();
+}
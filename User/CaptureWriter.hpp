@@ -0,0 +1,142 @@
+#pragma once
+
+#include <QString>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <thread>
+
+/*
+ * CaptureWriter：后台抓包写盘
+ * - 生产者（Topic 回调线程）只把数据拷入无锁单生产者/单消费者环形缓冲区；
+ * - 独立写线程按块（默认 64 KiB，4 KiB 对齐缓冲）整块写盘；
+ * - 文件在第一次有数据写出时才创建，支持按大小/时间轮转；
+ * - fsync 策略可配置，磁盘延迟不会反压到解析线程，缓冲区满时丢弃并计数。
+ */
+class CaptureWriter {
+public:
+  enum class FsyncPolicy : uint8_t {
+    Never,     /* 只交给操作系统缓存 */
+    Interval,  /* 按 fsync_interval_ms 周期落盘 */
+    EveryWrite /* 每次块写入后落盘 */
+  };
+
+  struct Options {
+    QString directory = "./output"; /* 输出目录 */
+    QString name;                   /* 文件名主体，如 "uart1" */
+    QString suffix = ".output";     /* 扩展名 */
+    size_t ring_bytes = 4 * 1024 * 1024; /* 环形缓冲区大小（2 的幂） */
+    size_t block_bytes = 64 * 1024;      /* 单次写盘块大小 */
+    int idle_flush_ms = 200;             /* 不足一块时的最长滞留时间 */
+    FsyncPolicy fsync = FsyncPolicy::Interval;
+    int fsync_interval_ms = 1000;
+    uint64_t rotate_bytes = 0; /* 单文件最大字节数，0 表示不按大小轮转 */
+    int rotate_seconds = 0;    /* 单文件最长时间，0 表示不按时间轮转 */
+    bool stop_on_error = false; /* 写盘失败后停止写入，避免文件中间缺块 */
+  };
+
+  explicit CaptureWriter(const Options &options);
+  ~CaptureWriter();
+
+  CaptureWriter(const CaptureWriter &) = delete;
+  CaptureWriter &operator=(const CaptureWriter &) = delete;
+
+  /*
+   * 追加数据（仅限单一生产者线程）：
+   * - 只做一次内存拷贝，不触碰文件；
+   * - 空间不足时整段丢弃并返回 false。
+   */
+  bool Append(const void *data, size_t size);
+
+  /*
+   * 聚合追加两段数据（例如记录头 + 负载），要么全部写入要么全部丢弃；
+   */
+  bool Append(const void *first, size_t first_size, const void *second,
+              size_t second_size);
+
+  /* 请求写线程尽快写出不足一块的残留数据 */
+  void Flush();
+
+  /* 写完已追加的数据后关闭当前文件，下次有数据时创建新文件 */
+  void Close();
+
+  uint64_t Written() const { return written_.load(std::memory_order_relaxed); }
+  uint64_t Dropped() const { return dropped_.load(std::memory_order_relaxed); }
+  uint64_t Files() const { return files_.load(std::memory_order_relaxed); }
+
+  /* stop_on_error 时写盘失败后为 true，此后追加的数据全部丢弃 */
+  bool Failed() const { return failed_.load(std::memory_order_acquire); }
+
+private:
+  void Run();
+  size_t DrainOnce(bool partial);
+  void WriteOut(const uint8_t *data, size_t size);
+  bool OpenFile();
+  void CloseFile();
+  void SyncFile();
+  void Wake();
+  void CopyIn(uint64_t position, const void *data, size_t size);
+
+  Options options_;
+
+  /* 环形缓冲区：head_ 由生产者推进，tail_ 由写线程推进 */
+  uint8_t *ring_ = nullptr;
+  size_t mask_ = 0;
+  std::atomic<uint64_t> head_{0};
+  std::atomic<uint64_t> tail_{0};
+
+  /* 对齐的写盘暂存块 */
+  uint8_t *block_ = nullptr;
+
+  /* 写线程状态 */
+  std::thread thread_;
+  std::mutex wake_mutex_;
+  std::condition_variable wake_;
+  std::atomic<bool> sleeping_{false};
+  std::atomic<bool> stop_{false};
+  std::atomic<bool> flush_requested_{false};
+  std::atomic<uint64_t> close_at_{UINT64_MAX};
+
+  /* 以下仅由写线程访问 */
+  std::FILE *file_ = nullptr;
+  uint64_t file_bytes_ = 0;
+  int64_t file_opened_ms_ = 0;
+  int64_t last_sync_ms_ = 0;
+  bool dirty_ = false;
+  QString last_stamp_;   /* 上一个文件名中的时间戳 */
+  uint32_t sequence_ = 0; /* 同一时间戳内的序号 */
+
+  std::atomic<uint64_t> written_{0};
+  std::atomic<uint64_t> dropped_{0};
+  std::atomic<uint64_t> files_{0};
+  std::atomic<bool> failed_{false};
+};
+
+/*
+ * 解析 fsync 策略：never、always（每块落盘）、interval 或毫秒数
+ * （按该周期落盘），非法时返回 false；
+ */
+inline bool ParseFsyncPolicy(const QString &text,
+                             CaptureWriter::Options *options) {
+  const QString name = text.trimmed().toLower();
+  if (name == "never") {
+    options->fsync = CaptureWriter::FsyncPolicy::Never;
+  } else if (name == "always") {
+    options->fsync = CaptureWriter::FsyncPolicy::EveryWrite;
+  } else if (name == "interval") {
+    options->fsync = CaptureWriter::FsyncPolicy::Interval;
+  } else {
+    bool ok = false;
+    const int interval_ms = name.toInt(&ok);
+    if (!ok || interval_ms <= 0) {
+      return false;
+    }
+    options->fsync = CaptureWriter::FsyncPolicy::Interval;
+    options->fsync_interval_ms = interval_ms;
+  }
+  return true;
+}
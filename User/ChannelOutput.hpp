@@ -0,0 +1,184 @@
+#pragma once
+
+#include "AsyncLogger.hpp"
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QHostAddress>
+#include <QObject>
+#include <QString>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUdpSocket>
+
+#include <algorithm>
+#include <cstdio>
+
+/*
+ * ChannelOutput：无界面模式下终端通道的输出目标
+ * - "-" / "stdout"：写标准输出，每行前加 "[通道] "，多个通道可以共用；
+ * - "file:PATH" 或 PATH：追加写入文件，PATH 中的 {channel} 替换为
+ *   通道标签（含会话号），每个通道各写一个文件；
+ * - "tcp:HOST:PORT"：连接到 HOST:PORT 写入原始字节，断开后每秒重连，
+ *   未连接或写缓冲超过 kMaxBacklog 时丢弃并计数；
+ * - "udp:HOST:PORT"：每段输出作为数据报发送，超过 kMaxDatagram 时分片，
+ *   HOST 须为 IP 地址；
+ * - 只在 GUI（主）线程使用，数据来自 TerminalBackend::receiveRaw。
+ */
+class ChannelOutput : public QObject {
+  Q_OBJECT
+public:
+  enum class Kind : uint8_t { STDOUT, FILE, TCP, UDP };
+
+  /* 解析输出目标，非法或无法打开时返回 nullptr */
+  static ChannelOutput *Create(const QString &target, const QByteArray &label,
+                               QObject *parent = nullptr) {
+    QString text = target.trimmed();
+    if (text.isEmpty()) {
+      return nullptr;
+    }
+    if (text == "-" || text == "stdout") {
+      return new ChannelOutput(Kind::STDOUT, parent);
+    }
+    if (text.startsWith("tcp:") || text.startsWith("udp:")) {
+      const Kind kind = text.startsWith("tcp:") ? Kind::TCP : Kind::UDP;
+      const qsizetype colon = text.lastIndexOf(':');
+      bool ok = false;
+      const quint16 port = text.mid(colon + 1).toUShort(&ok);
+      const QString host = text.mid(4, colon - 4);
+      if (colon <= 4 || !ok || host.isEmpty() ||
+          (kind == Kind::UDP && QHostAddress(host).isNull())) {
+        APP_LOG_WARN("Invalid output target: %s", text.toUtf8().constData());
+        return nullptr;
+      }
+      auto *output = new ChannelOutput(kind, parent);
+      output->host_ = host;
+      output->address_ = QHostAddress(host);
+      output->port_ = port;
+      output->open();
+      return output;
+    }
+
+    if (text.startsWith("file:")) {
+      text = text.mid(5);
+    }
+    auto *output = new ChannelOutput(Kind::FILE, parent);
+    output->file_.setFileName(
+        text.replace("{channel}", QString::fromUtf8(label)));
+    if (!output->file_.open(QIODevice::WriteOnly | QIODevice::Append)) {
+      APP_LOG_WARN("Failed to open output file %s",
+                   output->file_.fileName().toUtf8().constData());
+      delete output;
+      return nullptr;
+    }
+    return output;
+  }
+
+  Kind kind() const { return kind_; }
+
+  /* 因未连接或写缓冲已满而丢弃的字节数 */
+  quint64 dropped() const { return dropped_; }
+
+  /* 写入一段通道输出；STDOUT 使用 label 作为行前缀 */
+  void write(const QByteArray &label, const QByteArray &data) {
+    switch (kind_) {
+    case Kind::STDOUT:
+      writeStdout(label, data);
+      break;
+    case Kind::FILE:
+      file_.write(data);
+      file_.flush();
+      break;
+    case Kind::TCP:
+      if (tcp_->state() != QAbstractSocket::ConnectedState ||
+          tcp_->bytesToWrite() > kMaxBacklog) {
+        drop(data.size());
+        break;
+      }
+      tcp_->write(data);
+      break;
+    case Kind::UDP:
+      for (qsizetype offset = 0; offset < data.size();
+           offset += kMaxDatagram) {
+        const qsizetype size = std::min(kMaxDatagram, data.size() - offset);
+        if (udp_->writeDatagram(data.constData() + offset, size,
+                                address_, port_) < 0) {
+          drop(size);
+        }
+      }
+      break;
+    }
+  }
+
+private:
+  ChannelOutput(Kind kind, QObject *parent) : QObject(parent), kind_(kind) {}
+
+  void open() {
+    if (kind_ == Kind::UDP) {
+      udp_ = new QUdpSocket(this);
+      return;
+    }
+    tcp_ = new QTcpSocket(this);
+    tcp_->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    connect(tcp_, &QTcpSocket::connected, this, [this]() {
+      APP_LOG_INFO("Output connected to %s:%u", host_.toUtf8().constData(),
+                   port_);
+    });
+    connect(tcp_, &QTcpSocket::disconnected, this, [this]() {
+      QTimer::singleShot(kReconnectMs, this, &ChannelOutput::reconnect);
+    });
+    connect(tcp_, &QTcpSocket::errorOccurred, this, [this]() {
+      if (tcp_->state() == QAbstractSocket::UnconnectedState) {
+        QTimer::singleShot(kReconnectMs, this, &ChannelOutput::reconnect);
+      }
+    });
+    reconnect();
+  }
+
+  void reconnect() {
+    if (tcp_->state() == QAbstractSocket::UnconnectedState) {
+      tcp_->connectToHost(host_, port_);
+    }
+  }
+
+  void writeStdout(const QByteArray &label, const QByteArray &data) {
+    /* 行首补前缀；不同通道交错时以各自的行首状态为准 */
+    bool &mid_line = mid_line_[label];
+    qsizetype pos = 0;
+    while (pos < data.size()) {
+      if (!mid_line) {
+        std::fprintf(stdout, "[%s] ", label.constData());
+      }
+      const qsizetype newline = data.indexOf('\n', pos);
+      const qsizetype end = newline < 0 ? data.size() : newline + 1;
+      std::fwrite(data.constData() + pos, 1, static_cast<size_t>(end - pos),
+                  stdout);
+      mid_line = newline < 0;
+      pos = end;
+    }
+    std::fflush(stdout);
+  }
+
+  void drop(qsizetype size) {
+    if (dropped_ == 0) {
+      APP_LOG_WARN("Output %s:%u not writable, dropping channel data",
+                   host_.toUtf8().constData(), port_);
+    }
+    dropped_ += static_cast<quint64>(size);
+  }
+
+  Kind kind_;
+  QFile file_;
+  QTcpSocket *tcp_ = nullptr;
+  QUdpSocket *udp_ = nullptr;
+  QString host_;
+  QHostAddress address_;
+  quint16 port_ = 0;
+  quint64 dropped_ = 0;
+  QHash<QByteArray, bool> mid_line_; /* 各通道是否停在行中间 */
+
+  static constexpr qint64 kMaxBacklog = 4 * 1024 * 1024;
+  static constexpr qsizetype kMaxDatagram = 8 * 1024;
+  static constexpr int kReconnectMs = 1000;
+};
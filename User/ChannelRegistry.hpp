@@ -0,0 +1,167 @@
+#pragma once
+
+#include "BufferArena.hpp"
+#include "ChannelSpec.hpp"
+#include "TerminalBackend.hpp"
+#include "libxr.hpp"
+
+#include <QAbstractListModel>
+#include <QDateTime>
+#include <QHash>
+#include <QVariant>
+
+#include <vector>
+
+/*
+ * ChannelRegistry：会话的终端通道表
+ * - 按通道描述列表创建 TerminalBackend，只为实际存在的通道分配缓冲区；
+ * - 后端指针保存在连续数组中，转发循环按下标顺序遍历；
+ * - 同时作为 QML 列表模型，界面按模型创建标签页与终端视图；
+ * - 通道在会话创建时确定，之后不再增删（后端被解析线程引用）；
+ * - 汇总各通道的告警事件（alertCount / lastAlert / recentAlerts），
+ *   供状态栏显示；
+ * - 模型属于 GUI 线程，不随会话移动到解析线程。
+ */
+class ChannelRegistry : public QAbstractListModel {
+  Q_OBJECT
+  Q_PROPERTY(int count READ count CONSTANT)
+  Q_PROPERTY(int alertCount READ alertCount NOTIFY alertsChanged)
+  Q_PROPERTY(QString lastAlert READ lastAlert NOTIFY alertsChanged)
+  Q_PROPERTY(QVariantList recentAlerts READ recentAlerts NOTIFY alertsChanged)
+
+public:
+  enum Roles {
+    NameRole = Qt::UserRole + 1,
+    TitleRole,
+    BackendRole,
+    ChannelIdRole,
+    ConfigurableRole,
+  };
+
+  /*
+   * - specs 为通道描述列表，顺序即串口索引；
+   * - 其余参数原样传给每个 TerminalBackend；
+   * - 后端以 parent 为父对象（界面绑定需要 GUI 线程对象）。
+   */
+  ChannelRegistry(const std::vector<ChannelSpec> &specs, int session,
+                  const BufferConfig &buffers, BufferArena &arena,
+                  LibXR::Topic::Domain *domain, uint32_t command_key,
+                  QObject *parent = nullptr)
+      : QAbstractListModel(parent) {
+    backends_.reserve(specs.size());
+    for (size_t i = 0; i < specs.size(); ++i) {
+      backends_.push_back(new TerminalBackend(specs[i], static_cast<uint8_t>(i),
+                                              session, buffers, arena, domain,
+                                              command_key, parent));
+      connect(backends_.back(), &TerminalBackend::alertsRaised, this,
+              &ChannelRegistry::addAlerts);
+    }
+  }
+
+  int count() const { return static_cast<int>(backends_.size()); }
+  size_t size() const { return backends_.size(); }
+
+  TerminalBackend *at(size_t index) const { return backends_[index]; }
+  TerminalBackend *const *begin() const { return backends_.data(); }
+  TerminalBackend *const *end() const {
+    return backends_.data() + backends_.size();
+  }
+
+  /* 第一个透传通道（用于 REBOOT 命令），没有时返回 nullptr */
+  TerminalBackend *tunnel() const {
+    for (TerminalBackend *backend : backends_) {
+      if (backend->tunnel_) {
+        return backend;
+      }
+    }
+    return nullptr;
+  }
+
+  /* WebChannel 中注册的对象名，页面通过 ?channel= 查找 */
+  static QString ChannelId(int index) {
+    return QStringLiteral("backend%1").arg(index);
+  }
+
+  Q_INVOKABLE QObject *backend(int index) const {
+    return index >= 0 && index < count() ? backends_[index] : nullptr;
+  }
+
+  /* 是否可下发串口配置（透传通道不可配置） */
+  Q_INVOKABLE bool isConfigurable(int index) const {
+    return index >= 0 && index < count() && !backends_[index]->tunnel_;
+  }
+
+  int alertCount() const { return alert_count_; }
+  QString lastAlert() const { return last_alert_; }
+
+  /* 最近的告警事件（新的在前，最多 kRecentAlerts 项） */
+  QVariantList recentAlerts() const { return recent_alerts_; }
+
+  /* 状态栏确认后清零 */
+  Q_INVOKABLE void clearAlerts() {
+    alert_count_ = 0;
+    last_alert_.clear();
+    recent_alerts_.clear();
+    emit alertsChanged();
+  }
+
+  int rowCount(const QModelIndex &parent = QModelIndex()) const override {
+    return parent.isValid() ? 0 : count();
+  }
+
+  QVariant data(const QModelIndex &index, int role) const override {
+    if (!index.isValid() || index.row() >= count()) {
+      return {};
+    }
+    TerminalBackend *backend = backends_[index.row()];
+    switch (role) {
+    case NameRole:
+      return QString::fromUtf8(backend->name_);
+    case Qt::DisplayRole:
+    case TitleRole:
+      return backend->title_;
+    case BackendRole:
+      return QVariant::fromValue<QObject *>(backend);
+    case ChannelIdRole:
+      return ChannelId(index.row());
+    case ConfigurableRole:
+      return !backend->tunnel_;
+    default:
+      return {};
+    }
+  }
+
+  QHash<int, QByteArray> roleNames() const override {
+    return {{NameRole, "name"},
+            {TitleRole, "title"},
+            {BackendRole, "backend"},
+            {ChannelIdRole, "channelId"},
+            {ConfigurableRole, "configurable"}};
+  }
+
+signals:
+  void alertsChanged();
+
+private:
+  void addAlerts(const QVariantList &events) {
+    alert_count_ += static_cast<int>(events.size());
+    for (const QVariant &event : events) {
+      recent_alerts_.prepend(event);
+    }
+    while (recent_alerts_.size() > kRecentAlerts) {
+      recent_alerts_.removeLast();
+    }
+    const QVariantMap last = events.constLast().toMap();
+    last_alert_ =
+        QDateTime::fromMSecsSinceEpoch(last["wall_ms"].toLongLong())
+            .toString("HH:mm:ss") +
+        " " + last["channel"].toString() + ": " + last["pattern"].toString();
+    emit alertsChanged();
+  }
+
+  std::vector<TerminalBackend *> backends_;
+  int alert_count_ = 0;
+  QString last_alert_;
+  QVariantList recent_alerts_;
+  static constexpr qsizetype kRecentAlerts = 100;
+};
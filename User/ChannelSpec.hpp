@@ -0,0 +1,149 @@
+#pragma once
+
+#include "AsyncLogger.hpp"
+
+#include <QByteArray>
+#include <QFile>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+
+#include <vector>
+
+/*
+ * 发送队列溢出策略（发送队列放不下用户输入时）：
+ * - BLOCK：暂存输入，等 socket 与发送队列腾出空间后继续发送；
+ *   暂存也达到上限时拒绝新输入并在终端提示，不静默丢弃；
+ * - DROP_OLDEST：暂存上限为一个发送队列容量，超出时丢弃最早的
+ *   尚未入队数据，适合只关心最新指令的场景；
+ * - DROP_NEWEST：不暂存，放不下的部分立即丢弃。
+ * 已进入发送队列的封包不会被驱逐；控制命令不经过发送队列。
+ */
+enum class OverflowPolicy : uint8_t { BLOCK, DROP_OLDEST, DROP_NEWEST };
+
+/* 解析策略名称（block / drop-oldest / drop-newest），非法时返回 false */
+inline bool ParseOverflowPolicy(const QString &text, OverflowPolicy *policy) {
+  const QString name = text.trimmed().toLower();
+  if (name == "block") {
+    *policy = OverflowPolicy::BLOCK;
+  } else if (name == "drop-oldest") {
+    *policy = OverflowPolicy::DROP_OLDEST;
+  } else if (name == "drop-newest") {
+    *policy = OverflowPolicy::DROP_NEWEST;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+inline const char *OverflowPolicyName(OverflowPolicy policy) {
+  switch (policy) {
+  case OverflowPolicy::DROP_OLDEST:
+    return "drop-oldest";
+  case OverflowPolicy::DROP_NEWEST:
+    return "drop-newest";
+  default:
+    return "block";
+  }
+}
+
+/*
+ * ChannelSpec：一个终端通道的描述
+ * - name 为 Topic 名称（与设备端一致），title 为标签页标题；
+ * - tunnel 表示透传通道（如 MiniPC）：发送两层嵌套封包，
+ *   不下发串口配置；
+ * - overflow 为发送队列溢出策略，缺省取 --overflow-policy；
+ * - pty 表示同时暴露为本地伪终端（--pty 时全部通道开启）；
+ * - 通道在列表中的位置即串口索引（CONFIG_UART 的 uart_index）。
+ */
+struct ChannelSpec {
+  QByteArray name;
+  QString title;
+  bool tunnel = false;
+  OverflowPolicy overflow = OverflowPolicy::BLOCK;
+  bool pty = false;
+
+  /* 通道数上限（抓包中 0xFE/0xFF 为保留通道号） */
+  static constexpr size_t kMaxChannels = 32;
+
+  /* 默认通道：MiniPC、USART1、USART2 */
+  static std::vector<ChannelSpec>
+  Defaults(OverflowPolicy overflow = OverflowPolicy::BLOCK) {
+    return {{"uart_cdc", "MiniPC", true, overflow, false},
+            {"uart1", "USART1", false, overflow, false},
+            {"uart2", "USART2", false, overflow, false}};
+  }
+
+  /*
+   * 解析 "name[:title][:tunnel][:pty][:policy]" 形式的通道描述：
+   * - 多个通道以逗号或换行分隔，# 开头的行为注释；
+   * - 标题缺省为名称；policy 为 block / drop-oldest / drop-newest，
+   *   缺省为 overflow；标记顺序不限；非法项跳过。
+   */
+  static std::vector<ChannelSpec>
+  ParseList(const QString &text,
+            OverflowPolicy overflow = OverflowPolicy::BLOCK) {
+    std::vector<ChannelSpec> specs;
+    const QStringList items =
+        text.split(QRegularExpression("[,\\n]"), Qt::SkipEmptyParts);
+    for (QString item : items) {
+      item = item.trimmed();
+      if (item.isEmpty() || item.startsWith('#')) {
+        continue;
+      }
+      const QStringList fields = item.split(':');
+      ChannelSpec spec;
+      spec.name = fields[0].trimmed().toUtf8();
+      spec.title = fields.size() > 1 && !fields[1].trimmed().isEmpty()
+                       ? fields[1].trimmed()
+                       : fields[0].trimmed();
+      spec.overflow = overflow;
+      for (int i = 2; i < fields.size(); ++i) {
+        const QString flag = fields[i].trimmed();
+        if (flag.compare("tunnel", Qt::CaseInsensitive) == 0) {
+          spec.tunnel = true;
+        } else if (flag.compare("pty", Qt::CaseInsensitive) == 0) {
+          spec.pty = true;
+        } else if (!flag.isEmpty() &&
+                   !ParseOverflowPolicy(flag, &spec.overflow)) {
+          APP_LOG_WARN("Unknown channel flag '%s' in %s",
+                       flag.toUtf8().constData(), item.toUtf8().constData());
+        }
+      }
+      if (spec.name.isEmpty()) {
+        APP_LOG_WARN("Ignoring channel spec without name: %s",
+                     item.toUtf8().constData());
+        continue;
+      }
+      if (specs.size() >= kMaxChannels) {
+        APP_LOG_WARN("Too many channels, ignoring %s", spec.name.constData());
+        continue;
+      }
+      specs.push_back(spec);
+    }
+    return specs;
+  }
+
+  /*
+   * 通道列表来源（优先级从高到低）：
+   * - 命令行 --channels；
+   * - 工作目录下的 channels.cfg；
+   * - 默认三个通道。
+   */
+  static std::vector<ChannelSpec>
+  Resolve(const QString &option,
+          OverflowPolicy overflow = OverflowPolicy::BLOCK) {
+    std::vector<ChannelSpec> specs;
+    if (!option.isEmpty()) {
+      specs = ParseList(option, overflow);
+    } else {
+      QFile file("channels.cfg");
+      if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        specs = ParseList(QTextStream(&file).readAll(), overflow);
+        APP_LOG_INFO("Loaded %zu channels from channels.cfg", specs.size());
+      }
+    }
+    return specs.empty() ? Defaults(overflow) : specs;
+  }
+};
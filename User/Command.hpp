@@ -0,0 +1,38 @@
+#pragma once
+
+#include "uart.hpp"
+
+#include <cstdint>
+
+/*
+ * 命令结构体：
+ * 通过 Topic 通道在前后端之间传输控制命令；
+ * 包括 Ping、重启、重命名、串口配置、链路探测等。
+ */
+class Command {
+public:
+  enum class Type : uint8_t {
+    PING = 0,        /* 前端 Ping 后端，用于状态检测 */
+    REMOTE_PING = 1, /* 后端 Ping 前端，用于状态检测 */
+    REBOOT = 2,      /* 重启 MiniPC */
+    RENAME = 3,      /* 重命名设备 */
+    CONFIG_UART = 4, /* 配置指定串口参数 */
+    PROBE = 5,       /* 探测包（任一方发出），对方回 PROBE_ACK，测量往返时间 */
+    PROBE_ACK = 6    /* 对 PROBE 的应答，携带相同序号 */
+  };
+
+  Type type;
+
+  union {
+    char device_name[32]; /* 用于 RENAME 命令 */
+
+    struct {
+      uint8_t uart_index;                /* 串口索引 */
+      LibXR::UART::Configuration config; /* 串口配置结构体 */
+    } uart_config;
+
+    struct {
+      uint32_t seq; /* 探测序号（PROBE / PROBE_ACK） */
+    } probe;
+  } data;
+};
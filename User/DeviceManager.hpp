@@ -1,11 +1,13 @@
 #pragma once
 
-#include "logger.hpp"
+#include "AsyncLogger.hpp"
 #include <QDebug>
 #include <QFile>
 #include <QObject>
 #include <QString>
 #include <QTextStream>
+#include <QVariantList>
+#include <QVariantMap>
 
 class DeviceManager : public QObject {
   Q_OBJECT
@@ -13,6 +15,8 @@ class DeviceManager : public QObject {
   Q_PROPERTY(bool backendConnected READ isBackendConnected NOTIFY
                  backendConnectedChanged)
   Q_PROPERTY(bool miniPCOnline READ isMiniPCOnline NOTIFY miniPCOnlineChanged)
+  Q_PROPERTY(QVariantMap linkStats READ linkStats NOTIFY linkStatsChanged)
+  Q_PROPERTY(QVariantList metrics READ metrics NOTIFY metricsChanged)
 
 public:
   explicit DeviceManager(QObject *parent = nullptr) : QObject(parent) {
@@ -27,10 +31,10 @@ public:
    */
   Q_INVOKABLE void SetDeviceNameFilter(const QString &filter) {
     if (filter.isEmpty()) {
-      XR_LOG_INFO("Device name filter is empty");
+      APP_LOG_INFO("Device name filter is empty");
     } else {
       filter_name_ = filter;
-      XR_LOG_INFO("Device name filter is: %s", filter.toStdString().c_str());
+      APP_LOG_INFO("Device name filter is: %s", filter.toStdString().c_str());
     }
     filter_is_set_ = true;
   }
@@ -42,9 +46,9 @@ public:
    */
   Q_INVOKABLE void RenameDevice(const QString &input) {
     if (input.isEmpty()) {
-      XR_LOG_INFO("Device name is empty");
+      APP_LOG_INFO("Device name is empty");
     } else {
-      XR_LOG_INFO("Device name is: %s", input.toStdString().c_str());
+      APP_LOG_INFO("Device name is: %s", input.toStdString().c_str());
       last_device_name_ = input;
       require_rename_ = true;
       saveDeviceNameToFile();
@@ -62,7 +66,7 @@ public:
    * - 后续由定时器检测并发送实际命令。
    */
   Q_INVOKABLE void RestartMiniPC() {
-    XR_LOG_INFO("Restart MiniPC");
+    APP_LOG_INFO("Restart MiniPC");
     require_restart_ = true;
   }
 
@@ -86,14 +90,41 @@ public:
     }
   }
 
+  /*
+   * 设置链路统计（用于 UI 显示，毫秒）：
+   * - rttSupported / rttP50 / rttP99 / rttMax；
+   * - jitterP50 / jitterP99 / jitterMax / timeout / degraded；
+   */
+  Q_INVOKABLE void SetLinkStats(const QVariantMap &stats) {
+    if (link_stats_ != stats) {
+      link_stats_ = stats;
+      emit linkStatsChanged();
+    }
+  }
+
+  /*
+   * 设置指标快照（用于诊断面板）：
+   * - 每项包含 name / counter / value / rate / highWater；
+   */
+  Q_INVOKABLE void SetMetrics(const QVariantList &metrics) {
+    metrics_ = metrics;
+    emit metricsChanged();
+  }
+
   /* 获取当前连接状态 */
   bool isBackendConnected() const { return backend_connected_; }
 
   bool isMiniPCOnline() const { return mini_pc_online_; }
 
+  QVariantMap linkStats() const { return link_stats_; }
+
+  QVariantList metrics() const { return metrics_; }
+
 signals:
   void backendConnectedChanged();
   void miniPCOnlineChanged();
+  void linkStatsChanged();
+  void metricsChanged();
 
 public:
   /* 公共状态字段（由外部直接读写） */
@@ -105,6 +136,8 @@ public:
 
   QString last_device_name_ = "";
   QString filter_name_ = "";
+  QVariantMap link_stats_;
+  QVariantList metrics_;
 
 private:
   /*
@@ -115,7 +148,7 @@ private:
   void readDeviceNameFromFile() {
     QFile file("Device.cfg");
     if (!file.exists()) {
-      XR_LOG_INFO(
+      APP_LOG_INFO(
           "Device.cfg file does not exist. No previous device name to load.");
       return;
     }
@@ -123,11 +156,11 @@ private:
     if (file.open(QIODevice::ReadOnly | QIODevice::Text)) {
       QTextStream in(&file);
       last_device_name_ = in.readLine();
-      XR_LOG_INFO("Loaded device name from file: %s",
-                  last_device_name_.toStdString().c_str());
+      APP_LOG_INFO("Loaded device name from file: %s",
+                   last_device_name_.toStdString().c_str());
       file.close();
     } else {
-      XR_LOG_INFO("Failed to open Device.cfg for reading.");
+      APP_LOG_INFO("Failed to open Device.cfg for reading.");
     }
   }
 
@@ -141,11 +174,11 @@ private:
     if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
       QTextStream out(&file);
       out << last_device_name_ << "\n";
-      XR_LOG_INFO("Saved device name to file: %s",
-                  last_device_name_.toStdString().c_str());
+      APP_LOG_INFO("Saved device name to file: %s",
+                   last_device_name_.toStdString().c_str());
       file.close();
     } else {
-      XR_LOG_INFO("Failed to open Device.cfg for writing.");
+      APP_LOG_INFO("Failed to open Device.cfg for writing.");
     }
   }
 };
@@ -0,0 +1,651 @@
+#pragma once
+
+#include "AppOptions.hpp"
+#include "AsyncLogger.hpp"
+#include "FanoutServer.hpp"
+#include "QTTimebase.hpp"
+#include "BufferArena.hpp"
+#include "ChannelRegistry.hpp"
+#include "LinkMonitor.hpp"
+#include "Metrics.hpp"
+#include "PtyBridge.hpp"
+#include "ReceiveBuffer.hpp"
+#include "ReplayEngine.hpp"
+#include "SessionCapture.hpp"
+#include "SocketTransport.hpp"
+#include "TerminalBackend.hpp"
+#include "libxr.hpp"
+
+#include <QByteArray>
+#include <QHostAddress>
+#include <QTcpSocket>
+#include <QTimer>
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+/*
+ * DeviceSession：单个设备连接的会话槽
+ * - 每个槽拥有独立的 Topic 域、命令 Topic、Topic Server 与通道表，
+ *   不同设备的同名 Topic 互不干扰；
+ * - 槽在启动时于 GUI 线程预先创建（后端是界面可绑定的 QObject），
+ *   随后移动到某个解析分片线程；socket 在分片线程中由描述符创建，
+ *   接收、解析、转发与 PING 超时检测都在该线程完成；
+ * - 连接断开后槽被回收，供下一个连接使用。
+ */
+class DeviceSession : public QObject {
+  Q_OBJECT
+public:
+  DeviceSession(int slot, const AppOptions &options, BufferArena &arena,
+                QObject *backendParent)
+      : slot_(slot), options_(options),
+        domainName_("session" + QByteArray::number(slot)),
+        domain_(domainName_.constData()),
+        command_topic_("command", sizeof(Command), &domain_),
+        receiveBuffer_(arena.AllocateArray<uint8_t>(
+                           options.buffers.receive_buffer_bytes, "tcp.receive"),
+                       options.buffers.receive_buffer_bytes),
+        transport_(options.transport,
+                   options.transport.mode == TransportMode::THROUGHPUT
+                       ? arena.AllocateArray<uint8_t>(
+                             options.buffers.socket_backlog_bytes,
+                             "tcp.gather")
+                       : nullptr,
+                   options.buffers.socket_backlog_bytes) {
+    initMetrics();
+    initBackends(arena, backendParent);
+    initCommandHandler();
+    initTopicServer(arena);
+  }
+
+  ~DeviceSession() {
+    if (recorder_) {
+      recorder_->Finish();
+    }
+  }
+
+  int slot() const { return slot_; }
+  ChannelRegistry *channels() const { return channels_; }
+  uint32_t commandKey() const { return command_topic_.GetKey(); }
+
+  /* 会话是否被占用（任意线程） */
+  bool isActive() const { return active_.load(std::memory_order_acquire); }
+
+  /* 尝试占用空闲槽（Worker 线程），成功后必须投递 accept() 或 startReplay() */
+  bool tryClaim() {
+    bool expected = false;
+    return active_.compare_exchange_strong(expected, true,
+                                           std::memory_order_acq_rel);
+  }
+
+  /*
+   * 在线状态（任意线程）：
+   *  - 时间戳来自单调时钟（QTTimebase::NowMicros），不受系统校时影响；
+   *  - 阈值由 LinkMonitor 按链路统计自适应；
+   *  - 从未收到 PING 时为离线。
+   */
+  bool isOnline(uint64_t now_us) const {
+    return IsFresh(last_ping_us_.load(std::memory_order_relaxed), now_us);
+  }
+  bool isRemoteOnline(uint64_t now_us) const {
+    return IsFresh(last_remote_ping_us_.load(std::memory_order_relaxed),
+                   now_us);
+  }
+
+  /* 链路 RTT / 抖动统计快照（任意线程） */
+  LinkStats linkStats() const { return monitor_.Snapshot(); }
+
+  /*
+   * 请求一次转发（线程安全）：
+   *  - 可在任意线程调用；
+   *  - 多次请求在 forwardTcpData() 执行前只投递一次事件。
+   */
+  void requestForward() {
+    if (!forwardPending_.exchange(true, std::memory_order_acq_rel)) {
+      QMetaObject::invokeMethod(this, &DeviceSession::forwardTcpData,
+                                Qt::QueuedConnection);
+    }
+  }
+
+public slots:
+  /* 分片线程启动后调用，创建本线程的定时器 */
+  void start() {
+    /*
+     * 本会话 PING 超时检测（100 毫秒）：
+     *  - 超过自适应阈值（默认 300 毫秒）未收到 PING 视为设备离线，
+     *    断开并回收槽。
+     */
+    pingCheckTimer_ = new QTimer(this);
+    connect(pingCheckTimer_, &QTimer::timeout, this, [this]() {
+      if (socket_ != nullptr && !isOnline(LibXR::QTTimebase::NowMicros())) {
+        APP_LOG_INFO("Session %d: TCP client disconnected (no PING for %llu "
+                     "ms)",
+                     slot_,
+                     static_cast<unsigned long long>(monitor_.TimeoutUs() /
+                                                     1000));
+        close();
+      }
+    });
+    pingCheckTimer_->start(100);
+
+    /* 链路探测：定期发送带序号的 PROBE，设备回 PROBE_ACK 后计算 RTT */
+    probeTimer_ = new QTimer(this);
+    connect(probeTimer_, &QTimer::timeout, this, &DeviceSession::sendProbe);
+    probeTimer_->start(kProbeIntervalMs);
+
+    /*
+     * 接收路径统计（每秒一次）：
+     *  - 每秒唤醒次数、平均每次唤醒读取的字节数；
+     *  - 单次唤醒最大字节数与接收缓冲区高水位；
+     *  - 同时更新链路统计与自适应阈值，连接期间每 10 秒输出一次；
+     *  - 更新未解析字节数指标。
+     */
+    receiveStatsTimer_ = new QTimer(this);
+    connect(receiveStatsTimer_, &QTimer::timeout, this, [this]() {
+      monitor_.Tick();
+      updateParseMetrics();
+      if (socket_ != nullptr && ++statsTicks_ % kLinkLogTicks == 0) {
+        logLinkStats();
+      }
+
+      const ReceiveBuffer::Stats window = receiveBuffer_.TakeWindow();
+      if (window.wakeups == 0)
+        return;
+      APP_LOG_DEBUG("Session %d TCP receive: %llu wakeups/s, %llu "
+                    "bytes/wakeup, max %llu bytes/wakeup, high water %zu/%zu",
+                    slot_, static_cast<unsigned long long>(window.wakeups),
+                    static_cast<unsigned long long>(window.bytes /
+                                                    window.wakeups),
+                    static_cast<unsigned long long>(
+                        window.max_bytes_per_wakeup),
+                    window.high_water, receiveBuffer_.Capacity());
+    });
+    receiveStatsTimer_->start(1000);
+
+    initPtys();
+    initFanout();
+  }
+
+  /*
+   * 接管一个已接受的连接（分片线程）：
+   *  - 由描述符创建 socket，socket 属于分片线程；
+   *  - 断线之后输入的数据先发出（断开时已丢弃发给上一台设备的积压），
+   *    再同步各通道的串口配置。
+   */
+  void accept(qintptr descriptor) {
+    socket_ = new QTcpSocket(this);
+    if (!socket_->setSocketDescriptor(descriptor)) {
+      APP_LOG_ERROR("Session %d: failed to adopt socket descriptor", slot_);
+      delete socket_;
+      socket_ = nullptr;
+      active_.store(false, std::memory_order_release);
+      return;
+    }
+
+    transport_.Attach(socket_);
+    connect(socket_, &QTcpSocket::readyRead, this,
+            &DeviceSession::onTcpDataReceived);
+    connect(socket_, &QTcpSocket::disconnected, this, &DeviceSession::close);
+    connect(socket_, &QTcpSocket::bytesWritten, this,
+            &DeviceSession::onBytesWritten);
+
+    /* 给新连接一个完整的 PING 超时周期，链路统计重新开始 */
+    monitor_.Reset();
+    statsTicks_ = 0;
+    writeStalled_ = false;
+    last_ping_us_.store(LibXR::QTTimebase::NowMicros(),
+                        std::memory_order_relaxed);
+
+    if (options_.record) {
+      recorder_ = std::make_unique<SessionRecorder>(
+          options_.record_dir, QString("session%1").arg(slot_));
+    }
+
+    APP_LOG_INFO("Session %d: client connected from %s (%s transport)",
+                 slot_, socket_->peerAddress().toString().toUtf8().constData(),
+                 TransportModeName(transport_.Mode()));
+
+    forwardTcpData();
+    for (TerminalBackend *backend : *channels_) {
+      backend->syncConfig();
+    }
+    requestForward();
+    emit opened(slot_);
+  }
+
+  /*
+   * 回放会话抓包（分片线程）：
+   *  - 只回放 TCP 入站记录，经过与实时数据相同的解析路径；
+   *  - 出站记录仅用于分析，不会重新发送；
+   *  - from_us 非零时从该时刻开始，起点若落在帧中间，由解析器重新同步。
+   */
+  void startReplay(const QString &file, double speed, uint64_t from_us) {
+    replay_ = new ReplayEngine(
+        file, speed, from_us,
+        [this](const SessionReader::Record &record) {
+          if (record.channel == SessionCapture::kChannelTcpIn &&
+              record.direction == SessionCapture::Direction::In) {
+            processInbound(record.data, record.size);
+          }
+        },
+        this);
+    replay_->start();
+  }
+
+  /*
+   * 直接发送的 Command 帧（分片线程），录制后写入客户端：
+   *  - 控制通道，不经过发送队列，也不受 socket 写缓冲上限限制，
+   *    批量数据积压时控制命令不会被挤掉。
+   */
+  void sendCommand(const QByteArray &frame) {
+    if (recorder_) {
+      recorder_->Record(SessionCapture::kChannelCommand,
+                        SessionCapture::Direction::Out, frame.constData(),
+                        static_cast<size_t>(frame.size()));
+    }
+    if (socket_ != nullptr) {
+      socket_->write(frame);
+      metrics_.tx_bytes->Add(static_cast<uint64_t>(frame.size()));
+      observeWriteBuffer();
+    }
+  }
+
+  /* 断开连接并回收槽（分片线程） */
+  void close() {
+    if (socket_ == nullptr) {
+      return;
+    }
+    QTcpSocket *socket = socket_;
+    socket_ = nullptr;
+    transport_.Detach();
+    socket->disconnect(this);
+    socket->disconnectFromHost();
+    socket->deleteLater();
+
+    if (recorder_) {
+      recorder_->Finish();
+      recorder_.reset();
+    }
+
+    /* 槽位可能分配给另一台设备，发给这台设备的积压不再转发 */
+    for (TerminalBackend *backend : *channels_) {
+      backend->discardQueued();
+      if (backend->pty_ != nullptr) {
+        backend->pty_->Discard();
+      }
+    }
+
+    active_.store(false, std::memory_order_release);
+    emit closed(slot_);
+  }
+
+signals:
+  void opened(int slot);
+  void closed(int slot);
+
+private:
+  void initBackends(BufferArena &arena, QObject *parent) {
+    /* 按通道列表创建后端（MiniPC、USART1、USART2 或设备的其他串口） */
+    channels_ = new ChannelRegistry(options_.channels, slot_, options_.buffers,
+                                    arena, &domain_, command_topic_.GetKey(),
+                                    parent);
+
+    /*
+     * 入队即唤醒转发：
+     *  - dataQueued 可能在 GUI 线程或分片线程发出，DirectConnection
+     *    直接调用线程安全的 requestForward()；
+     *  - 真正的 forwardTcpData() 始终在分片线程执行；
+     *  - 控制命令（CONFIG_UART）走 sendCommand()，在分片线程直接写入。
+     */
+    for (TerminalBackend *backend : *channels_) {
+      connect(backend, &TerminalBackend::dataQueued, this,
+              &DeviceSession::requestForward, Qt::DirectConnection);
+      connect(backend, &TerminalBackend::commandReady, this,
+              &DeviceSession::sendCommand);
+      /* 告警模式在 Parse 中编译一次，各通道只创建自己的扫描状态 */
+      backend->setAlertPatterns(options_.alerts);
+      backend->setCaptureOptions(options_.capture);
+    }
+  }
+
+  void initCommandHandler() {
+    /* 注册处理 PING、REMOTE_PING 与 PROBE / PROBE_ACK 的命令回调 */
+    auto cb = LibXR::Topic::Callback::Create(
+        [](bool, DeviceSession *self, LibXR::RawData &data) {
+          self->metrics_.frame_bytes->Add(data.size_ +
+                                          LibXR::Topic::PACK_BASE_SIZE);
+          if (data.size_ <= sizeof(Command)) {
+            Command cmd = *reinterpret_cast<Command *>(data.addr_);
+            const uint64_t now = LibXR::QTTimebase::NowMicros();
+            switch (cmd.type) {
+            case Command::Type::PING:
+              APP_LOG_DEBUG("Session %d received PING command", self->slot_);
+              self->last_ping_us_.store(now, std::memory_order_relaxed);
+              self->monitor_.OnPing(now);
+              break;
+            case Command::Type::REMOTE_PING:
+              APP_LOG_DEBUG("Session %d received REMOTE_PING command",
+                            self->slot_);
+              self->last_remote_ping_us_.store(now,
+                                               std::memory_order_relaxed);
+              break;
+            case Command::Type::PROBE_ACK:
+              self->monitor_.OnProbeAck(cmd.data.probe.seq, now);
+              break;
+            case Command::Type::PROBE:
+              self->sendProbeAck(cmd.data.probe.seq);
+              break;
+            default:
+              break;
+            }
+          }
+        },
+        this);
+    command_topic_.RegisterCallback(cb);
+  }
+
+  void initTopicServer(BufferArena &arena) {
+    /* 创建本会话的 Topic Server，注册各通道与命令 Topic */
+    topicServer_ = std::make_unique<LibXR::Topic::Server>(
+        options_.buffers.server_buffer_bytes);
+    arena.Account("topic.server", options_.buffers.server_buffer_bytes);
+    for (TerminalBackend *backend : *channels_) {
+      topicServer_->Register(backend->topic_);
+    }
+    topicServer_->Register(command_topic_);
+  }
+
+  void sendProbe() {
+    /* PROBE 不录制：只用于测量，回放时没有对应的应答 */
+    if (socket_ == nullptr || !monitor_.ProbeDue())
+      return;
+    Command cmd{};
+    cmd.type = Command::Type::PROBE;
+    cmd.data.probe.seq = monitor_.NextProbe(LibXR::QTTimebase::NowMicros());
+    LibXR::Topic::PackedData<Command> packed;
+    LibXR::Topic::PackData(command_topic_.GetKey(), packed, cmd);
+    socket_->write(reinterpret_cast<const char *>(&packed), sizeof(packed));
+    metrics_.tx_bytes->Add(sizeof(packed));
+  }
+
+  void sendProbeAck(uint32_t seq) {
+    /* 设备端发起的探测：立即回应，设备（或模拟器）据此测量端到端往返 */
+    if (socket_ == nullptr)
+      return;
+    Command cmd{};
+    cmd.type = Command::Type::PROBE_ACK;
+    cmd.data.probe.seq = seq;
+    LibXR::Topic::PackedData<Command> packed;
+    LibXR::Topic::PackData(command_topic_.GetKey(), packed, cmd);
+    socket_->write(reinterpret_cast<const char *>(&packed), sizeof(packed));
+    socket_->flush();
+    metrics_.tx_bytes->Add(sizeof(packed));
+  }
+
+  /*
+   * 为标记了 pty 的通道打开本地伪终端（分片线程）：
+   *  - PtyBridge 属于会话，读通知与 Resume() 都在本线程；
+   *  - 打开失败只告警，通道照常工作。
+   */
+  void initPtys() {
+    for (TerminalBackend *backend : *channels_) {
+      if (!options_.channels[backend->index_].pty) {
+        continue;
+      }
+      auto *pty = new PtyBridge(backend, slot_, this);
+      if (pty->Open(options_.pty_dir)) {
+        backend->pty_ = pty;
+      } else {
+        delete pty;
+      }
+    }
+  }
+
+  /*
+   * 为每个通道开放本地分发服务（分片线程）：
+   *  - TCP 端口按会话与通道顺序编号，互不冲突；
+   *  - 监听失败只告警，通道照常工作。
+   */
+  void initFanout() {
+    const FanoutOptions &fanout = options_.fanout;
+    if (!fanout.enabled()) {
+      return;
+    }
+    const size_t count = channels_->size();
+    for (TerminalBackend *backend : *channels_) {
+      const int port =
+          fanout.port == 0
+              ? 0
+              : fanout.port + slot_ * static_cast<int>(count) +
+                    backend->index_;
+      if (port > 65535) {
+        APP_LOG_WARN("Session %d: fan-out port out of range for %s", slot_,
+                     backend->label_.constData());
+        continue;
+      }
+      auto *server = new FanoutServer(backend, slot_, fanout, this);
+      if (server->Listen(static_cast<quint16>(port), fanout.dir)) {
+        backend->fanout_ = server;
+      } else {
+        delete server;
+      }
+    }
+  }
+
+  void initMetrics() {
+    /* 会话级指标，名称前缀 s<槽号>.；frame_bytes 与本会话各通道共享 */
+    MetricsRegistry &registry = MetricsRegistry::Instance();
+    const std::string prefix = "s" + std::to_string(slot_) + ".";
+    metrics_.rx_bytes = registry.AddCounter(prefix + "tcp.rx_bytes");
+    metrics_.tx_bytes = registry.AddCounter(prefix + "tcp.tx_bytes");
+    metrics_.write_buffer = registry.AddGauge(prefix + "tcp.write_buffer");
+    metrics_.write_stalls = registry.AddCounter(prefix + "tcp.write_stalls");
+    metrics_.frame_bytes = registry.AddCounter(prefix + "parse.frame_bytes");
+    metrics_.unparsed_bytes =
+        registry.AddGauge(prefix + "parse.unparsed_bytes");
+  }
+
+  qint64 socketBacklogLimit() const {
+    return static_cast<qint64>(options_.buffers.socket_backlog_bytes);
+  }
+
+  /* socket 写缓冲区深度（分片线程） */
+  void observeWriteBuffer() {
+    if (socket_ != nullptr) {
+      metrics_.write_buffer->Set(
+          static_cast<uint64_t>(socket_->bytesToWrite()));
+    }
+  }
+
+  /*
+   * 未解析字节数 = 入站字节数 - 已分发到 Topic 的帧字节数：
+   * - 包含 CRC 错误、未注册 Topic 与被丢弃的噪声字节；
+   * - 解析器中尚未完整的半帧也暂时计入，不超过一个最大包。
+   */
+  void updateParseMetrics() {
+    const uint64_t in = metrics_.rx_bytes->Value();
+    const uint64_t framed = metrics_.frame_bytes->Value();
+    metrics_.unparsed_bytes->Set(in > framed ? in - framed : 0);
+  }
+
+  void logLinkStats() {
+    const LinkStats stats = monitor_.Snapshot();
+    auto ms = [](uint64_t us) { return us / 1000.0; };
+    if (stats.rtt_supported) {
+      APP_LOG_INFO("Session %d link: rtt p50 %.1f / p99 %.1f / max %.1f ms, "
+                   "probes lost %llu/%llu",
+                   slot_, ms(stats.rtt_p50_us), ms(stats.rtt_p99_us),
+                   ms(stats.rtt_max_us),
+                   static_cast<unsigned long long>(stats.probes_lost),
+                   static_cast<unsigned long long>(stats.probes_sent));
+    }
+    APP_LOG_INFO("Session %d link: ping interval p50 %.1f / p99 %.1f ms, "
+                 "jitter p50 %.1f / p99 %.1f / max %.1f ms, timeout %.0f ms%s",
+                 slot_, ms(stats.interval_p50_us), ms(stats.interval_p99_us),
+                 ms(stats.jitter_p50_us), ms(stats.jitter_p99_us),
+                 ms(stats.jitter_max_us), ms(stats.timeout_us),
+                 stats.degraded ? ", DEGRADED" : "");
+  }
+
+  void processInbound(const uint8_t *data, size_t size) {
+    /* Topic 协议用于多通道数据接收与命令分发，实时与回放共用 */
+    metrics_.rx_bytes->Add(size);
+    topicServer_->ParseData({const_cast<uint8_t *>(data), size});
+  }
+
+private slots:
+  void onTcpDataReceived() {
+    /*
+     * 读取 TCP 客户端发送的数据：
+     *  - 直接读入预分配的接收缓冲区，不再为每次 readyRead 分配 QByteArray；
+     *  - 每段数据录制后原地解析为 Topic 消息。
+     */
+    if (socket_ == nullptr)
+      return;
+
+    const size_t total = receiveBuffer_.ReadFrom(
+        socket_, [this](const uint8_t *data, size_t size) {
+          if (recorder_) {
+            recorder_->Record(SessionCapture::kChannelTcpIn,
+                              SessionCapture::Direction::In, data, size);
+          }
+          processInbound(data, size);
+        });
+    APP_LOG_DEBUG("Session %d received TCP data size: %zu", slot_, total);
+  }
+
+  void onBytesWritten() {
+    /* socket 写缓冲回落到上限一半以下时恢复转发 */
+    observeWriteBuffer();
+    if (writeStalled_ && socket_ != nullptr &&
+        socket_->bytesToWrite() <= socketBacklogLimit() / 2) {
+      writeStalled_ = false;
+      requestForward();
+    }
+  }
+
+  void forwardTcpData() {
+    /*
+     * 从所有串口的发送队列中读取待转发数据：
+     *  - 由 requestForward() 投递触发，无数据时不会被唤醒；
+     *  - 一次唤醒内轮流从各通道取数据，起始通道每次后移一位，
+     *    单个通道持续大流量时其他通道不会被饿死；
+     *  - 发送队列中已是完整封包，连续区段交给 SocketTransport：
+     *    latency 模式逐段写入并立即 flush，throughput 模式汇集为
+     *    一次大写入，在本次唤醒结束时 flush；
+     *  - socket 写缓冲（bytesToWrite）达到上限时停止消费，数据留在
+     *    发送队列中，由 bytesWritten 回落后恢复，慢链路下内存不再
+     *    无限增长；
+     *  - 队列腾出空间后通知有暂存文本的后端继续入队，
+     *    本地 PTY 同时恢复读取。
+     */
+    forwardPending_.store(false, std::memory_order_release);
+
+    if (socket_ == nullptr)
+      return;
+
+    const qint64 limit = socketBacklogLimit();
+    const size_t count = channels_->size();
+    const size_t first = forwardCursor_++ % count;
+    size_t total = 0;
+    for (size_t n = 0; n < count; ++n) {
+      TerminalBackend *backend = channels_->at((first + n) % count);
+      OutboundQueue &queue = backend->outbound_;
+      backend->metrics_.send_queue->Set(queue.Size());
+      const uint8_t *data = nullptr;
+      size_t size = 0;
+      while ((size = queue.Peek(&data)) > 0) {
+        const qint64 room =
+            limit - socket_->bytesToWrite() -
+            static_cast<qint64>(transport_.Pending());
+        if (room <= 0) {
+          if (!writeStalled_) {
+            writeStalled_ = true;
+            metrics_.write_stalls->Add();
+          }
+          break;
+        }
+        size = std::min(size, static_cast<size_t>(room));
+        transport_.Write(data, size);
+        if (recorder_) {
+          recorder_->Record(backend->index_,
+                            SessionCapture::Direction::Out, data, size);
+        }
+        queue.Consume(size);
+        backend->metrics_.tx_bytes->Add(size);
+        total += size;
+      }
+
+      if (backend->pty_ != nullptr) {
+        backend->pty_->Resume();
+      }
+      if (backend->hasPendingSend()) {
+        QMetaObject::invokeMethod(backend,
+                                  &TerminalBackend::drainPendingSend,
+                                  Qt::QueuedConnection);
+      }
+    }
+
+    if (total == 0)
+      return;
+
+    transport_.Finish();
+    metrics_.tx_bytes->Add(total);
+    observeWriteBuffer();
+    APP_LOG_DEBUG("Session %d forwarded %zu bytes to TCP client", slot_,
+                  total);
+  }
+
+private:
+  int slot_;
+  const AppOptions &options_;
+
+  /* 本会话的 Topic 域与协议组件 */
+  QByteArray domainName_;
+  LibXR::Topic::Domain domain_;
+  LibXR::Topic command_topic_;
+  ChannelRegistry *channels_ = nullptr; /* GUI 线程对象，不随会话移动 */
+  std::unique_ptr<LibXR::Topic::Server> topicServer_;
+
+  /* 连接（仅分片线程访问） */
+  QTcpSocket *socket_ = nullptr;
+  ReceiveBuffer receiveBuffer_;
+  SocketTransport transport_;
+  std::unique_ptr<SessionRecorder> recorder_;
+  ReplayEngine *replay_ = nullptr;
+  size_t forwardCursor_ = 0; /* 轮转转发的起始通道 */
+  bool writeStalled_ = false; /* socket 写缓冲达到上限，等待 bytesWritten */
+
+  /* 定时器 */
+  QTimer *pingCheckTimer_ = nullptr;
+  QTimer *receiveStatsTimer_ = nullptr;
+  QTimer *probeTimer_ = nullptr;
+
+  /* 跨线程状态 */
+  std::atomic<bool> active_{false};
+  std::atomic<bool> forwardPending_{false};
+  std::atomic<uint64_t> last_ping_us_{0}; /* 0 表示从未收到 */
+  std::atomic<uint64_t> last_remote_ping_us_{0};
+
+  /* 吞吐与队列指标（热路径只做原子自增） */
+  struct {
+    MetricsRegistry::Counter *rx_bytes;
+    MetricsRegistry::Counter *tx_bytes;
+    MetricsRegistry::Counter *frame_bytes;
+    MetricsRegistry::Gauge *write_buffer;
+    MetricsRegistry::Counter *write_stalls;
+    MetricsRegistry::Gauge *unparsed_bytes;
+  } metrics_{};
+
+  /* 链路质量（命令回调与定时器都在分片线程） */
+  LinkMonitor monitor_;
+  unsigned statsTicks_ = 0;
+
+  bool IsFresh(uint64_t last_us, uint64_t now_us) const {
+    return last_us != 0 && now_us - last_us <= monitor_.TimeoutUs();
+  }
+
+  static constexpr int kProbeIntervalMs = 250;
+  static constexpr unsigned kLinkLogTicks = 10;
+};
@@ -0,0 +1,301 @@
+#pragma once
+
+#include "AsyncLogger.hpp"
+#include "Metrics.hpp"
+#include "TerminalBackend.hpp"
+
+#include <QByteArray>
+#include <QDir>
+#include <QHostAddress>
+#include <QIODevice>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QObject>
+#include <QString>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+/*
+ * 慢订阅者策略：
+ * - LAG：订阅者落后超过共享日志容量时跳到仍然有效的最旧数据，
+ *   标记为落后并计数跳过的字节，连接保留；
+ * - DROP：直接断开落后的订阅者。
+ */
+enum class FanoutPolicy : uint8_t { LAG, DROP };
+
+/* 解析策略名称（lag / drop），非法时返回 false */
+inline bool ParseFanoutPolicy(const QString &text, FanoutPolicy *policy) {
+  const QString name = text.trimmed().toLower();
+  if (name == "lag") {
+    *policy = FanoutPolicy::LAG;
+  } else if (name == "drop") {
+    *policy = FanoutPolicy::DROP;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+struct FanoutOptions {
+  quint16 port = 0;  /* TCP 起始端口，0 表示不监听 TCP */
+  QString dir;       /* Unix 域 socket 目录，空表示不监听 */
+  size_t log_bytes = 1024 * 1024;
+  FanoutPolicy policy = FanoutPolicy::LAG;
+
+  bool enabled() const { return port != 0 || !dir.isEmpty(); }
+};
+
+/*
+ * FanoutServer：一个终端通道的原始字节分发服务
+ * - 在 127.0.0.1 的 TCP 端口与（或）Unix 域 socket
+ *   <dir>/netdebug-<通道标签>.sock 上接受任意多个订阅者，
+ *   订阅者连接后从当前位置开始收到设备输出的原始字节，发来的数据被忽略；
+ * - 发布端：Topic 回调把负载拷贝一次到共享环形日志并推进写位置，
+ *   没有订阅者时直接返回；与订阅者数量无关，不为每个订阅者拷贝；
+ * - 订阅端：每个订阅者只保存日志中的读位置，flush() 时按各自 socket
+ *   写缓冲的余量（kSubscriberBacklog）从日志中取出连续区段写出，
+ *   bytesWritten 后继续；socket 写缓冲就是订阅者自己的有界缓冲区；
+ * - 订阅者落后超过日志容量时按 FanoutPolicy 处理，不会阻塞 Topic 回调；
+ * - 指标 s<会话>.<通道>.fanout_subscribers / fanout_bytes /
+ *   fanout_lagged_bytes / fanout_dropped；
+ * - 创建、发布与 socket 读写都在会话所在的分片线程。
+ */
+class FanoutServer : public QObject {
+  Q_OBJECT
+public:
+  FanoutServer(TerminalBackend *backend, int session,
+               const FanoutOptions &options, QObject *parent = nullptr)
+      : QObject(parent), backend_(backend), policy_(options.policy),
+        log_(RoundUpPow2(std::max<size_t>(options.log_bytes, kMinLogBytes))),
+        mask_(log_.size() - 1) {
+    MetricsRegistry &registry = MetricsRegistry::Instance();
+    const std::string prefix = "s" + std::to_string(session) + "." +
+                               backend->name_.toStdString() + ".fanout_";
+    subscribers_gauge_ = registry.AddGauge(prefix + "subscribers");
+    sent_bytes_ = registry.AddCounter(prefix + "bytes");
+    lagged_bytes_ = registry.AddCounter(prefix + "lagged_bytes");
+    dropped_ = registry.AddCounter(prefix + "dropped");
+  }
+
+  ~FanoutServer() override {
+    if (local_ != nullptr) {
+      local_->close();
+    }
+  }
+
+  /* 开始监听，两种方式都失败时返回 false */
+  bool Listen(quint16 port, const QString &dir) {
+    const QByteArray &label = backend_->label_;
+    if (port != 0) {
+      tcp_ = new QTcpServer(this);
+      if (tcp_->listen(QHostAddress::LocalHost, port)) {
+        connect(tcp_, &QTcpServer::newConnection, this, [this]() {
+          while (QTcpSocket *socket = tcp_->nextPendingConnection()) {
+            socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+            addSubscriber(socket);
+          }
+        });
+        APP_LOG_INFO("%s: fan-out on 127.0.0.1:%u", label.constData(), port);
+      } else {
+        APP_LOG_WARN("%s: failed to listen on port %u: %s", label.constData(),
+                     port, tcp_->errorString().toUtf8().constData());
+        delete tcp_;
+        tcp_ = nullptr;
+      }
+    }
+
+    if (!dir.isEmpty()) {
+      const QString path = QDir(dir).filePath(
+          "netdebug-" + QString::fromUtf8(label) + ".sock");
+      local_ = new QLocalServer(this);
+      QLocalServer::removeServer(path);
+      if (local_->listen(path)) {
+        connect(local_, &QLocalServer::newConnection, this, [this]() {
+          while (QLocalSocket *socket = local_->nextPendingConnection()) {
+            addSubscriber(socket);
+          }
+        });
+        APP_LOG_INFO("%s: fan-out on %s", label.constData(),
+                     path.toUtf8().constData());
+      } else {
+        APP_LOG_WARN("%s: failed to listen on %s: %s", label.constData(),
+                     path.toUtf8().constData(),
+                     local_->errorString().toUtf8().constData());
+        delete local_;
+        local_ = nullptr;
+      }
+    }
+    return tcp_ != nullptr || local_ != nullptr;
+  }
+
+  /* Topic 回调：拷贝到共享日志并安排一次 flush */
+  void Publish(const void *data, size_t size) {
+    if (subscribers_.empty() || size == 0) {
+      return;
+    }
+    const uint8_t *bytes = static_cast<const uint8_t *>(data);
+    if (size > log_.size()) {
+      /* 超过日志容量的部分任何订阅者都来不及读，只保留末尾 */
+      bytes += size - log_.size();
+      head_ += size - log_.size();
+      size = log_.size();
+    }
+    const size_t offset = static_cast<size_t>(head_) & mask_;
+    const size_t first = std::min(size, log_.size() - offset);
+    std::memcpy(log_.data() + offset, bytes, first);
+    std::memcpy(log_.data(), bytes + first, size - first);
+    head_ += size;
+
+    if (!flushPending_) {
+      flushPending_ = true;
+      QMetaObject::invokeMethod(this, &FanoutServer::flush,
+                                Qt::QueuedConnection);
+    }
+  }
+
+private:
+  struct Subscriber {
+    QIODevice *device;
+    uint64_t cursor; /* 下一个要写出的日志位置 */
+    bool lagged;
+  };
+
+  void addSubscriber(QIODevice *device) {
+    subscribers_.push_back({device, head_, false});
+    subscribers_gauge_->Set(subscribers_.size());
+
+    /* 订阅者只读，输入直接丢弃 */
+    connect(device, &QIODevice::readyRead, device,
+            [device]() { device->readAll(); });
+    connect(device, &QIODevice::bytesWritten, this,
+            [this, device]() { pump(find(device)); });
+    auto remove = [this, device]() { removeSubscriber(device); };
+    if (auto *tcp = qobject_cast<QTcpSocket *>(device)) {
+      connect(tcp, &QTcpSocket::disconnected, this, remove);
+    } else if (auto *local = qobject_cast<QLocalSocket *>(device)) {
+      connect(local, &QLocalSocket::disconnected, this, remove);
+    }
+    APP_LOG_INFO("%s: fan-out subscriber connected (%zu)",
+                 backend_->label_.constData(), subscribers_.size());
+  }
+
+  void removeSubscriber(QIODevice *device) {
+    auto it = std::find_if(
+        subscribers_.begin(), subscribers_.end(),
+        [device](const Subscriber &sub) { return sub.device == device; });
+    if (it == subscribers_.end()) {
+      return;
+    }
+    subscribers_.erase(it);
+    subscribers_gauge_->Set(subscribers_.size());
+    device->disconnect(this);
+    device->close();
+    device->deleteLater();
+  }
+
+  Subscriber *find(QIODevice *device) {
+    for (Subscriber &sub : subscribers_) {
+      if (sub.device == device) {
+        return &sub;
+      }
+    }
+    return nullptr;
+  }
+
+  void flush() {
+    flushPending_ = false;
+    /* 倒序遍历：pump 断开当前订阅者时只移动已处理过的元素 */
+    for (size_t i = subscribers_.size(); i-- > 0;) {
+      pump(&subscribers_[i]);
+    }
+  }
+
+  /*
+   * 向一个订阅者写出尽可能多的日志数据：
+   *  - 落后超过日志容量时按策略跳过或断开；
+   *  - 每次最多写到 socket 写缓冲达到 kSubscriberBacklog，
+   *    剩余部分等 bytesWritten 再写。
+   */
+  void pump(Subscriber *sub) {
+    if (sub == nullptr) {
+      return;
+    }
+    uint64_t available = head_ - sub->cursor;
+    if (available > log_.size()) {
+      const uint64_t lost = available - log_.size();
+      if (policy_ == FanoutPolicy::DROP) {
+        APP_LOG_WARN("%s: dropping slow fan-out subscriber (%llu bytes "
+                     "behind)",
+                     backend_->label_.constData(),
+                     static_cast<unsigned long long>(available));
+        dropped_->Add();
+        removeSubscriber(sub->device);
+        return;
+      }
+      if (!sub->lagged) {
+        sub->lagged = true;
+        APP_LOG_WARN("%s: fan-out subscriber lagging, skipped %llu bytes",
+                     backend_->label_.constData(),
+                     static_cast<unsigned long long>(lost));
+      }
+      lagged_bytes_->Add(lost);
+      sub->cursor += lost;
+      available = log_.size();
+    }
+
+    while (available > 0) {
+      const qint64 room = kSubscriberBacklog - sub->device->bytesToWrite();
+      if (room <= 0) {
+        break;
+      }
+      const size_t offset = static_cast<size_t>(sub->cursor) & mask_;
+      const size_t size = static_cast<size_t>(
+          std::min<uint64_t>({available, log_.size() - offset,
+                              static_cast<uint64_t>(room)}));
+      const qint64 written = sub->device->write(
+          reinterpret_cast<const char *>(log_.data() + offset),
+          static_cast<qint64>(size));
+      if (written <= 0) {
+        break;
+      }
+      sub->cursor += static_cast<uint64_t>(written);
+      available -= static_cast<uint64_t>(written);
+      sent_bytes_->Add(static_cast<uint64_t>(written));
+    }
+    if (available == 0) {
+      sub->lagged = false;
+    }
+  }
+
+  static size_t RoundUpPow2(size_t value) {
+    size_t result = 1;
+    while (result < value) {
+      result <<= 1;
+    }
+    return result;
+  }
+
+  TerminalBackend *backend_;
+  FanoutPolicy policy_;
+  QTcpServer *tcp_ = nullptr;
+  QLocalServer *local_ = nullptr;
+
+  std::vector<uint8_t> log_; /* 共享环形日志，容量为 2 的幂 */
+  size_t mask_;
+  uint64_t head_ = 0; /* 累计写入字节数 */
+  bool flushPending_ = false;
+  std::vector<Subscriber> subscribers_;
+
+  MetricsRegistry::Gauge *subscribers_gauge_;
+  MetricsRegistry::Counter *sent_bytes_;
+  MetricsRegistry::Counter *lagged_bytes_;
+  MetricsRegistry::Counter *dropped_;
+
+  static constexpr size_t kMinLogBytes = 64 * 1024;
+  static constexpr qint64 kSubscriberBacklog = 256 * 1024;
+};
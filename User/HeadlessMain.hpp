@@ -0,0 +1,150 @@
+#pragma once
+
+#include "AppOptions.hpp"
+#include "AsyncLogger.hpp"
+#include "ChannelOutput.hpp"
+#include "DeviceManager.hpp"
+#include "StartupReport.hpp"
+#include "Worker.hpp"
+
+#include <QHash>
+#include <QThread>
+#include <QTimer>
+
+/*
+ * HeadlessMain：无界面前端（--headless）
+ * - 运行在 QCoreApplication 上，不加载 QML 与 WebEngine；
+ * - Worker、会话与解析线程与界面模式完全相同；
+ * - 各通道切换为原始输出，按 --output 规则写到标准输出、文件或 socket；
+ * - 告警模式命中时写入日志，原始输出中不插入反色标记；
+ * - DeviceManager 由命令行驱动：启动即按 --device-filter 开始广播，
+ *   设备上线后执行一次 --rename / --restart-minipc；
+ * - 启动报告在 Worker 线程启动后输出，--exit-after-startup 时随后退出。
+ */
+class HeadlessMain : public QObject {
+  Q_OBJECT
+public:
+  explicit HeadlessMain(const AppOptions &options, QObject *parent = nullptr)
+      : QObject(parent), options_(options) {
+    deviceManager_ = new DeviceManager(this);
+    worker_ = new Worker(options_, deviceManager_, this);
+    initOutputs();
+    initAlerts();
+    initDeviceManager();
+
+    startupReport_ = new StartupReport("headless",
+                                       options_.exit_after_startup, this);
+    workerThread_ = new QThread(this);
+    worker_->moveToThread(workerThread_);
+    connect(workerThread_, &QThread::started, worker_, &Worker::start);
+    connect(workerThread_, &QThread::started, startupReport_,
+            [this]() { startupReport_->viewsReady(0); });
+    workerThread_->start();
+  }
+
+  ~HeadlessMain() {
+    /* 会话在各自线程上析构后正常结束工作线程，再释放后端与 arena */
+    worker_->shutdown();
+    delete worker_;
+  }
+
+private:
+  void initOutputs() {
+    /*
+     * 按规则为每个会话的每个通道绑定输出目标：
+     *  - 同一目标（展开 {channel} 之后）只打开一次，多个通道共用；
+     *  - 无规则时所有通道写到标准输出。
+     */
+    QStringList rules = options_.outputs;
+    if (rules.isEmpty()) {
+      rules.append("*=-");
+    }
+
+    for (DeviceSession *session : worker_->sessions()) {
+      for (TerminalBackend *backend : *session->channels()) {
+        backend->setRawOutput(true);
+        for (const QString &rule : rules) {
+          const qsizetype eq = rule.indexOf('=');
+          const QString channel = eq < 0 ? "*" : rule.left(eq).trimmed();
+          const QString target = eq < 0 ? rule : rule.mid(eq + 1);
+          if (channel != "*" && channel.toUtf8() != backend->name_) {
+            continue;
+          }
+          ChannelOutput *output = outputFor(target, backend->label_);
+          if (output == nullptr) {
+            continue;
+          }
+          const QByteArray label = backend->label_;
+          connect(backend, &TerminalBackend::receiveRaw, output,
+                  [output, label](const QByteArray &data) {
+                    output->write(label, data);
+                  });
+        }
+      }
+    }
+  }
+
+  void initAlerts() {
+    for (DeviceSession *session : worker_->sessions()) {
+      for (TerminalBackend *backend : *session->channels()) {
+        connect(backend, &TerminalBackend::alertsRaised, this,
+                [](const QVariantList &events) {
+                  for (const QVariant &value : events) {
+                    const QVariantMap event = value.toMap();
+                    APP_LOG_WARN(
+                        "Alert %s @%lld: %s",
+                        event["name"].toString().toUtf8().constData(),
+                        event["offset"].toLongLong(),
+                        event["pattern"].toString().toUtf8().constData());
+                  }
+                });
+      }
+    }
+  }
+
+  ChannelOutput *outputFor(const QString &target, const QByteArray &label) {
+    QString key = target.trimmed();
+    key.replace("{channel}", QString::fromUtf8(label));
+    auto it = outputs_.find(key);
+    if (it != outputs_.end()) {
+      return it.value();
+    }
+    ChannelOutput *output = ChannelOutput::Create(target, label, this);
+    outputs_.insert(key, output); /* 失败也记录，避免重复告警 */
+    if (output != nullptr) {
+      APP_LOG_INFO("Channel %s -> %s", label.constData(),
+                   key.toUtf8().constData());
+    }
+    return output;
+  }
+
+  void initDeviceManager() {
+    /* 界面模式下由启动对话框设置过滤器，这里直接按命令行设置 */
+    deviceManager_->SetDeviceNameFilter(options_.device_filter);
+
+    if (options_.rename_device.isEmpty() && !options_.restart_minipc) {
+      return;
+    }
+    connect(deviceManager_, &DeviceManager::backendConnectedChanged, this,
+            [this]() {
+              if (!deviceManager_->isBackendConnected() || commandsSent_) {
+                return;
+              }
+              commandsSent_ = true;
+              if (!options_.rename_device.isEmpty()) {
+                deviceManager_->RenameDevice(options_.rename_device);
+              }
+              if (options_.restart_minipc) {
+                deviceManager_->RestartMiniPC();
+              }
+            });
+  }
+
+  AppOptions options_;
+  DeviceManager *deviceManager_;
+  StartupReport *startupReport_ = nullptr;
+  QHash<QString, ChannelOutput *> outputs_;
+  bool commandsSent_ = false;
+  QThread *workerThread_;
+  Worker *worker_;
+};
@@ -0,0 +1,189 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace hex_dump_detail {
+
+/* 每项为 "XX  "，按 4 字节拷贝、前进 3 字节 */
+struct HexTable {
+  char entry[256][4];
+};
+
+constexpr HexTable MakeHexTable() {
+  HexTable table{};
+  const char digits[] = "0123456789ABCDEF";
+  for (int i = 0; i < 256; ++i) {
+    table.entry[i][0] = digits[i >> 4];
+    table.entry[i][1] = digits[i & 0x0f];
+    table.entry[i][2] = ' ';
+    table.entry[i][3] = ' ';
+  }
+  return table;
+}
+
+inline constexpr HexTable kHexTable = MakeHexTable();
+
+} // namespace hex_dump_detail
+
+/*
+ * HexDumpFormatter：十六进制/ASCII 转储格式化器
+ * - 使用 256 项查表，每字节一次 4 字节拷贝，不做 printf 解析；
+ * - 输出写入调用方预先分配的缓冲区（大小由 MaxOutputSize 给出）；
+ * - 支持每行列数、行首偏移量、行尾 ASCII 栏；
+ * - 行内位置与累计字节数跨包保留，多次调用拼接后的输出与一次调用一致。
+ */
+class HexDumpFormatter {
+public:
+  struct Options {
+    unsigned columns = 16;        /* 每行字节数（1~255） */
+    bool show_offset = false;     /* 行首显示 8 位十六进制偏移 */
+    bool show_ascii = false;      /* 行尾显示可打印字符 */
+    const char *line_end = "\r\n";
+  };
+
+  HexDumpFormatter() = default;
+  explicit HexDumpFormatter(const Options &options) { SetOptions(options); }
+
+  /*
+   * 修改格式选项：
+   * - 当前行未结束时先结束该行，避免新旧布局混在同一行；
+   * - 返回写入 out 的字节数（out 至少 MaxOutputSize(0) 字节）。
+   */
+  size_t SetOptions(const Options &options, char *out = nullptr) {
+    size_t written = 0;
+    if (out != nullptr && column_ != 0) {
+      written = FinishLine(out);
+    }
+    options_ = options;
+    if (options_.columns == 0) {
+      options_.columns = 1;
+    } else if (options_.columns > kMaxColumns) {
+      options_.columns = kMaxColumns;
+    }
+    if (options_.line_end == nullptr) {
+      options_.line_end = "";
+    }
+    line_end_len_ = std::strlen(options_.line_end);
+    column_ = 0;
+    return written;
+  }
+
+  const Options &GetOptions() const { return options_; }
+
+  /* 清零累计计数与行内位置 */
+  void Reset() {
+    count_ = 0;
+    column_ = 0;
+  }
+
+  /* 已格式化的累计字节数 */
+  uint64_t Count() const { return count_; }
+
+  /* 格式化 size 字节输入所需的输出缓冲区上界（含 4 字节写入余量） */
+  size_t MaxOutputSize(size_t size) const {
+    const size_t lines = (column_ + size) / options_.columns + 1;
+    size_t per_line = line_end_len_;
+    if (options_.show_offset) {
+      per_line += kOffsetWidth;
+    }
+    if (options_.show_ascii) {
+      /* 末行不足一行时补齐空格，因此按整行计算 */
+      per_line += 3 * options_.columns + 3 + options_.columns;
+    }
+    return size * 3 + lines * per_line + sizeof(uint32_t);
+  }
+
+  /*
+   * 格式化一段数据：
+   * - 返回写入 out 的字节数；
+   * - 不会在末尾追加 '\0'。
+   */
+  size_t Format(const uint8_t *data, size_t size, char *out) {
+    char *p = out;
+    const unsigned columns = options_.columns;
+
+    size_t i = 0;
+    while (i < size) {
+      if (column_ == 0 && options_.show_offset) {
+        p = WriteOffset(p, count_);
+      }
+
+      /* 当前行剩余字节一次性处理，热循环内只有查表与拷贝 */
+      size_t run = columns - column_;
+      if (run > size - i) {
+        run = size - i;
+      }
+      const uint8_t *src = data + i;
+      for (size_t k = 0; k < run; ++k) {
+        std::memcpy(p, hex_dump_detail::kHexTable.entry[src[k]],
+                    sizeof(uint32_t));
+        p += 3;
+      }
+      if (options_.show_ascii) {
+        for (size_t k = 0; k < run; ++k) {
+          const uint8_t c = src[k];
+          ascii_[column_ + k] = (c >= 0x20 && c < 0x7f) ? static_cast<char>(c)
+                                                        : '.';
+        }
+      }
+
+      column_ += static_cast<unsigned>(run);
+      count_ += run;
+      i += run;
+
+      if (column_ == columns) {
+        p += FinishLine(p);
+      }
+    }
+
+    return static_cast<size_t>(p - out);
+  }
+
+  /*
+   * 结束当前未满的行（补齐 ASCII 栏并换行），例如在切换模式时调用；
+   * 当前行为空时不输出任何内容。
+   */
+  size_t Flush(char *out) { return column_ == 0 ? 0 : FinishLine(out); }
+
+private:
+  static constexpr unsigned kMaxColumns = 255;
+  static constexpr size_t kOffsetWidth = 10; /* "XXXXXXXX: " */
+
+  static char *WriteOffset(char *p, uint64_t offset) {
+    static const char digits[] = "0123456789ABCDEF";
+    const uint32_t value = static_cast<uint32_t>(offset);
+    for (int shift = 28; shift >= 0; shift -= 4) {
+      *p++ = digits[(value >> shift) & 0x0f];
+    }
+    *p++ = ':';
+    *p++ = ' ';
+    return p;
+  }
+
+  size_t FinishLine(char *out) {
+    char *p = out;
+    if (options_.show_ascii) {
+      for (unsigned k = column_; k < options_.columns; ++k) {
+        std::memcpy(p, "   ", 3);
+        p += 3;
+      }
+      *p++ = ' ';
+      *p++ = '|';
+      std::memcpy(p, ascii_, column_);
+      p += column_;
+      *p++ = '|';
+    }
+    std::memcpy(p, options_.line_end, line_end_len_);
+    p += line_end_len_;
+    column_ = 0;
+    return static_cast<size_t>(p - out);
+  }
+
+  Options options_;
+  size_t line_end_len_ = 2;
+  unsigned column_ = 0;
+  uint64_t count_ = 0;
+  char ascii_[kMaxColumns];
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * LatencyHistogram：流式延迟分布（对数-线性分桶）
+ * - 每个 2 的幂区间再线性分成 8 个子桶，相对误差不超过 12.5%；
+ * - 0..7 逐值计数，上限 2^40 微秒（约 12 天），超出部分计入最后一桶；
+ * - 固定约 1.2 KiB，不随样本数增长，Record() 只做一次自增；
+ * - Decay() 将全部计数减半，用于让统计跟随链路状态变化；
+ * - 非线程安全，由单个线程写入与查询。
+ */
+class LatencyHistogram {
+public:
+  static constexpr unsigned kSubBits = 3;
+  static constexpr unsigned kSubBuckets = 1u << kSubBits;
+  static constexpr unsigned kMaxBits = 40;
+  static constexpr size_t kBuckets = (kMaxBits - kSubBits + 1) * kSubBuckets;
+
+  void Record(uint64_t value) {
+    ++counts_[Index(value)];
+    ++count_;
+    max_ = std::max(max_, value);
+  }
+
+  uint64_t Count() const { return count_; }
+  uint64_t Max() const { return max_; }
+
+  /* p 取 [0, 1]，返回所在桶的上界（不超过观测到的最大值），无样本时为 0 */
+  uint64_t Percentile(double p) const {
+    if (count_ == 0) {
+      return 0;
+    }
+    const uint64_t target = std::max<uint64_t>(
+        1, static_cast<uint64_t>(std::ceil(p * static_cast<double>(count_))));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+      seen += counts_[i];
+      if (seen >= target) {
+        return std::min(UpperBound(i), max_);
+      }
+    }
+    return max_;
+  }
+
+  /* 全部计数减半（最大值保留为剩余样本所在最高桶的上界） */
+  void Decay() {
+    count_ = 0;
+    size_t highest = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+      counts_[i] >>= 1;
+      count_ += counts_[i];
+      if (counts_[i] != 0) {
+        highest = i;
+      }
+    }
+    max_ = count_ == 0 ? 0 : std::min(max_, UpperBound(highest));
+  }
+
+  void Reset() {
+    counts_.fill(0);
+    count_ = 0;
+    max_ = 0;
+  }
+
+private:
+  static size_t Index(uint64_t value) {
+    if (value < kSubBuckets) {
+      return static_cast<size_t>(value);
+    }
+    value = std::min<uint64_t>(value, (uint64_t{1} << kMaxBits) - 1);
+    unsigned msb = 63;
+    while ((value >> msb) == 0) {
+      --msb;
+    }
+    const unsigned shift = msb - kSubBits;
+    const size_t sub = static_cast<size_t>(value >> shift) & (kSubBuckets - 1);
+    return (msb - kSubBits + 1) * kSubBuckets + sub;
+  }
+
+  static uint64_t UpperBound(size_t index) {
+    if (index < kSubBuckets) {
+      return index;
+    }
+    const unsigned msb =
+        static_cast<unsigned>(index / kSubBuckets) + kSubBits - 1;
+    const unsigned shift = msb - kSubBits;
+    const uint64_t lower = (kSubBuckets + index % kSubBuckets) << shift;
+    return lower + (uint64_t{1} << shift) - 1;
+  }
+
+  std::array<uint32_t, kBuckets> counts_{};
+  uint64_t count_ = 0;
+  uint64_t max_ = 0;
+};
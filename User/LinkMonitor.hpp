@@ -0,0 +1,215 @@
+#pragma once
+
+#include "LatencyHistogram.hpp"
+
+#include <QMutex>
+#include <QMutexLocker>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/*
+ * LinkStats：链路统计快照（微秒）
+ * - rtt_*：PROBE → PROBE_ACK 往返时间，设备不回应 PROBE 时
+ *   rtt_supported 为 false；
+ * - interval_*：相邻两次 PING 的到达间隔；
+ * - jitter_*：相邻两个到达间隔之差的绝对值；
+ * - timeout_us：当前使用的离线判定阈值。
+ */
+struct LinkStats {
+  bool rtt_supported = false;
+  uint64_t rtt_p50_us = 0;
+  uint64_t rtt_p99_us = 0;
+  uint64_t rtt_max_us = 0;
+  uint64_t interval_p50_us = 0;
+  uint64_t interval_p99_us = 0;
+  uint64_t jitter_p50_us = 0;
+  uint64_t jitter_p99_us = 0;
+  uint64_t jitter_max_us = 0;
+  uint64_t probes_sent = 0;
+  uint64_t probes_lost = 0;
+  uint64_t timeout_us = 0;
+  bool degraded = false;
+};
+
+/*
+ * LinkMonitor：单个会话的链路质量监测
+ * - 定期发出带序号的 PROBE，设备回 PROBE_ACK 后计算往返时间；
+ * - 记录 PING 到达间隔与抖动的流式分布（p50/p99/max）；
+ * - 离线阈值随链路统计自适应：样本不足时为 kDefaultTimeoutUs，之后取
+ *   3 × 间隔 p99 + RTT p99，限制在 [kMinTimeoutUs, kMaxTimeoutUs]，
+ *   偶发的 Wi-Fi 卡顿不再触发重连；
+ * - 丢包率或间隔 p99 明显偏高时标记为 degraded，提示链路已劣化；
+ * - 连续 kProbeAttempts 次 PROBE 均无应答时认为设备不支持探测，
+ *   之后每 kProbeBackoff 个探测周期才重试一次，收到应答后恢复原周期；
+ * - 分布每 kDecayTicks 次 Tick() 减半，统计跟随链路变化；
+ * - 除 TimeoutUs() 与 Snapshot() 外只在会话所在的解析线程调用。
+ */
+class LinkMonitor {
+public:
+  static constexpr uint64_t kDefaultTimeoutUs = 300 * 1000;
+  static constexpr uint64_t kMinTimeoutUs = 300 * 1000;
+  static constexpr uint64_t kMaxTimeoutUs = 3000 * 1000;
+  static constexpr uint64_t kMinSamples = 32;
+  static constexpr unsigned kDecayTicks = 10;
+  static constexpr uint64_t kProbeAttempts = 20;
+  static constexpr unsigned kProbeBackoff = 120;
+
+  /* 新连接开始时清空统计 */
+  void Reset() {
+    rtt_.Reset();
+    interval_.Reset();
+    jitter_.Reset();
+    probes_.fill({});
+    last_ping_us_ = 0;
+    last_interval_us_ = 0;
+    next_seq_ = 1;
+    probes_sent_ = 0;
+    probes_lost_ = 0;
+    probe_skips_ = 0;
+    window_sent_ = 0;
+    window_lost_ = 0;
+    rtt_supported_ = false;
+    degraded_ = false;
+    ticks_ = 0;
+    timeout_us_.store(kDefaultTimeoutUs, std::memory_order_relaxed);
+    Publish();
+  }
+
+  /* 收到 PING */
+  void OnPing(uint64_t now_us) {
+    if (last_ping_us_ != 0) {
+      const uint64_t gap = now_us - last_ping_us_;
+      interval_.Record(gap);
+      if (last_interval_us_ != 0) {
+        jitter_.Record(gap > last_interval_us_ ? gap - last_interval_us_
+                                               : last_interval_us_ - gap);
+      }
+      last_interval_us_ = gap;
+    }
+    last_ping_us_ = now_us;
+  }
+
+  /* 本次探测周期是否发送 PROBE；设备从未应答时退避 */
+  bool ProbeDue() {
+    if (rtt_supported_ || probes_sent_ < kProbeAttempts) {
+      return true;
+    }
+    return ++probe_skips_ % kProbeBackoff == 0;
+  }
+
+  /* 分配下一个 PROBE 序号并记录发送时间；被覆盖的未应答 PROBE 计为丢失 */
+  uint32_t NextProbe(uint64_t now_us) {
+    const uint32_t seq = next_seq_++;
+    Probe &slot = probes_[seq % kProbeRing];
+    if (slot.seq != 0 && !slot.acked && rtt_supported_) {
+      ++probes_lost_;
+      ++window_lost_;
+    }
+    slot = {seq, now_us, false};
+    ++probes_sent_;
+    ++window_sent_;
+    return seq;
+  }
+
+  /* 收到 PROBE_ACK */
+  void OnProbeAck(uint32_t seq, uint64_t now_us) {
+    Probe &slot = probes_[seq % kProbeRing];
+    if (slot.seq != seq || slot.acked) {
+      return; /* 过期或重复的应答 */
+    }
+    slot.acked = true;
+    rtt_supported_ = true;
+    rtt_.Record(now_us - slot.sent_us);
+  }
+
+  /* 每秒调用：更新阈值、发布快照，周期性衰减分布 */
+  void Tick() {
+    uint64_t timeout = kDefaultTimeoutUs;
+    if (interval_.Count() >= kMinSamples) {
+      timeout = 3 * interval_.Percentile(0.99) + rtt_.Percentile(0.99);
+      timeout = std::clamp(timeout, kMinTimeoutUs, kMaxTimeoutUs);
+    }
+    timeout_us_.store(timeout, std::memory_order_relaxed);
+
+    /* 丢包超过 5% 或 PING 间隔 p99 逼近阈值的一半视为劣化 */
+    const bool lossy = window_sent_ >= 20 && window_lost_ * 20 > window_sent_;
+    const bool slow = interval_.Count() >= kMinSamples &&
+                      interval_.Percentile(0.99) * 2 > timeout;
+    degraded_ = lossy || slow;
+
+    Publish();
+
+    if (++ticks_ % kDecayTicks == 0) {
+      rtt_.Decay();
+      interval_.Decay();
+      jitter_.Decay();
+      window_sent_ = 0;
+      window_lost_ = 0;
+    }
+  }
+
+  /* 当前离线阈值（任意线程） */
+  uint64_t TimeoutUs() const {
+    return timeout_us_.load(std::memory_order_relaxed);
+  }
+
+  /* 最近一次发布的统计（任意线程） */
+  LinkStats Snapshot() const {
+    QMutexLocker locker(&snapshot_mutex_);
+    return snapshot_;
+  }
+
+private:
+  struct Probe {
+    uint32_t seq = 0;
+    uint64_t sent_us = 0;
+    bool acked = false;
+  };
+
+  void Publish() {
+    LinkStats stats;
+    stats.rtt_supported = rtt_supported_;
+    stats.rtt_p50_us = rtt_.Percentile(0.50);
+    stats.rtt_p99_us = rtt_.Percentile(0.99);
+    stats.rtt_max_us = rtt_.Max();
+    stats.interval_p50_us = interval_.Percentile(0.50);
+    stats.interval_p99_us = interval_.Percentile(0.99);
+    stats.jitter_p50_us = jitter_.Percentile(0.50);
+    stats.jitter_p99_us = jitter_.Percentile(0.99);
+    stats.jitter_max_us = jitter_.Max();
+    stats.probes_sent = probes_sent_;
+    stats.probes_lost = probes_lost_;
+    stats.timeout_us = TimeoutUs();
+    stats.degraded = degraded_;
+
+    QMutexLocker locker(&snapshot_mutex_);
+    snapshot_ = stats;
+  }
+
+  static constexpr size_t kProbeRing = 64;
+
+  LatencyHistogram rtt_;
+  LatencyHistogram interval_;
+  LatencyHistogram jitter_;
+  std::array<Probe, kProbeRing> probes_{};
+
+  uint64_t last_ping_us_ = 0;
+  uint64_t last_interval_us_ = 0;
+  uint32_t next_seq_ = 1;
+  uint64_t probes_sent_ = 0;
+  uint64_t probes_lost_ = 0;
+  unsigned probe_skips_ = 0;
+  uint64_t window_sent_ = 0;
+  uint64_t window_lost_ = 0;
+  bool rtt_supported_ = false;
+  bool degraded_ = false;
+  unsigned ticks_ = 0;
+
+  std::atomic<uint64_t> timeout_us_{kDefaultTimeoutUs};
+
+  mutable QMutex snapshot_mutex_;
+  LinkStats snapshot_;
+};
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#include <tlhelp32.h>
+
+#include <vector>
+#elif defined(__APPLE__)
+#include <mach/mach.h>
+#include <sys/resource.h>
+#else
+#include <dirent.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <map>
+#include <vector>
+#endif
+
+/*
+ * 进程内存占用查询：
+ * - rss 为当前常驻内存，peak_rss 为峰值常驻内存，单位字节；
+ * - 平台不支持时返回 0。
+ */
+struct ProcessMemory {
+  uint64_t rss = 0;
+  uint64_t peak_rss = 0;
+
+  static ProcessMemory Query() {
+    ProcessMemory memory;
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters,
+                             sizeof(counters))) {
+      memory.rss = counters.WorkingSetSize;
+      memory.peak_rss = counters.PeakWorkingSetSize;
+    }
+#elif defined(__APPLE__)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if (task_info(mach_task_self(), MACH_TASK_BASIC_INFO,
+                  reinterpret_cast<task_info_t>(&info), &count) == KERN_SUCCESS) {
+      memory.rss = info.resident_size;
+    }
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+      memory.peak_rss = static_cast<uint64_t>(usage.ru_maxrss);
+    }
+#else
+    /* /proc/self/status 中的 VmRSS / VmHWM，单位 kB */
+    std::FILE *file = std::fopen("/proc/self/status", "r");
+    if (file != nullptr) {
+      char line[256];
+      unsigned long long kb = 0;
+      while (std::fgets(line, sizeof(line), file) != nullptr) {
+        if (std::sscanf(line, "VmRSS: %llu kB", &kb) == 1) {
+          memory.rss = kb * 1024;
+        } else if (std::sscanf(line, "VmHWM: %llu kB", &kb) == 1) {
+          memory.peak_rss = kb * 1024;
+        }
+      }
+      std::fclose(file);
+    }
+#endif
+    return memory;
+  }
+
+  /*
+   * 本进程及全部子孙进程的常驻内存之和（字节）：
+   * - 用于统计 QtWebEngineProcess 等渲染/GPU 子进程；
+   * - Linux 扫描 /proc，Windows 遍历进程快照；
+   * - 其他平台只返回本进程的 rss。
+   */
+  static uint64_t QueryTreeRss() {
+#if defined(_WIN32)
+    const DWORD self = GetCurrentProcessId();
+    HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+    if (snapshot == INVALID_HANDLE_VALUE) {
+      return Query().rss;
+    }
+    std::vector<std::pair<DWORD, DWORD>> processes; /* pid, ppid */
+    PROCESSENTRY32 entry;
+    entry.dwSize = sizeof(entry);
+    for (BOOL ok = Process32First(snapshot, &entry); ok;
+         ok = Process32Next(snapshot, &entry)) {
+      processes.emplace_back(entry.th32ProcessID, entry.th32ParentProcessID);
+    }
+    CloseHandle(snapshot);
+
+    uint64_t total = 0;
+    std::vector<DWORD> pending = {self};
+    while (!pending.empty()) {
+      const DWORD pid = pending.back();
+      pending.pop_back();
+      HANDLE process =
+          OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+      if (process != nullptr) {
+        PROCESS_MEMORY_COUNTERS counters;
+        if (GetProcessMemoryInfo(process, &counters, sizeof(counters))) {
+          total += counters.WorkingSetSize;
+        }
+        CloseHandle(process);
+      }
+      for (const auto &[child, parent] : processes) {
+        if (parent == pid && child != pid) {
+          pending.push_back(child);
+        }
+      }
+    }
+    return total;
+#elif defined(__APPLE__)
+    return Query().rss;
+#else
+    /* stat 第 4 个字段为 ppid，statm 第 2 个字段为常驻页数 */
+    std::multimap<long, long> children;
+    if (DIR *dir = opendir("/proc")) {
+      while (dirent *ent = readdir(dir)) {
+        char *end = nullptr;
+        const long pid = std::strtol(ent->d_name, &end, 10);
+        if (pid <= 0 || *end != '\0') {
+          continue;
+        }
+        char path[64];
+        std::snprintf(path, sizeof(path), "/proc/%ld/stat", pid);
+        std::FILE *file = std::fopen(path, "r");
+        if (file == nullptr) {
+          continue;
+        }
+        char buffer[512];
+        const size_t len = std::fread(buffer, 1, sizeof(buffer) - 1, file);
+        std::fclose(file);
+        buffer[len] = '\0';
+        /* 进程名可能含空格，从最后一个 ')' 之后解析 */
+        const char *rparen = std::strrchr(buffer, ')');
+        long ppid = 0;
+        if (rparen != nullptr &&
+            std::sscanf(rparen + 1, " %*c %ld", &ppid) == 1) {
+          children.emplace(ppid, pid);
+        }
+      }
+      closedir(dir);
+    }
+
+    const uint64_t page = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+    uint64_t total = 0;
+    std::vector<long> pending = {static_cast<long>(getpid())};
+    while (!pending.empty()) {
+      const long pid = pending.back();
+      pending.pop_back();
+      char path[64];
+      std::snprintf(path, sizeof(path), "/proc/%ld/statm", pid);
+      if (std::FILE *file = std::fopen(path, "r")) {
+        unsigned long long size = 0, resident = 0;
+        if (std::fscanf(file, "%llu %llu", &size, &resident) == 2) {
+          total += resident * page;
+        }
+        std::fclose(file);
+      }
+      auto range = children.equal_range(pid);
+      for (auto it = range.first; it != range.second; ++it) {
+        pending.push_back(it->second);
+      }
+    }
+    return total;
+#endif
+  }
+};
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * MetricsRegistry：进程内的吞吐与队列深度指标
+ * - Counter 只增不减（字节数、包数、丢弃数），快照时按两次快照之间的
+ *   增量换算为每秒速率；
+ * - Gauge 记录当前值与高水位（队列深度、socket 写缓冲区），高水位在
+ *   每次快照后回落到当前值，反映的是一个快照周期内的峰值；
+ * - 热路径只有一次 relaxed 原子操作，不加锁、不分配；
+ * - 指标在启动时注册，地址在进程生命周期内不变，同名注册返回同一对象，
+ *   会话与其通道可以共享一个指标；
+ * - Snapshot() 只由一个消费者（Worker 的导出定时器）调用。
+ */
+class MetricsRegistry {
+public:
+  class Counter {
+  public:
+    void Add(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t Value() const { return value_.load(std::memory_order_relaxed); }
+
+  private:
+    std::atomic<uint64_t> value_{0};
+  };
+
+  class Gauge {
+  public:
+    void Set(uint64_t value) {
+      value_.store(value, std::memory_order_relaxed);
+      uint64_t high = high_water_.load(std::memory_order_relaxed);
+      while (value > high && !high_water_.compare_exchange_weak(
+                                 high, value, std::memory_order_relaxed)) {
+      }
+    }
+    uint64_t Value() const { return value_.load(std::memory_order_relaxed); }
+    uint64_t HighWater() const {
+      return high_water_.load(std::memory_order_relaxed);
+    }
+
+    /* 取出本周期高水位，并以当前值开始下一周期 */
+    uint64_t TakeHighWater() {
+      return high_water_.exchange(Value(), std::memory_order_relaxed);
+    }
+
+  private:
+    std::atomic<uint64_t> value_{0};
+    std::atomic<uint64_t> high_water_{0};
+  };
+
+  enum class Kind : uint8_t { COUNTER, GAUGE };
+
+  struct Sample {
+    std::string name;
+    Kind kind;
+    uint64_t value;      /* 计数器累计值或量表当前值 */
+    uint64_t high_water; /* 量表本周期峰值（计数器为 0） */
+    double rate;         /* 计数器每秒增量（量表为 0） */
+  };
+
+  static MetricsRegistry &Instance() {
+    static MetricsRegistry registry;
+    return registry;
+  }
+
+  /* 注册计数器（同名返回已有对象） */
+  Counter *AddCounter(const std::string &name) {
+    return &Find(name, Kind::COUNTER).counter;
+  }
+
+  /* 注册量表（同名返回已有对象） */
+  Gauge *AddGauge(const std::string &name) {
+    return &Find(name, Kind::GAUGE).gauge;
+  }
+
+  /* 按注册顺序取出全部指标，now_us 为单调时钟时间 */
+  std::vector<Sample> Snapshot(uint64_t now_us) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const double seconds =
+        last_snapshot_us_ == 0 ? 0 : (now_us - last_snapshot_us_) / 1e6;
+    last_snapshot_us_ = now_us;
+
+    std::vector<Sample> samples;
+    samples.reserve(entries_.size());
+    for (Entry &entry : entries_) {
+      if (entry.kind == Kind::COUNTER) {
+        const uint64_t value = entry.counter.Value();
+        const double rate =
+            seconds > 0 ? (value - entry.last_value) / seconds : 0;
+        entry.last_value = value;
+        samples.push_back({entry.name, entry.kind, value, 0, rate});
+      } else {
+        samples.push_back({entry.name, entry.kind, entry.gauge.Value(),
+                           entry.gauge.TakeHighWater(), 0});
+      }
+    }
+    return samples;
+  }
+
+private:
+  struct Entry {
+    std::string name;
+    Kind kind = Kind::COUNTER;
+    Counter counter;
+    Gauge gauge;
+    uint64_t last_value = 0; /* 上次快照时的计数，仅快照线程访问 */
+  };
+
+  Entry &Find(const std::string &name, Kind kind) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (Entry &entry : entries_) {
+      if (entry.name == name) {
+        return entry;
+      }
+    }
+    Entry &entry = entries_.emplace_back();
+    entry.name = name;
+    entry.kind = kind;
+    return entry;
+  }
+
+  std::mutex mutex_;
+  std::deque<Entry> entries_; /* deque 扩容不移动已有元素 */
+  uint64_t last_snapshot_us_ = 0;
+};
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "AsyncLogger.hpp"
+#include "Metrics.hpp"
+
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHostAddress>
+#include <QObject>
+#include <QString>
+#include <QUdpSocket>
+
+#include <vector>
+
+/*
+ * MetricsExporter：周期性导出指标快照
+ * - target 为文件路径时以 JSON Lines 追加写入，每个快照一行；
+ * - target 为 "udp:HOST:PORT" 时每个快照发送一个 UDP 数据报，
+ *   便于本机或局域网内的采集脚本直接接收；
+ * - 每行格式：
+ *   {"ts_us":N,"metrics":[{"name":"s0.tcp.rx_bytes","type":"counter",
+ *    "value":N,"rate":X},{"name":"s0.tcp.write_buffer","type":"gauge",
+ *    "value":N,"high_water":N},...]}
+ * - 只在所属线程（Worker 线程）中使用。
+ */
+class MetricsExporter : public QObject {
+  Q_OBJECT
+public:
+  MetricsExporter(const QString &target, QObject *parent = nullptr)
+      : QObject(parent) {
+    if (target.startsWith("udp:")) {
+      const QString address = target.mid(4);
+      const int colon = address.lastIndexOf(':');
+      bool ok = false;
+      port_ = colon > 0 ? address.mid(colon + 1).toUShort(&ok) : 0;
+      host_ = QHostAddress(address.left(colon));
+      if (!ok || host_.isNull()) {
+        APP_LOG_ERROR("Invalid metrics export target: %s",
+                      target.toLocal8Bit().constData());
+        return;
+      }
+      udp_ = new QUdpSocket(this);
+      APP_LOG_INFO("Exporting metrics to udp %s:%u",
+                   host_.toString().toUtf8().constData(), port_);
+      return;
+    }
+
+    QDir().mkpath(QFileInfo(target).absolutePath());
+    file_.setFileName(target);
+    if (!file_.open(QIODevice::WriteOnly | QIODevice::Append)) {
+      APP_LOG_ERROR("Failed to open metrics export file: %s",
+                    target.toLocal8Bit().constData());
+      return;
+    }
+    APP_LOG_INFO("Exporting metrics to %s", target.toLocal8Bit().constData());
+  }
+
+  bool isEnabled() const { return udp_ != nullptr || file_.isOpen(); }
+
+  void Export(uint64_t now_us,
+              const std::vector<MetricsRegistry::Sample> &samples) {
+    if (!isEnabled()) {
+      return;
+    }
+    ToJson(now_us, samples, line_);
+    if (udp_ != nullptr) {
+      udp_->writeDatagram(line_, host_, port_);
+    } else {
+      line_.append('\n');
+      file_.write(line_);
+      file_.flush();
+    }
+  }
+
+  /* 快照编码为一行 JSON（复用 out 的容量） */
+  static void ToJson(uint64_t now_us,
+                     const std::vector<MetricsRegistry::Sample> &samples,
+                     QByteArray &out) {
+    out.clear();
+    out.append("{\"ts_us\":").append(QByteArray::number(now_us));
+    out.append(",\"metrics\":[");
+    for (size_t i = 0; i < samples.size(); ++i) {
+      const MetricsRegistry::Sample &sample = samples[i];
+      if (i != 0) {
+        out.append(',');
+      }
+      out.append("{\"name\":\"");
+      for (char c : sample.name) {
+        if (c == '"' || c == '\\') {
+          out.append('\\');
+        }
+        out.append(c);
+      }
+      out.append("\",\"value\":").append(QByteArray::number(sample.value));
+      if (sample.kind == MetricsRegistry::Kind::COUNTER) {
+        out.append(",\"type\":\"counter\",\"rate\":")
+            .append(QByteArray::number(sample.rate, 'f', 1));
+      } else {
+        out.append(",\"type\":\"gauge\",\"high_water\":")
+            .append(QByteArray::number(sample.high_water));
+      }
+      out.append('}');
+    }
+    out.append("]}");
+  }
+
+private:
+  QFile file_;
+  QUdpSocket *udp_ = nullptr;
+  QHostAddress host_;
+  quint16 port_ = 0;
+  QByteArray line_;
+};
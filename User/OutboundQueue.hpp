@@ -0,0 +1,146 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+
+/*
+ * OutboundQueue：发送方向的连续预留队列（bip buffer）
+ * - 生产者先 Reserve() 一段连续空间，直接在其中编码，再 Commit()，
+ *   不需要中间打包缓冲区；
+ * - 剩余连续空间不足时从头部回绕，尾部空洞由 last_ 标记，消费者读到
+ *   last_ 后跳回开头；
+ * - 生产者可能来自 GUI 线程与会话所在的解析分片线程，由
+ *   producer_mutex_ 串行化；消费者只有会话所在的分片线程，与生产者之间
+ *   无锁；
+ * - 空间不足时返回失败，由调用者决定如何统计与提示，不会静默丢弃。
+ */
+class OutboundQueue {
+public:
+  OutboundQueue(uint8_t *storage, size_t capacity)
+      : data_(storage), capacity_(capacity), last_(capacity) {}
+
+  OutboundQueue(const OutboundQueue &) = delete;
+  OutboundQueue &operator=(const OutboundQueue &) = delete;
+
+  /* 生产者锁：一次 sendText 的多个分包在同一把锁内完成 */
+  std::unique_lock<std::mutex> LockProducer() {
+    return std::unique_lock<std::mutex>(producer_mutex_);
+  }
+
+  /*
+   * 预留 size 字节连续空间（须持有生产者锁）：
+   * - 成功返回写入地址，之后必须调用 Commit()；
+   * - 空间不足返回 nullptr。
+   */
+  uint8_t *Reserve(size_t size) {
+    const size_t write = write_.load(std::memory_order_relaxed);
+    const size_t read = read_.load(std::memory_order_acquire);
+
+    size_t start = 0;
+    if (write < read) {
+      /* 写指针已回绕：只能写到读指针之前，且不能追上读指针 */
+      if (write + size >= read) {
+        return nullptr;
+      }
+      start = write;
+    } else if (write + size <= capacity_) {
+      start = write;
+    } else if (size < read) {
+      start = 0;
+    } else {
+      return nullptr;
+    }
+
+    reserve_start_ = start;
+    return data_ + start;
+  }
+
+  /* 提交预留空间中实际写入的 size 字节（须持有生产者锁） */
+  void Commit(size_t size) {
+    const size_t write = write_.load(std::memory_order_relaxed);
+    const size_t end = reserve_start_ + size;
+    if (reserve_start_ < write) {
+      /* 本次从头部回绕，记录尾部有效数据的结束位置 */
+      last_.store(write, std::memory_order_release);
+    } else if (end > last_.load(std::memory_order_relaxed)) {
+      last_.store(capacity_, std::memory_order_release);
+    }
+    write_.store(end, std::memory_order_release);
+  }
+
+  /* 整段拷贝入队（自行加锁），空间不足返回 false */
+  bool Push(const void *data, size_t size) {
+    auto lock = LockProducer();
+    uint8_t *dst = Reserve(size);
+    if (dst == nullptr) {
+      return false;
+    }
+    std::memcpy(dst, data, size);
+    Commit(size);
+    return true;
+  }
+
+  /* 消费者：取出当前可读的连续区段，无数据时返回 0 */
+  size_t Peek(const uint8_t **data) {
+    size_t read = read_.load(std::memory_order_relaxed);
+    const size_t write = write_.load(std::memory_order_acquire);
+    const size_t last = last_.load(std::memory_order_acquire);
+
+    if (write < read && read == last) {
+      read = 0;
+      read_.store(0, std::memory_order_release);
+    }
+
+    *data = data_ + read;
+    return write < read ? last - read : write - read;
+  }
+
+  /* 消费者：释放 Peek() 返回区段的前 size 字节 */
+  void Consume(size_t size) {
+    read_.store(read_.load(std::memory_order_relaxed) + size,
+                std::memory_order_release);
+  }
+
+  /* 消费者：丢弃全部已入队数据，返回丢弃的字节数 */
+  size_t Discard() {
+    size_t total = 0;
+    const uint8_t *data = nullptr;
+    while (const size_t size = Peek(&data)) {
+      Consume(size);
+      total += size;
+    }
+    return total;
+  }
+
+  /* 已入队字节数（近似值，可在任意线程调用） */
+  size_t Size() const {
+    const size_t read = read_.load(std::memory_order_acquire);
+    const size_t write = write_.load(std::memory_order_acquire);
+    const size_t last = last_.load(std::memory_order_acquire);
+    return write < read ? (last - read) + write : write - read;
+  }
+
+  size_t Capacity() const { return capacity_; }
+
+  /* 因空间不足被拒绝的字节数 */
+  void AddDropped(size_t size) {
+    dropped_.fetch_add(size, std::memory_order_relaxed);
+  }
+  uint64_t Dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+  uint8_t *data_;
+  size_t capacity_;
+
+  std::atomic<size_t> write_{0};
+  std::atomic<size_t> read_{0};
+  std::atomic<size_t> last_;
+
+  std::mutex producer_mutex_;
+  size_t reserve_start_ = 0; /* 仅在生产者锁内访问 */
+
+  std::atomic<uint64_t> dropped_{0};
+};
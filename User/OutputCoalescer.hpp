@@ -0,0 +1,224 @@
+#pragma once
+
+#include "Metrics.hpp"
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QObject>
+#include <QTimer>
+
+#include <algorithm>
+#include <atomic>
+#include <vector>
+
+/*
+ * OutputCoalescer：终端输出合并器
+ * - append 可在任意线程调用，只把数据追加到待发缓冲区；
+ * - 在所属线程按显示帧节奏（默认 16 ms）最多发出一次 flushed；
+ * - 缓冲区达到字节阈值时提前发出，避免单帧数据过大；
+ * - 待发缓冲区有上限（默认 8 MiB）：所属线程停顿而设备持续输出时，
+ *   超出上限的新数据被丢弃并计数，下一帧末尾附一行提示；
+ * - 待发与发出两个缓冲区交替使用，容量在帧之间保留，不逐帧重新分配；
+ * - 可随数据附带高亮区间，与数据一起合并，发出时换算为帧内位置，
+ *   由接收方只在显示路径上加标记，数据本身保持原样；
+ * - 统计输入包数、发出次数、字节数与待发深度，用于观察合并效果。
+ */
+class OutputCoalescer : public QObject {
+  Q_OBJECT
+
+public:
+  /* 高亮区间 [begin, end)，append 时相对本段数据，flushed 时相对整帧 */
+  struct Highlight {
+    qsizetype begin;
+    qsizetype end;
+  };
+  using Highlights = std::vector<Highlight>;
+
+  explicit OutputCoalescer(QObject *parent = nullptr)
+      : QObject(parent), timer_(new QTimer(this)) {
+    timer_->setSingleShot(true);
+    timer_->setTimerType(Qt::PreciseTimer);
+    connect(timer_, &QTimer::timeout, this, &OutputCoalescer::flush);
+    last_flush_.start();
+  }
+
+  /* 设置帧间隔（毫秒） */
+  void setFrameInterval(int ms) { frame_interval_ms_ = ms; }
+
+  /* 设置提前发出的字节阈值 */
+  void setByteThreshold(qsizetype bytes) { byte_threshold_ = bytes; }
+
+  /* 设置待发缓冲区上限（不小于字节阈值） */
+  void setByteLimit(qsizetype bytes) {
+    byte_limit_ = std::max(bytes, byte_threshold_);
+  }
+
+  /* 丢弃字节同时累加到指标（可为空） */
+  void setDropCounter(MetricsRegistry::Counter *counter) {
+    drop_counter_ = counter;
+  }
+
+  /*
+   * 追加一段输出（线程安全）：
+   * - 首个数据到达时投递一次调度请求；
+   * - 超过阈值时投递一次立即发出请求。
+   */
+  void append(const char *data, qsizetype size) {
+    append(data, size, nullptr, 0);
+  }
+
+  /* 追加一段输出并附带高亮区间（线程安全，区间按起点升序） */
+  void append(const char *data, qsizetype size, const Highlight *highlights,
+              size_t count) {
+    if (size <= 0) {
+      return;
+    }
+
+    bool need_schedule = false;
+    bool need_flush = false;
+    bool dropped = false;
+    {
+      QMutexLocker locker(&mutex_);
+      const qsizetype base = pending_.size();
+      if (base + size > byte_limit_) {
+        /* 超出上限：整段丢弃（高亮区间一起），只计数，提示随下一帧发出 */
+        dropped = true;
+        dropped_pending_ += static_cast<quint64>(size);
+      } else {
+        for (size_t i = 0; i < count; ++i) {
+          pending_highlights_.push_back(
+              {base + highlights[i].begin, base + highlights[i].end});
+        }
+        pending_.append(data, size);
+        pending_bytes_.store(pending_.size(), std::memory_order_relaxed);
+      }
+      if (!scheduled_) {
+        scheduled_ = true;
+        need_schedule = true;
+      }
+      if (!urgent_ && pending_.size() >= byte_threshold_) {
+        urgent_ = true;
+        need_flush = true;
+      }
+    }
+
+    if (dropped) {
+      dropped_bytes_.fetch_add(static_cast<quint64>(size),
+                               std::memory_order_relaxed);
+      if (drop_counter_ != nullptr) {
+        drop_counter_->Add(static_cast<uint64_t>(size));
+      }
+    } else {
+      packets_in_.fetch_add(1, std::memory_order_relaxed);
+      bytes_in_.fetch_add(static_cast<quint64>(size),
+                          std::memory_order_relaxed);
+    }
+
+    if (need_flush) {
+      QMetaObject::invokeMethod(this, &OutputCoalescer::flush,
+                                Qt::QueuedConnection);
+    } else if (need_schedule) {
+      QMetaObject::invokeMethod(this, &OutputCoalescer::schedule,
+                                Qt::QueuedConnection);
+    }
+  }
+
+  void append(const QByteArray &data) { append(data.constData(), data.size()); }
+
+  quint64 packetsIn() const {
+    return packets_in_.load(std::memory_order_relaxed);
+  }
+  quint64 flushes() const { return flushes_.load(std::memory_order_relaxed); }
+  quint64 bytesIn() const { return bytes_in_.load(std::memory_order_relaxed); }
+  quint64 droppedBytes() const {
+    return dropped_bytes_.load(std::memory_order_relaxed);
+  }
+
+  /* 待发缓冲区当前字节数（任意线程） */
+  qsizetype pendingBytes() const {
+    return pending_bytes_.load(std::memory_order_relaxed);
+  }
+
+public slots:
+  /*
+   * 立即发出当前缓冲区（所属线程）：
+   * - 待发缓冲区与 out_ 交换，发出后清空 out_ 但保留容量，
+   *   下一次交换时作为新的待发缓冲区；
+   */
+  void flush() {
+    quint64 dropped = 0;
+    {
+      QMutexLocker locker(&mutex_);
+      out_.swap(pending_);
+      out_highlights_.swap(pending_highlights_);
+      dropped = dropped_pending_;
+      dropped_pending_ = 0;
+      pending_bytes_.store(0, std::memory_order_relaxed);
+      scheduled_ = false;
+      urgent_ = false;
+    }
+    timer_->stop();
+    last_flush_.restart();
+
+    if (dropped > 0) {
+      out_.append(QStringLiteral("\r\n[display backlog full, %1 bytes "
+                                 "dropped]\r\n")
+                      .arg(dropped)
+                      .toLatin1());
+    }
+    if (!out_.isEmpty()) {
+      flushes_.fetch_add(1, std::memory_order_relaxed);
+      emit flushed(out_, out_highlights_);
+    }
+    /* resize(0) 保留容量；接收方仍持有共享副本时分离，不影响其数据 */
+    out_.resize(0);
+    out_highlights_.clear();
+  }
+
+signals:
+  /* 一帧内合并后的输出与其中的高亮区间（通常为空） */
+  void flushed(const QByteArray &data,
+               const OutputCoalescer::Highlights &highlights);
+
+private slots:
+  /* 对齐到下一个显示帧：距上次发出不足一帧时等待剩余时间 */
+  void schedule() {
+    if (timer_->isActive()) {
+      return;
+    }
+    const qint64 elapsed = last_flush_.elapsed();
+    const int wait =
+        elapsed >= frame_interval_ms_
+            ? 0
+            : static_cast<int>(frame_interval_ms_ - elapsed);
+    timer_->start(wait);
+  }
+
+private:
+  QTimer *timer_;
+  QElapsedTimer last_flush_;
+
+  QMutex mutex_;
+  QByteArray pending_;
+  Highlights pending_highlights_;
+  quint64 dropped_pending_ = 0; /* 本帧内丢弃的字节数 */
+  bool scheduled_ = false;
+  bool urgent_ = false;
+
+  int frame_interval_ms_ = 16;
+  qsizetype byte_threshold_ = 64 * 1024;
+  qsizetype byte_limit_ = 8 * 1024 * 1024;
+  MetricsRegistry::Counter *drop_counter_ = nullptr;
+
+  /* 正在发出的一帧（所属线程），与 pending_ 交替使用 */
+  QByteArray out_;
+  Highlights out_highlights_;
+
+  std::atomic<quint64> packets_in_{0};
+  std::atomic<quint64> flushes_{0};
+  std::atomic<quint64> bytes_in_{0};
+  std::atomic<quint64> dropped_bytes_{0};
+  std::atomic<qsizetype> pending_bytes_{0};
+};
@@ -0,0 +1,411 @@
+#pragma once
+
+#include <QByteArray>
+#include <QRegularExpression>
+#include <QString>
+#include <QStringList>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+/* 一次模式匹配：起点为通道字节流中的偏移（从会话建立起累计） */
+struct PatternMatch {
+  uint16_t pattern; /* PatternSet::patterns() 中的序号 */
+  uint64_t offset;
+  uint32_t length;
+};
+
+/*
+ * PatternSet：编译后的告警模式集合（只读，可在多个通道间共享）
+ * - 模式写法："text" 为字面量，"re:EXPR" 为正则，前缀 "i:" 表示忽略
+ *   大小写（ASCII），可与 re: 组合，如 "i:re:watchdog.*reset"；
+ * - 全部字面量编译为一个 Aho-Corasick 自动机，转移表稠密展开
+ *   （每状态 256 项），扫描时每字节一次查表，与模式数量无关；
+ * - 自动机在折叠为小写的输入上运行，区分大小写的字面量命中后再逐字节
+ *   核对原始数据；
+ * - 正则不进入自动机：从表达式中提取一段必然出现的字面量（至少 3 字节）
+ *   作为预筛选并加入自动机，只有某行命中预筛选时才在该行上执行正则；
+ *   提取不到字面量的正则（含 | 或分组等）对每一行执行；
+ * - 单个字面量最长 kMaxLiteral 字节，状态数上限 65535，超出的模式跳过。
+ */
+class PatternSet {
+public:
+  struct Pattern {
+    QString source;     /* 原始写法，用于显示 */
+    QByteArray literal; /* 字面量，或正则的预筛选字面量（可为空） */
+    bool regex = false;
+    bool nocase = false;
+    QRegularExpression re;
+  };
+
+  static constexpr size_t kMaxLiteral = 128;
+
+  /* 编译模式列表，非法或放不下的模式跳过并写入 errors */
+  static std::shared_ptr<const PatternSet> Compile(const QStringList &sources,
+                                                   QStringList *errors) {
+    auto set = std::shared_ptr<PatternSet>(new PatternSet());
+    for (int c = 0; c < 256; ++c) {
+      set->fold_[c] = static_cast<uint8_t>(
+          c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+    }
+
+    std::vector<std::array<int32_t, 256>> trie(1);
+    trie[0].fill(-1);
+    std::vector<std::vector<uint16_t>> outputs(1);
+
+    for (const QString &raw : sources) {
+      QString text = raw;
+      Pattern pattern;
+      pattern.source = raw;
+      if (text.startsWith("i:")) {
+        pattern.nocase = true;
+        text = text.mid(2);
+      }
+      if (text.startsWith("re:")) {
+        pattern.regex = true;
+        pattern.re.setPattern(text.mid(3));
+        if (pattern.nocase) {
+          pattern.re.setPatternOptions(
+              QRegularExpression::CaseInsensitiveOption);
+        }
+        if (!pattern.re.isValid()) {
+          if (errors != nullptr) {
+            errors->append(raw + ": " + pattern.re.errorString());
+          }
+          continue;
+        }
+        pattern.re.optimize();
+        pattern.literal = RequiredLiteral(text.mid(3));
+      } else {
+        pattern.literal = text.toUtf8();
+        if (pattern.literal.isEmpty()) {
+          continue;
+        }
+      }
+      if (static_cast<size_t>(pattern.literal.size()) > kMaxLiteral ||
+          set->patterns_.size() >= UINT16_MAX) {
+        if (errors != nullptr) {
+          errors->append(raw + ": pattern too long");
+        }
+        continue;
+      }
+
+      /* 折叠后插入字典树 */
+      const uint16_t index = static_cast<uint16_t>(set->patterns_.size());
+      size_t state = 0;
+      bool fits = true;
+      for (char ch : pattern.literal) {
+        const uint8_t c = set->fold_[static_cast<uint8_t>(ch)];
+        if (trie[state][c] < 0) {
+          if (trie.size() >= UINT16_MAX) {
+            fits = false;
+            break;
+          }
+          trie[state][c] = static_cast<int32_t>(trie.size());
+          trie.emplace_back().fill(-1);
+          outputs.emplace_back();
+        }
+        state = static_cast<size_t>(trie[state][c]);
+      }
+      if (!fits) {
+        if (errors != nullptr) {
+          errors->append(raw + ": too many patterns");
+        }
+        continue;
+      }
+      if (!pattern.literal.isEmpty()) {
+        outputs[state].push_back(index);
+      }
+      if (pattern.regex) {
+        set->regexes_.push_back(index);
+      }
+      set->patterns_.push_back(std::move(pattern));
+    }
+
+    set->Build(trie, outputs);
+    return set;
+  }
+
+  const std::vector<Pattern> &patterns() const { return patterns_; }
+  bool empty() const { return patterns_.empty(); }
+
+private:
+  friend class PatternScanner;
+
+  PatternSet() = default;
+
+  /*
+   * 按广度优先计算失败链接并展开为稠密转移表：
+   * - 缺失的转移直接指向失败状态的对应转移，扫描时无需回溯；
+   * - 每个状态的输出合并其失败链上的输出。
+   */
+  void Build(const std::vector<std::array<int32_t, 256>> &trie,
+             std::vector<std::vector<uint16_t>> &outputs) {
+    const size_t states = trie.size();
+    next_.assign(states * 256, 0);
+    std::vector<uint16_t> fail(states, 0);
+    std::vector<uint16_t> queue;
+    queue.reserve(states);
+
+    for (int c = 0; c < 256; ++c) {
+      if (trie[0][c] > 0) {
+        next_[c] = static_cast<uint16_t>(trie[0][c]);
+        queue.push_back(static_cast<uint16_t>(trie[0][c]));
+      }
+    }
+    for (size_t head = 0; head < queue.size(); ++head) {
+      const uint16_t state = queue[head];
+      const std::vector<uint16_t> &inherited = outputs[fail[state]];
+      outputs[state].insert(outputs[state].end(), inherited.begin(),
+                            inherited.end());
+      for (int c = 0; c < 256; ++c) {
+        const int32_t child = trie[state][c];
+        if (child > 0) {
+          fail[child] = next_[fail[state] * 256 + c];
+          next_[state * 256 + c] = static_cast<uint16_t>(child);
+          queue.push_back(static_cast<uint16_t>(child));
+        } else {
+          next_[state * 256 + c] = next_[fail[state] * 256 + c];
+        }
+      }
+    }
+
+    out_begin_.assign(states + 1, 0);
+    for (size_t state = 0; state < states; ++state) {
+      out_begin_[state + 1] =
+          out_begin_[state] + static_cast<uint32_t>(outputs[state].size());
+      out_.insert(out_.end(), outputs[state].begin(), outputs[state].end());
+    }
+  }
+
+  /*
+   * 从正则中提取必然出现的最长字面量：
+   * - 含 | 或分组时放弃（无法保守判断）；
+   * - 字符类、. ^ $ 与 \d \s \w \b 一类转义打断字面量，
+   *   ? * { 使前一个字符可选；
+   * - \Q…\E 之间按字面量处理，转义的标点为字面量；
+   * - 其他带操作数或表示字符的转义（\x41、\0nn、\cX、\p{…}、\t 等）
+   *   无法可靠还原为字节，直接放弃；
+   * - 不足 3 字节时返回空，表示不做预筛选；超过 kMaxLiteral 时截断。
+   */
+  static QByteArray RequiredLiteral(const QString &expr) {
+    if (expr.contains('|') || expr.contains('(')) {
+      return {};
+    }
+    QString best;
+    QString run;
+    auto finish = [&]() {
+      if (run.toUtf8().size() > best.toUtf8().size()) {
+        best = run;
+      }
+      run.clear();
+    };
+    for (qsizetype i = 0; i < expr.size(); ++i) {
+      const QChar c = expr[i];
+      if (c == '[') {
+        finish();
+        for (++i; i < expr.size() && expr[i] != ']'; ++i) {
+          if (expr[i] == '\\') {
+            ++i;
+          }
+        }
+      } else if (c == '\\') {
+        if (++i >= expr.size()) {
+          return {};
+        }
+        const QChar escaped = expr[i];
+        if (!escaped.isLetterOrNumber()) {
+          run += escaped;
+        } else if (escaped == 'Q') {
+          for (++i; i < expr.size(); ++i) {
+            if (expr[i] == '\\' && i + 1 < expr.size() &&
+                expr[i + 1] == 'E') {
+              ++i;
+              break;
+            }
+            run += expr[i];
+          }
+        } else if (QStringLiteral("dDsSwWbBAzZGhHvVR").contains(escaped)) {
+          finish();
+        } else {
+          return {};
+        }
+      } else if (c == '?' || c == '*' || c == '{') {
+        run.chop(1);
+        finish();
+        if (c == '{') {
+          while (i < expr.size() && expr[i] != '}') {
+            ++i;
+          }
+        }
+      } else if (c == '+' || c == '.' || c == '^' || c == '$') {
+        finish();
+      } else {
+        run += c;
+      }
+    }
+    finish();
+    const QByteArray literal = best.toUtf8();
+    if (literal.size() < 3) {
+      return {};
+    }
+    return literal.left(static_cast<qsizetype>(kMaxLiteral));
+  }
+
+  std::vector<Pattern> patterns_;
+  std::vector<uint16_t> regexes_;   /* 正则模式的序号 */
+  std::array<uint8_t, 256> fold_{}; /* ASCII 小写折叠表 */
+  std::vector<uint16_t> next_;      /* 状态 × 256 的转移表 */
+  std::vector<uint32_t> out_begin_; /* 各状态输出在 out_ 中的区间 */
+  std::vector<uint16_t> out_;
+};
+
+/*
+ * PatternScanner：一个通道上的流式匹配状态（只在 Topic 回调线程使用）
+ * - 自动机状态与最近 kMaxLiteral 字节跨包保留，跨包的匹配不会漏掉；
+ * - 有正则时按行缓存（单行最多 kMaxLine 字节），换行时对命中预筛选
+ *   的正则求值，每行每个正则最多报告一次；
+ * - 没有命中时每字节只有一次查表与一次比较，不分配内存。
+ */
+class PatternScanner {
+public:
+  explicit PatternScanner(std::shared_ptr<const PatternSet> set)
+      : set_(std::move(set)), line_hits_(set_->patterns().size(), 0) {}
+
+  const PatternSet &set() const { return *set_; }
+
+  /* 已扫描的字节数（下一段数据的起始偏移） */
+  uint64_t Offset() const { return offset_; }
+
+  /* 扫描一段数据，匹配追加到 out */
+  void Scan(const uint8_t *data, size_t size, std::vector<PatternMatch> &out) {
+    const PatternSet &set = *set_;
+    const uint16_t *next = set.next_.data();
+    const uint8_t *fold = set.fold_.data();
+    const uint32_t *out_begin = set.out_begin_.data();
+    const bool lines = !set.regexes_.empty();
+
+    uint32_t state = state_;
+    size_t line_from = 0;
+    for (size_t i = 0; i < size; ++i) {
+      state = next[state * 256 + fold[data[i]]];
+      if (out_begin[state] != out_begin[state + 1]) {
+        onHits(state, data, i + 1, out);
+      }
+      if (lines && data[i] == '\n') {
+        appendLine(data + line_from, i + 1 - line_from);
+        finishLine(out);
+        line_from = i + 1;
+        line_offset_ = offset_ + line_from;
+      }
+    }
+    if (lines) {
+      appendLine(data + line_from, size - line_from);
+    }
+
+    state_ = static_cast<uint16_t>(state);
+    remember(data, size);
+    offset_ += size;
+  }
+
+private:
+  void onHits(uint32_t state, const uint8_t *data, size_t end,
+              std::vector<PatternMatch> &out) {
+    const PatternSet &set = *set_;
+    for (uint32_t k = set.out_begin_[state]; k < set.out_begin_[state + 1];
+         ++k) {
+      const uint16_t index = set.out_[k];
+      const PatternSet::Pattern &pattern = set.patterns_[index];
+      if (pattern.regex) {
+        line_hits_[index] = 1;
+        continue;
+      }
+      const size_t length = static_cast<size_t>(pattern.literal.size());
+      if (!pattern.nocase && !verify(pattern.literal, data, end)) {
+        continue;
+      }
+      out.push_back({index, offset_ + end - length,
+                     static_cast<uint32_t>(length)});
+    }
+  }
+
+  /* 核对以 data[end - 1] 结尾的原始字节，开头可能在之前的包中 */
+  bool verify(const QByteArray &literal, const uint8_t *data,
+              size_t end) const {
+    const size_t length = static_cast<size_t>(literal.size());
+    if (length <= end) {
+      return std::memcmp(data + end - length, literal.constData(), length) ==
+             0;
+    }
+    const size_t head = length - end;
+    return head <= history_size_ &&
+           std::memcmp(history_.data() + history_size_ - head,
+                       literal.constData(), head) == 0 &&
+           std::memcmp(data, literal.constData() + head, end) == 0;
+  }
+
+  /* 保留最近 kMaxLiteral 字节，供跨包核对 */
+  void remember(const uint8_t *data, size_t size) {
+    const size_t capacity = history_.size();
+    if (size >= capacity) {
+      std::memcpy(history_.data(), data + size - capacity, capacity);
+      history_size_ = capacity;
+      return;
+    }
+    const size_t keep = std::min(history_size_, capacity - size);
+    std::memmove(history_.data(), history_.data() + history_size_ - keep,
+                 keep);
+    std::memcpy(history_.data() + keep, data, size);
+    history_size_ = keep + size;
+  }
+
+  void appendLine(const uint8_t *data, size_t size) {
+    const size_t room = kMaxLine - static_cast<size_t>(line_.size());
+    line_.append(reinterpret_cast<const char *>(data),
+                 static_cast<qsizetype>(std::min(size, room)));
+  }
+
+  /* 行结束：对命中预筛选（或无预筛选）的正则求值 */
+  void finishLine(std::vector<PatternMatch> &out) {
+    const PatternSet &set = *set_;
+    QString text;
+    bool decoded = false;
+    for (uint16_t index : set.regexes_) {
+      const PatternSet::Pattern &pattern = set.patterns_[index];
+      if (!pattern.literal.isEmpty() && !line_hits_[index]) {
+        continue;
+      }
+      line_hits_[index] = 0;
+      if (!decoded) {
+        text = QString::fromUtf8(line_);
+        decoded = true;
+      }
+      const QRegularExpressionMatch match = pattern.re.match(text);
+      if (!match.hasMatch() || match.capturedLength() == 0) {
+        continue;
+      }
+      const qsizetype start =
+          text.left(match.capturedStart()).toUtf8().size();
+      out.push_back({index, line_offset_ + static_cast<uint64_t>(start),
+                     static_cast<uint32_t>(match.captured().toUtf8().size())});
+    }
+    line_.clear();
+  }
+
+  static constexpr size_t kMaxLine = 4096;
+
+  std::shared_ptr<const PatternSet> set_;
+  uint16_t state_ = 0;
+  uint64_t offset_ = 0;
+  std::array<uint8_t, PatternSet::kMaxLiteral> history_{};
+  size_t history_size_ = 0;
+
+  QByteArray line_;          /* 当前行（正则求值用） */
+  uint64_t line_offset_ = 0; /* 当前行起点偏移 */
+  std::vector<uint8_t> line_hits_; /* 当前行命中预筛选的正则 */
+};
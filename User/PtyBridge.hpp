@@ -0,0 +1,226 @@
+#pragma once
+
+#include "AsyncLogger.hpp"
+#include "Metrics.hpp"
+#include "TerminalBackend.hpp"
+
+#include <QByteArray>
+#include <QDir>
+#include <QFile>
+#include <QObject>
+#include <QSocketNotifier>
+#include <QString>
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#if defined(Q_OS_UNIX)
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#include <termios.h>
+#include <unistd.h>
+#endif
+
+/*
+ * PtyBridge：把一个终端通道暴露为本地伪终端（Unix）
+ * - 打开 PTY 主端，从端设为 raw 模式，并在 link_dir 下创建
+ *   netdebug-<通道标签> 符号链接，pyserial / minicom 可直接打开；
+ * - 设备 → PTY：Topic 回调直接把负载写入主端（非阻塞），不经过
+ *   QString 与 WebChannel；没有程序读取从端、内核缓冲写满时丢弃并计数；
+ * - PTY → 设备：主端可读时读出字节，按 sendText 相同的方式在发送队列的
+ *   预留空间中封包，随即唤醒转发；队列已满时停止读取，剩余字节留在
+ *   本地缓冲区，会话消费队列后调用 Resume() 继续；
+ * - 自己保持一个从端描述符，外部程序关闭从端后主端不会进入 EIO 状态；
+ * - 指标 s<会话>.<通道>.pty_out_bytes / pty_in_bytes / pty_dropped_bytes
+ *   分别为写入 PTY、从 PTY 读出与因无人读取而丢弃的字节数；
+ * - 创建、读写与 Resume() 都在会话所在的分片线程。
+ */
+class PtyBridge : public QObject {
+  Q_OBJECT
+public:
+  PtyBridge(TerminalBackend *backend, int session, QObject *parent = nullptr)
+      : QObject(parent), backend_(backend), buffer_(kReadBytes) {
+    MetricsRegistry &registry = MetricsRegistry::Instance();
+    const std::string prefix = "s" + std::to_string(session) + "." +
+                               backend->name_.toStdString() + ".pty_";
+    out_bytes_ = registry.AddCounter(prefix + "out_bytes");
+    in_bytes_ = registry.AddCounter(prefix + "in_bytes");
+    dropped_bytes_ = registry.AddCounter(prefix + "dropped_bytes");
+  }
+
+  ~PtyBridge() override {
+#if defined(Q_OS_UNIX)
+    if (!link_.isEmpty()) {
+      QFile::remove(link_);
+    }
+    if (slave_ >= 0) {
+      ::close(slave_);
+    }
+    if (master_ >= 0) {
+      ::close(master_);
+    }
+#endif
+  }
+
+  /* 打开 PTY 并在 link_dir 下创建符号链接，失败时返回 false */
+  bool Open(const QString &link_dir) {
+#if defined(Q_OS_UNIX)
+    master_ = ::posix_openpt(O_RDWR | O_NOCTTY);
+    if (master_ < 0 || ::grantpt(master_) != 0 || ::unlockpt(master_) != 0) {
+      APP_LOG_WARN("%s: failed to open PTY (errno %d)",
+                   backend_->label_.constData(), errno);
+      return false;
+    }
+    /* 多个分片线程可能同时打开，Linux 上使用可重入的 ptsname_r */
+#if defined(__linux__)
+    char name[128];
+    if (::ptsname_r(master_, name, sizeof(name)) != 0) {
+#else
+    const char *name = ::ptsname(master_);
+    if (name == nullptr) {
+#endif
+      APP_LOG_WARN("%s: ptsname failed", backend_->label_.constData());
+      return false;
+    }
+    slave_path_ = name;
+    ::fcntl(master_, F_SETFL, ::fcntl(master_, F_GETFL) | O_NONBLOCK);
+
+    slave_ = ::open(name, O_RDWR | O_NOCTTY);
+    termios tio;
+    if (slave_ >= 0 && ::tcgetattr(slave_, &tio) == 0) {
+      ::cfmakeraw(&tio);
+      ::tcsetattr(slave_, TCSANOW, &tio);
+    }
+
+    link_ = QDir(link_dir).filePath("netdebug-" +
+                                    QString::fromUtf8(backend_->label_));
+    QFile::remove(link_);
+    if (!QFile::link(QString::fromLocal8Bit(slave_path_), link_)) {
+      APP_LOG_WARN("%s: failed to create %s", backend_->label_.constData(),
+                   link_.toUtf8().constData());
+      link_.clear();
+    }
+
+    notifier_ = new QSocketNotifier(master_, QSocketNotifier::Read, this);
+    connect(notifier_, &QSocketNotifier::activated, this,
+            &PtyBridge::onReadable);
+    APP_LOG_INFO("%s: PTY %s%s%s", backend_->label_.constData(),
+                 slave_path_.constData(), link_.isEmpty() ? "" : " -> ",
+                 link_.toUtf8().constData());
+    return true;
+#else
+    Q_UNUSED(link_dir);
+    APP_LOG_WARN("%s: PTY bridge is not supported on this platform",
+                 backend_->label_.constData());
+    return false;
+#endif
+  }
+
+  /* 设备 → PTY：写入主端，缓冲区已满时丢弃剩余部分 */
+  void Write(const void *data, size_t size) {
+#if defined(Q_OS_UNIX)
+    const char *bytes = static_cast<const char *>(data);
+    while (size > 0) {
+      const ssize_t n = ::write(master_, bytes, size);
+      if (n > 0) {
+        out_bytes_->Add(static_cast<uint64_t>(n));
+        bytes += n;
+        size -= static_cast<size_t>(n);
+      } else if (n < 0 && errno == EINTR) {
+        continue;
+      } else {
+        dropped_bytes_->Add(size);
+        break;
+      }
+    }
+#else
+    Q_UNUSED(data);
+    Q_UNUSED(size);
+#endif
+  }
+
+  /* 发送队列腾出空间后继续入队暂存字节并恢复读取 */
+  void Resume() {
+    if (notifier_ != nullptr && !notifier_->isEnabled() && enqueuePending()) {
+      onReadable();
+    }
+  }
+
+  /* 连接断开时丢弃尚未入队的暂存字节并恢复读取 */
+  void Discard() {
+    pending_offset_ = pending_size_ = 0;
+    if (notifier_ != nullptr) {
+      notifier_->setEnabled(true);
+    }
+  }
+
+private:
+  void onReadable() {
+#if defined(Q_OS_UNIX)
+    while (enqueuePending()) {
+      const ssize_t n = ::read(master_, buffer_.data(), buffer_.size());
+      if (n < 0 && errno == EINTR) {
+        continue;
+      }
+      if (n <= 0) {
+        break;
+      }
+      in_bytes_->Add(static_cast<uint64_t>(n));
+      pending_size_ = static_cast<size_t>(n);
+      pending_offset_ = 0;
+    }
+#endif
+  }
+
+  /*
+   * 把暂存字节按最大负载分包入队（与 drainPendingSend 相同的封包方式）：
+   * - 全部入队返回 true 并保持读取；
+   * - 队列已满返回 false，暂停读取直到 Resume()。
+   */
+  bool enqueuePending() {
+    const size_t begin = pending_offset_;
+    if (pending_offset_ < pending_size_) {
+      OutboundQueue &queue = backend_->outbound_;
+      TopicEncoder &encoder = backend_->encoder_;
+      auto lock = queue.LockProducer();
+      while (pending_offset_ < pending_size_) {
+        const size_t chunk = std::min(encoder.MaxPayload(),
+                                      pending_size_ - pending_offset_);
+        uint8_t *frame = queue.Reserve(encoder.FrameSize(chunk));
+        if (frame == nullptr) {
+          break;
+        }
+        queue.Commit(
+            encoder.Encode(buffer_.data() + pending_offset_, chunk, frame));
+        pending_offset_ += chunk;
+      }
+    }
+
+    if (pending_offset_ > begin) {
+      backend_->metrics_.send_bytes->Add(pending_offset_ - begin);
+      emit backend_->dataQueued();
+    }
+    const bool done = pending_offset_ == pending_size_;
+    notifier_->setEnabled(done);
+    return done;
+  }
+
+  TerminalBackend *backend_;
+  int master_ = -1;
+  int slave_ = -1;
+  QByteArray slave_path_;
+  QString link_;
+  QSocketNotifier *notifier_ = nullptr;
+
+  std::vector<uint8_t> buffer_; /* 从主端读出、尚未入队的字节 */
+  size_t pending_offset_ = 0;
+  size_t pending_size_ = 0;
+
+  MetricsRegistry::Counter *out_bytes_;
+  MetricsRegistry::Counter *in_bytes_;
+  MetricsRegistry::Counter *dropped_bytes_;
+
+  static constexpr size_t kReadBytes = 4096;
+};
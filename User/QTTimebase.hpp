@@ -1,5 +1,7 @@
-#include <QDateTime>
-#include <limits.h>
+#pragma once
+
+#include <chrono>
+#include <cstdint>
 
 #include "timebase.hpp"
 
@@ -8,9 +10,32 @@ namespace LibXR {
  * @brief QTTimebase 类，用于获取 Qt 系统的时间基准。Provides a timebase for Qt
  * systems.
  *
+ * 基于 std::chrono::steady_clock（单调、高精度），起点为进程启动：
+ * - 不受系统时间调整（NTP 校时、手动改时间）影响；
+ * - NowMicros() / NowMillis() 提供 64 位时间戳，供程序自身的
+ *   在线检测、延迟统计与抓包时间戳使用，不会回绕。
  */
 class QTTimebase : public Timebase {
 public:
+  /**
+   * @brief 进程启动以来的单调时间（微秒，64 位）。Monotonic microseconds since
+   * process start.
+   */
+  static uint64_t NowMicros() {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start_)
+            .count());
+  }
+
+  /**
+   * @brief 进程启动以来的单调时间（毫秒，64 位）。Monotonic milliseconds since
+   * process start.
+   */
+  static int64_t NowMillis() {
+    return static_cast<int64_t>(NowMicros() / 1000);
+  }
+
   /**
    * @brief 获取当前时间戳（微秒级）。Returns the current timestamp in
    * microseconds.
@@ -18,11 +43,7 @@ public:
    * @return TimestampUS
    */
   TimestampUS _get_microseconds() {
-    // 获取当前时间
-    qint64 ms = QDateTime::currentMSecsSinceEpoch();
-    // 转换为微秒，并从起始时间（libxr_linux_start_time）中减去
-    qint64 microseconds = ms * 1000; // 转换为微秒
-    return static_cast<TimestampUS>(microseconds % UINT32_MAX);
+    return static_cast<TimestampUS>(NowMicros());
   }
 
   /**
@@ -32,9 +53,11 @@ public:
    * @return TimestampMS
    */
   TimestampMS _get_milliseconds() {
-    // 获取当前时间（毫秒）
-    qint64 ms = QDateTime::currentMSecsSinceEpoch();
-    return static_cast<TimestampMS>(ms % UINT32_MAX);
+    return static_cast<TimestampMS>(NowMillis());
   }
+
+private:
+  static inline const std::chrono::steady_clock::time_point start_ =
+      std::chrono::steady_clock::now();
 };
 } // namespace LibXR
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <QIODevice>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+/*
+ * ReceiveBuffer：固定容量的接收缓冲区
+ * - 存储由外部（BufferArena）一次性提供，每次 readyRead 都直接 read()
+ *   到这块内存；
+ * - 每读出一段就原地交给处理函数（Topic::Server::ParseData），
+ *   跨两次读取的半帧由 Server 内部的解析队列续接，这里不做重组拷贝；
+ * - 仅在所属会话的解析分片线程中使用，统计量无需原子操作。
+ */
+class ReceiveBuffer {
+public:
+  struct Stats {
+    uint64_t wakeups = 0;            /* readyRead 次数 */
+    uint64_t bytes = 0;              /* 累计读取字节数 */
+    uint64_t max_bytes_per_wakeup = 0;
+    size_t high_water = 0;           /* 单次 read() 填充的最大字节数 */
+  };
+
+  ReceiveBuffer(uint8_t *storage, size_t capacity)
+      : data_(storage), capacity_(capacity) {}
+
+  /*
+   * 读空设备中的可读数据：
+   * - 每段最多 capacity 字节，读出后立即调用 handler(data, size)；
+   * - handler 返回前缓冲区内容保持有效，返回后会被下一段覆盖；
+   * - 返回本次唤醒读取的总字节数。
+   */
+  template <typename Handler>
+  size_t ReadFrom(QIODevice *device, Handler &&handler) {
+    size_t total = 0;
+    for (;;) {
+      const qint64 n = device->read(reinterpret_cast<char *>(data_),
+                                    static_cast<qint64>(capacity_));
+      if (n <= 0) {
+        break;
+      }
+      const size_t size = static_cast<size_t>(n);
+      stats_.high_water = std::max(stats_.high_water, size);
+      handler(data_, size);
+      total += size;
+    }
+
+    ++stats_.wakeups;
+    stats_.bytes += total;
+    stats_.max_bytes_per_wakeup =
+        std::max<uint64_t>(stats_.max_bytes_per_wakeup, total);
+    return total;
+  }
+
+  size_t Capacity() const { return capacity_; }
+  const Stats &GetStats() const { return stats_; }
+
+  /* 取出自上次调用以来的统计窗口（用于计算每秒速率），并清空窗口 */
+  Stats TakeWindow() {
+    Stats window;
+    window.wakeups = stats_.wakeups - window_start_.wakeups;
+    window.bytes = stats_.bytes - window_start_.bytes;
+    window.max_bytes_per_wakeup = stats_.max_bytes_per_wakeup;
+    window.high_water = stats_.high_water;
+    window_start_ = stats_;
+    return window;
+  }
+
+private:
+  uint8_t *data_;
+  size_t capacity_;
+  Stats stats_;
+  Stats window_start_;
+};
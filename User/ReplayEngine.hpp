@@ -0,0 +1,139 @@
+#pragma once
+
+#include "AsyncLogger.hpp"
+#include "SessionCapture.hpp"
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+#include <functional>
+
+/*
+ * ReplayEngine：会话回放
+ * - 按录制时间戳把记录交给 sink（工作线程中调用）；
+ * - speed > 0 时按倍速回放（1 = 实时）；
+ * - speed == 0 时全速回放，每个事件循环切片处理 kSliceBytes，
+ *   结束时输出吞吐量，用于离线评估解析与显示链路；
+ * - start_us > 0 时先经索引定位到该时刻（自录制开始的微秒数），
+ *   从第一条不早于它的记录开始回放。
+ */
+class ReplayEngine : public QObject {
+  Q_OBJECT
+
+public:
+  using Sink = std::function<void(const SessionReader::Record &record)>;
+
+  ReplayEngine(const QString &path, double speed, uint64_t start_us, Sink sink,
+               QObject *parent = nullptr)
+      : QObject(parent), path_(path), speed_(speed), start_us_(start_us),
+        sink_(std::move(sink)), timer_(new QTimer(this)) {
+    timer_->setSingleShot(true);
+    timer_->setTimerType(Qt::PreciseTimer);
+    connect(timer_, &QTimer::timeout, this, &ReplayEngine::step);
+  }
+
+  /* 打开抓包并开始回放，失败返回 false */
+  bool start() {
+    if (!reader_.Open(path_)) {
+      APP_LOG_ERROR("Failed to open replay file: %s",
+                    reader_.ErrorString().toLocal8Bit().constData());
+      return false;
+    }
+
+    APP_LOG_INFO("Replay %s at %s, index entries: %zu%s",
+                 path_.toLocal8Bit().constData(),
+                 speed_ > 0 ? QString("%1x").arg(speed_).toLatin1().constData()
+                            : "max speed",
+                 reader_.IndexSize(),
+                 reader_.IndexRebuilt() ? " (rebuilt)" : "");
+
+    if (start_us_ > 0) {
+      reader_.SeekTime(start_us_);
+      APP_LOG_INFO("Replay starts at %.3f s",
+                   static_cast<double>(start_us_) / 1e6);
+    }
+    has_pending_ = reader_.Next(pending_);
+    base_timestamp_us_ = has_pending_ ? pending_.timestamp_us : 0;
+    clock_.start();
+    timer_->start(0);
+    return true;
+  }
+
+signals:
+  void finished();
+
+private slots:
+  void step() {
+    if (speed_ <= 0) {
+      stepMaxSpeed();
+    } else {
+      stepTimed();
+    }
+  }
+
+private:
+  /* 全速：处理一个切片后让出事件循环 */
+  void stepMaxSpeed() {
+    size_t slice = 0;
+    while (has_pending_ && slice < kSliceBytes) {
+      deliver();
+      slice += pending_.size;
+      has_pending_ = reader_.Next(pending_);
+    }
+    if (has_pending_) {
+      timer_->start(0);
+    } else {
+      finish();
+    }
+  }
+
+  /* 倍速：交付所有已到期的记录，并为下一条记录设置定时器 */
+  void stepTimed() {
+    const double elapsed_us = clock_.nsecsElapsed() / 1000.0 * speed_;
+    while (has_pending_ &&
+           pending_.timestamp_us - base_timestamp_us_ <= elapsed_us) {
+      deliver();
+      has_pending_ = reader_.Next(pending_);
+    }
+    if (!has_pending_) {
+      finish();
+      return;
+    }
+    const double due_us =
+        (pending_.timestamp_us - base_timestamp_us_) / speed_ -
+        clock_.nsecsElapsed() / 1000.0;
+    timer_->start(due_us > 0 ? static_cast<int>(due_us / 1000) : 0);
+  }
+
+  void deliver() {
+    sink_(pending_);
+    bytes_ += pending_.size;
+    ++records_;
+  }
+
+  void finish() {
+    const double seconds = clock_.nsecsElapsed() / 1e9;
+    APP_LOG_INFO("Replay finished: %llu records, %llu bytes in %.3f s "
+                 "(%.1f MB/s)",
+                 static_cast<unsigned long long>(records_),
+                 static_cast<unsigned long long>(bytes_), seconds,
+                 seconds > 0 ? bytes_ / seconds / (1024.0 * 1024.0) : 0.0);
+    emit finished();
+  }
+
+  static constexpr size_t kSliceBytes = 4 * 1024 * 1024;
+
+  QString path_;
+  double speed_;
+  uint64_t start_us_;
+  Sink sink_;
+  QTimer *timer_;
+  SessionReader reader_;
+  SessionReader::Record pending_;
+  bool has_pending_ = false;
+  uint64_t base_timestamp_us_ = 0;
+  QElapsedTimer clock_;
+  uint64_t records_ = 0;
+  uint64_t bytes_ = 0;
+};
@@ -0,0 +1,390 @@
+#include "ScrollbackStore.hpp"
+#include "AsyncLogger.hpp"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QRegularExpression>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
+
+namespace {
+
+constexpr size_t kMinSegmentBytes = 1024 * 1024;
+constexpr size_t kMaxSegmentBytes = 1024 * 1024 * 1024;
+constexpr size_t kWindowBytes = 4 * 1024 * 1024; /* 单次扫描窗口 */
+constexpr size_t kPreviewBytes = 512;
+
+using Searcher = std::boyer_moore_horspool_searcher<const char *>;
+
+/* 由匹配位置构造结果：列与长度按 UTF-16 计，预览为所在行（截断） */
+ScrollbackStore::Match MakeMatch(uint64_t line, const char *line_start,
+                                 const char *hit, size_t hit_size,
+                                 const char *end) {
+  const char *line_end = static_cast<const char *>(
+      std::memchr(line_start, '\n', static_cast<size_t>(end - line_start)));
+  if (line_end == nullptr) {
+    line_end = end;
+  }
+  const size_t preview = std::min(
+      static_cast<size_t>(line_end - line_start), kPreviewBytes);
+
+  ScrollbackStore::Match match;
+  match.line = line;
+  match.column = static_cast<uint32_t>(
+      QString::fromUtf8(line_start, hit - line_start).size());
+  match.length = static_cast<uint32_t>(
+      QString::fromUtf8(hit, static_cast<qsizetype>(hit_size)).size());
+  match.preview =
+      QString::fromUtf8(line_start, static_cast<qsizetype>(preview));
+  if (match.preview.endsWith('\r')) {
+    match.preview.chop(1);
+  }
+  return match;
+}
+
+/*
+ * 子串搜索一个窗口（大小写敏感）：
+ * - Boyer-Moore-Horspool 直接在映射内存上查找，不解码；
+ * - 行号在相邻两次命中之间用 memchr 递增，返回窗口结束时的行号。
+ */
+uint64_t SearchLiteral(const char *data, size_t size, uint64_t line,
+                       const Searcher &searcher, size_t needle_size,
+                       size_t max_matches,
+                       ScrollbackStore::SearchResult &result) {
+  const char *end = data + size;
+  const char *counted = data;
+  const char *line_start = data;
+  const char *pos = data;
+  while (pos < end) {
+    const char *hit = std::search(pos, end, searcher);
+    if (hit == end) {
+      break;
+    }
+    while (const char *newline = static_cast<const char *>(std::memchr(
+               counted, '\n', static_cast<size_t>(hit - counted)))) {
+      ++line;
+      line_start = counted = newline + 1;
+    }
+    counted = hit;
+
+    ++result.total;
+    if (result.matches.size() < max_matches) {
+      result.matches.push_back(
+          MakeMatch(line, line_start, hit, needle_size, end));
+    }
+    pos = hit + needle_size;
+  }
+  return line + static_cast<uint64_t>(std::count(counted, end, '\n'));
+}
+
+/*
+ * 正则（或忽略大小写的子串）搜索一个窗口：
+ * - 窗口整体解码一次，匹配位置按 UTF-16 计算行内列；
+ * - 空匹配跳过。
+ */
+uint64_t SearchRegex(const char *data, size_t size, uint64_t line,
+                     const QRegularExpression &re, size_t max_matches,
+                     ScrollbackStore::SearchResult &result) {
+  const QString text = QString::fromUtf8(data, static_cast<qsizetype>(size));
+  qsizetype counted = 0;
+  qsizetype line_start = 0;
+  QRegularExpressionMatchIterator it = re.globalMatch(text);
+  while (it.hasNext()) {
+    const QRegularExpressionMatch match = it.next();
+    if (match.capturedLength() == 0) {
+      continue;
+    }
+    const qsizetype start = match.capturedStart();
+    qsizetype newline;
+    while ((newline = text.indexOf('\n', counted)) >= 0 && newline < start) {
+      ++line;
+      line_start = counted = newline + 1;
+    }
+    counted = start;
+
+    ++result.total;
+    if (result.matches.size() < max_matches) {
+      qsizetype line_end = text.indexOf('\n', start);
+      if (line_end < 0) {
+        line_end = text.size();
+      }
+      ScrollbackStore::Match entry;
+      entry.line = line;
+      entry.column = static_cast<uint32_t>(start - line_start);
+      entry.length = static_cast<uint32_t>(match.capturedLength());
+      entry.preview = text.mid(
+          line_start, std::min<qsizetype>(line_end - line_start,
+                                          kPreviewBytes));
+      if (entry.preview.endsWith('\r')) {
+        entry.preview.chop(1);
+      }
+      result.matches.push_back(std::move(entry));
+    }
+  }
+  return line +
+         static_cast<uint64_t>(QStringView(text).mid(counted).count(u'\n'));
+}
+
+} // namespace
+
+ScrollbackStore::Segment::~Segment() {
+  if (data != nullptr) {
+    file.unmap(data);
+  }
+  if (!file.fileName().isEmpty()) {
+    file.remove();
+  }
+}
+
+ScrollbackStore::ScrollbackStore(const Options &options) : options_(options) {
+  /* 至少保留四段，单段大小受行索引（uint32 偏移）限制 */
+  options_.segment_bytes = std::clamp(
+      std::min<uint64_t>(options_.segment_bytes, options_.limit_bytes / 4),
+      static_cast<uint64_t>(kMinSegmentBytes),
+      static_cast<uint64_t>(kMaxSegmentBytes));
+}
+
+ScrollbackStore::~ScrollbackStore() { CancelSearch(); }
+
+std::shared_ptr<ScrollbackStore::Segment> ScrollbackStore::CreateSegment() {
+  QDir dir(options_.directory.isEmpty() ? QDir::tempPath()
+                                        : options_.directory);
+  dir.mkpath(".");
+
+  auto segment = std::make_shared<Segment>();
+  segment->file.setFileName(
+      dir.filePath(QString("%1-%2-%3.scroll")
+                       .arg(options_.name)
+                       .arg(QCoreApplication::applicationPid())
+                       .arg(sequence_++)));
+  const qint64 capacity = static_cast<qint64>(options_.segment_bytes);
+  if (!segment->file.open(QIODevice::ReadWrite | QIODevice::Truncate) ||
+      !segment->file.resize(capacity) ||
+      (segment->data = segment->file.map(0, capacity)) == nullptr) {
+    APP_LOG_WARN("Scrollback: failed to map %s: %s",
+                 segment->file.fileName().toUtf8().constData(),
+                 segment->file.errorString().toUtf8().constData());
+    return nullptr;
+  }
+  segment->capacity = options_.segment_bytes;
+  return segment;
+}
+
+/*
+ * 换段：
+ * - 未结束的行移到新段，使每段只包含整行；
+ * - 超过半段的超长行在旧段末尾强制断开；
+ * - 超过保留总量时淘汰最旧的段。
+ */
+bool ScrollbackStore::Roll() {
+  std::shared_ptr<Segment> next = CreateSegment();
+  if (next == nullptr) {
+    failed_ = true;
+    return false;
+  }
+
+  if (!segments_.empty()) {
+    Segment &current = *segments_.back();
+    const size_t complete =
+        current.line_ends.empty() ? 0 : current.line_ends.back();
+    const size_t tail = current.used - complete;
+    if (tail > current.capacity / 2) {
+      current.line_ends.push_back(static_cast<uint32_t>(current.used));
+      current.published.store(current.used, std::memory_order_release);
+    } else {
+      std::memcpy(next->data, current.data + complete, tail);
+      next->used = tail;
+      current.used = complete;
+    }
+    next->first_line = current.first_line + current.line_ends.size();
+  }
+  segments_.push_back(std::move(next));
+
+  while (bytes_ > options_.limit_bytes && segments_.size() > 1) {
+    bytes_ -= segments_.front()->used;
+    segments_.pop_front();
+  }
+  return true;
+}
+
+void ScrollbackStore::Append(const char *data, size_t size) {
+  while (size > 0) {
+    Segment *current = segments_.empty() ? nullptr : segments_.back().get();
+    if (current == nullptr || current->used == current->capacity) {
+      if (failed_ || !Roll()) {
+        return;
+      }
+      continue;
+    }
+
+    const size_t n = std::min(size, current->capacity - current->used);
+    char *base = reinterpret_cast<char *>(current->data);
+    std::memcpy(base + current->used, data, n);
+
+    /* 记录新数据中的换行位置，整行部分对搜索线程可见 */
+    const char *end = base + current->used + n;
+    for (const char *p = base + current->used;
+         (p = static_cast<const char *>(
+              std::memchr(p, '\n', static_cast<size_t>(end - p)))) !=
+         nullptr;) {
+      ++p;
+      current->line_ends.push_back(static_cast<uint32_t>(p - base));
+    }
+    current->used += n;
+    bytes_ += n;
+    if (!current->line_ends.empty()) {
+      current->published.store(current->line_ends.back(),
+                               std::memory_order_release);
+    }
+
+    data += n;
+    size -= n;
+  }
+}
+
+uint64_t ScrollbackStore::FirstLine() const {
+  return segments_.empty() ? 0 : segments_.front()->first_line;
+}
+
+uint64_t ScrollbackStore::EndLine() const {
+  if (segments_.empty()) {
+    return 0;
+  }
+  const Segment &last = *segments_.back();
+  const size_t complete = last.line_ends.empty() ? 0 : last.line_ends.back();
+  return last.first_line + last.line_ends.size() +
+         (last.used > complete ? 1 : 0);
+}
+
+QList<QByteArray> ScrollbackStore::ReadLines(uint64_t first,
+                                              size_t count) const {
+  QList<QByteArray> lines;
+  uint64_t line = std::max(first, FirstLine());
+  const uint64_t end = std::min(first + count, EndLine());
+  if (line >= end) {
+    return lines;
+  }
+  lines.reserve(static_cast<qsizetype>(end - line));
+
+  /* 最后一个起始行号不大于 line 的段 */
+  auto it = std::upper_bound(
+      segments_.begin(), segments_.end(), line,
+      [](uint64_t value, const std::shared_ptr<Segment> &segment) {
+        return value < segment->first_line;
+      });
+  for (--it; it != segments_.end() && line < end; ++it) {
+    const Segment &segment = **it;
+    const char *base = reinterpret_cast<const char *>(segment.data);
+    while (line < end) {
+      const size_t k = static_cast<size_t>(line - segment.first_line);
+      if (k > segment.line_ends.size()) {
+        break;
+      }
+      const size_t from = k == 0 ? 0 : segment.line_ends[k - 1];
+      const size_t to =
+          k < segment.line_ends.size() ? segment.line_ends[k] : segment.used;
+      if (to == from) {
+        break; /* 本段没有未结束的行，转到下一段 */
+      }
+      QByteArray text(base + from, static_cast<qsizetype>(to - from));
+      if (text.endsWith('\n')) {
+        text.chop(1);
+      }
+      if (text.endsWith('\r')) {
+        text.chop(1);
+      }
+      lines.append(std::move(text));
+      ++line;
+    }
+  }
+  return lines;
+}
+
+uint64_t ScrollbackStore::Search(const Query &query,
+                                 SearchCallback callback) {
+  CancelSearch();
+
+  SegmentList snapshot(segments_.begin(), segments_.end());
+  const uint64_t id = ++search_id_;
+  search_thread_ = std::thread(
+      [this, snapshot = std::move(snapshot), query,
+       callback = std::move(callback), id]() {
+        SearchResult result;
+        result.id = id;
+        RunSearch(snapshot, query, cancel_, result);
+        callback(std::move(result));
+      });
+  return id;
+}
+
+void ScrollbackStore::CancelSearch() {
+  if (search_thread_.joinable()) {
+    cancel_.store(true, std::memory_order_relaxed);
+    search_thread_.join();
+  }
+  cancel_.store(false, std::memory_order_relaxed);
+}
+
+/*
+ * 按窗口扫描快照中的各段：
+ * - 窗口约 kWindowBytes，结束在换行处，行不会被窗口截断；
+ * - 大小写敏感的子串走字节搜索，其余情况走正则；
+ * - 每个窗口之间检查取消标志。
+ */
+void ScrollbackStore::RunSearch(const SegmentList &segments,
+                                const Query &query,
+                                const std::atomic<bool> &cancel,
+                                SearchResult &result) {
+  if (query.pattern.isEmpty()) {
+    return;
+  }
+  const bool literal = !query.regex && query.case_sensitive;
+  const QByteArray needle = query.pattern.toUtf8();
+  const Searcher searcher(needle.constData(),
+                          needle.constData() + needle.size());
+
+  QRegularExpression re;
+  if (!literal) {
+    re.setPattern(query.regex ? query.pattern
+                              : QRegularExpression::escape(query.pattern));
+    if (!query.case_sensitive) {
+      re.setPatternOptions(QRegularExpression::CaseInsensitiveOption);
+    }
+    if (!re.isValid()) {
+      result.error = re.errorString();
+      return;
+    }
+    re.optimize();
+  }
+
+  for (const std::shared_ptr<Segment> &segment : segments) {
+    const char *base = reinterpret_cast<const char *>(segment->data);
+    const size_t size = segment->published.load(std::memory_order_acquire);
+    uint64_t line = segment->first_line;
+    size_t begin = 0;
+    while (begin < size) {
+      if (cancel.load(std::memory_order_relaxed)) {
+        result.cancelled = true;
+        return;
+      }
+      size_t stop = std::min(size, begin + kWindowBytes);
+      if (stop < size) {
+        auto last = std::find(std::make_reverse_iterator(base + stop),
+                              std::make_reverse_iterator(base + begin), '\n');
+        if (last.base() != base + begin) {
+          stop = static_cast<size_t>(last.base() - base);
+        }
+      }
+      line = literal ? SearchLiteral(base + begin, stop - begin, line,
+                                     searcher, needle.size(),
+                                     query.max_matches, result)
+                     : SearchRegex(base + begin, stop - begin, line, re,
+                                   query.max_matches, result);
+      result.scanned_bytes += stop - begin;
+      begin = stop;
+    }
+  }
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include <QByteArray>
+#include <QFile>
+#include <QList>
+#include <QString>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/*
+ * ScrollbackStore：终端历史记录（C++ 侧滚动缓冲）
+ * - 显示字节按追加顺序写入内存映射的段文件（默认每段 64 MiB），
+ *   段在目录中以 <名称>-<进程号>-<序号>.scroll 命名，随存储一起删除；
+ * - 每段只保存整行：换段时把未结束的行移到新段，超过半段的超长行
+ *   在段尾强制断开；每段维护行结束位置索引，按行号分页读取为 O(log n)；
+ * - 总量超过 limit_bytes 时淘汰最旧的段，行号保持单调递增；
+ * - 搜索在后台线程进行，只扫描已发布的整行，支持子串与正则、大小写
+ *   可选，新的搜索会取消仍在进行的旧搜索；
+ * - 除搜索线程外只在生产者（GUI）线程使用；搜索开始时复制段列表，
+ *   持有段的共享引用，淘汰不会影响正在进行的搜索。
+ */
+class ScrollbackStore {
+public:
+  struct Options {
+    QString directory; /* 段文件目录，空为系统临时目录 */
+    QString name;      /* 文件名主体，如 "uart1" */
+    size_t segment_bytes = 64 * 1024 * 1024;     /* 单段容量 */
+    uint64_t limit_bytes = 256ull * 1024 * 1024; /* 保留的历史总量 */
+  };
+
+  struct Query {
+    QString pattern;
+    bool regex = false;
+    bool case_sensitive = true;
+    size_t max_matches = 1000; /* 返回的匹配数上限，超出部分只计数 */
+  };
+
+  struct Match {
+    uint64_t line;   /* 绝对行号 */
+    uint32_t column; /* 行内位置（UTF-16 字符） */
+    uint32_t length; /* 匹配长度（UTF-16 字符） */
+    QString preview; /* 所在行内容（截断） */
+  };
+
+  struct SearchResult {
+    uint64_t id = 0;
+    std::vector<Match> matches;
+    uint64_t total = 0; /* 全部匹配数 */
+    uint64_t scanned_bytes = 0;
+    bool cancelled = false;
+    QString error; /* 非法正则等 */
+  };
+
+  using SearchCallback = std::function<void(SearchResult &&)>;
+
+  explicit ScrollbackStore(const Options &options);
+  ~ScrollbackStore();
+
+  ScrollbackStore(const ScrollbackStore &) = delete;
+  ScrollbackStore &operator=(const ScrollbackStore &) = delete;
+
+  /* 追加显示字节（生产者线程），映射失败时丢弃 */
+  void Append(const char *data, size_t size);
+
+  /* 仍保留的最旧行号 */
+  uint64_t FirstLine() const;
+
+  /* 行号上界（不含），未结束的当前行也计入 */
+  uint64_t EndLine() const;
+
+  /* 当前保留的字节数 */
+  uint64_t Bytes() const { return bytes_; }
+
+  /* 读取 [first, first + count) 行（不含换行符），超出范围的部分忽略 */
+  QList<QByteArray> ReadLines(uint64_t first, size_t count) const;
+
+  /*
+   * 在后台线程搜索已保存的整行：
+   * - 返回本次搜索的 id，结束或被取消时在搜索线程调用 callback；
+   */
+  uint64_t Search(const Query &query, SearchCallback callback);
+
+  /* 取消并等待仍在进行的搜索 */
+  void CancelSearch();
+
+private:
+  struct Segment {
+    QFile file;
+    uchar *data = nullptr;
+    size_t capacity = 0;
+    uint64_t first_line = 0;
+    std::atomic<size_t> published{0}; /* 整行部分的长度，搜索线程可见 */
+
+    /* 以下仅生产者线程访问 */
+    size_t used = 0;
+    std::vector<uint32_t> line_ends; /* 各整行结束位置（含换行符） */
+
+    ~Segment();
+  };
+
+  using SegmentList = std::vector<std::shared_ptr<Segment>>;
+
+  bool Roll();
+  std::shared_ptr<Segment> CreateSegment();
+  static void RunSearch(const SegmentList &segments, const Query &query,
+                        const std::atomic<bool> &cancel,
+                        SearchResult &result);
+
+  Options options_;
+  uint32_t sequence_ = 0;
+  uint64_t bytes_ = 0;
+  bool failed_ = false; /* 段文件创建失败后不再重试 */
+
+  /* 段列表（仅生产者线程访问） */
+  std::deque<std::shared_ptr<Segment>> segments_;
+
+  std::thread search_thread_;
+  std::atomic<bool> cancel_{false};
+  uint64_t search_id_ = 0;
+};
@@ -0,0 +1,221 @@
+#include "SessionCapture.hpp"
+#include "AsyncLogger.hpp"
+#include "QTTimebase.hpp"
+
+#include <QDateTime>
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+
+using namespace SessionCapture;
+
+/*
+ * 录制：文件头在构造时写入，文件本身在第一块写盘时创建；
+ */
+SessionRecorder::SessionRecorder(const QString &directory,
+                                 const QString &name) {
+  CaptureWriter::Options options;
+  options.directory = directory;
+  options.name = name;
+  options.suffix = ".ndcap";
+  options.rotate_bytes = 0; /* 索引记录的是单文件偏移，不能轮转 */
+  options.stop_on_error = true; /* 中间缺块会让后续偏移全部错位 */
+  writer_ = std::make_unique<CaptureWriter>(options);
+
+  FileHeader header{};
+  std::memcpy(header.magic, kFileMagic, sizeof(header.magic));
+  header.version = kVersion;
+  header.start_unix_ms = QDateTime::currentMSecsSinceEpoch();
+  writer_->Append(&header, sizeof(header));
+  offset_ = sizeof(header);
+  last_index_offset_ = offset_;
+
+  start_us_ = LibXR::QTTimebase::NowMicros();
+}
+
+SessionRecorder::~SessionRecorder() { Finish(); }
+
+void SessionRecorder::Record(uint8_t channel, Direction direction,
+                             const void *data, size_t size) {
+  if (finished_ || size == 0) {
+    return;
+  }
+  if (writer_->Failed()) {
+    ++dropped_;
+    return;
+  }
+
+  RecordHeader header{};
+  header.timestamp_us = LibXR::QTTimebase::NowMicros() - start_us_;
+  header.length = static_cast<uint32_t>(size);
+  header.channel = channel;
+  header.direction = static_cast<uint8_t>(direction);
+
+  if (!writer_->Append(&header, sizeof(header), data, size)) {
+    ++dropped_;
+    return;
+  }
+
+  if (index_.empty() || offset_ - last_index_offset_ >= kIndexInterval) {
+    index_.push_back({header.timestamp_us, offset_, records_});
+    last_index_offset_ = offset_;
+  }
+
+  offset_ += sizeof(header) + size;
+  ++records_;
+}
+
+/*
+ * 结束录制：追加索引与尾部；索引写入失败时保留数据区，
+ * 读取端会顺序扫描重建索引；
+ * - 写盘失败过的录制不写索引：索引按追加的字节计算偏移，
+ *   与文件中实际写出的前缀不符；
+ */
+void SessionRecorder::Finish() {
+  if (finished_) {
+    return;
+  }
+  finished_ = true;
+
+  Trailer trailer{};
+  trailer.index_offset = offset_;
+  trailer.index_count = index_.size();
+  std::memcpy(trailer.magic, kIndexMagic, sizeof(trailer.magic));
+
+  const size_t index_bytes = index_.size() * sizeof(IndexEntry);
+  if (writer_->Failed()) {
+    APP_LOG_WARN("Session capture failed, reader will rebuild the index");
+  } else if (!writer_->Append(index_.data(), index_bytes, &trailer,
+                       sizeof(trailer))) {
+    APP_LOG_WARN("Session index dropped, reader will rebuild it");
+  }
+  writer_->Close();
+
+  APP_LOG_INFO("Session capture finished: %llu records, %llu dropped",
+               static_cast<unsigned long long>(records_),
+               static_cast<unsigned long long>(dropped_));
+}
+
+bool SessionReader::Open(const QString &path) {
+  file_.setFileName(path);
+  if (!file_.open(QIODevice::ReadOnly)) {
+    error_ = file_.errorString();
+    return false;
+  }
+
+  size_ = static_cast<uint64_t>(file_.size());
+  if (size_ < sizeof(FileHeader)) {
+    error_ = "file too small";
+    return false;
+  }
+
+  base_ = file_.map(0, file_.size());
+  if (base_ == nullptr) {
+    error_ = file_.errorString();
+    return false;
+  }
+
+  FileHeader header;
+  std::memcpy(&header, base_, sizeof(header));
+  if (std::memcmp(header.magic, kFileMagic, sizeof(header.magic)) != 0 ||
+      header.version != kVersion) {
+    error_ = "not a session capture";
+    return false;
+  }
+
+  if (!LoadIndex()) {
+    RebuildIndex();
+  }
+
+  Rewind();
+  return true;
+}
+
+/* 从尾部读取索引，校验失败返回 false */
+bool SessionReader::LoadIndex() {
+  if (size_ < sizeof(FileHeader) + sizeof(Trailer)) {
+    return false;
+  }
+
+  Trailer trailer;
+  std::memcpy(&trailer, base_ + size_ - sizeof(Trailer), sizeof(trailer));
+  if (std::memcmp(trailer.magic, kIndexMagic, sizeof(trailer.magic)) != 0 ||
+      trailer.index_offset < sizeof(FileHeader) ||
+      trailer.index_offset + trailer.index_count * sizeof(IndexEntry) +
+              sizeof(Trailer) !=
+          size_) {
+    return false;
+  }
+
+  index_.resize(static_cast<size_t>(trailer.index_count));
+  std::memcpy(index_.data(), base_ + trailer.index_offset,
+              index_.size() * sizeof(IndexEntry));
+  data_end_ = trailer.index_offset;
+  return true;
+}
+
+/* 顺序扫描重建索引，截断的末尾记录被忽略 */
+void SessionReader::RebuildIndex() {
+  index_.clear();
+  index_rebuilt_ = true;
+
+  uint64_t offset = sizeof(FileHeader);
+  uint64_t last_index_offset = offset;
+  uint64_t record = 0;
+  RecordHeader header;
+
+  while (ReadHeaderAt(offset, header)) {
+    if (index_.empty() || offset - last_index_offset >= kIndexInterval) {
+      index_.push_back({header.timestamp_us, offset, record});
+      last_index_offset = offset;
+    }
+    offset += sizeof(header) + header.length;
+    ++record;
+  }
+  data_end_ = offset;
+
+  APP_LOG_WARN("Session index missing, rebuilt %zu entries", index_.size());
+}
+
+bool SessionReader::ReadHeaderAt(uint64_t offset,
+                                 RecordHeader &header) const {
+  if (offset + sizeof(RecordHeader) > size_) {
+    return false;
+  }
+  std::memcpy(&header, base_ + offset, sizeof(header));
+  return offset + sizeof(RecordHeader) + header.length <= size_;
+}
+
+bool SessionReader::Next(Record &record) {
+  RecordHeader header;
+  if (position_ >= data_end_ || !ReadHeaderAt(position_, header)) {
+    return false;
+  }
+
+  record.timestamp_us = header.timestamp_us;
+  record.channel = header.channel;
+  record.direction = static_cast<Direction>(header.direction);
+  record.data = base_ + position_ + sizeof(RecordHeader);
+  record.size = header.length;
+
+  position_ += sizeof(RecordHeader) + header.length;
+  return true;
+}
+
+void SessionReader::SeekTime(uint64_t timestamp_us) {
+  /* 找到最后一个时间戳不大于目标的索引块 */
+  auto it = std::upper_bound(index_.begin(), index_.end(), timestamp_us,
+                             [](uint64_t ts, const IndexEntry &entry) {
+                               return ts < entry.timestamp_us;
+                             });
+  position_ =
+      it == index_.begin() ? sizeof(FileHeader) : std::prev(it)->offset;
+
+  /* 块内顺序扫描 */
+  RecordHeader header;
+  while (position_ < data_end_ && ReadHeaderAt(position_, header) &&
+         header.timestamp_us < timestamp_us) {
+    position_ += sizeof(RecordHeader) + header.length;
+  }
+}
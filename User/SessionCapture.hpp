@@ -0,0 +1,152 @@
+#pragma once
+
+#include "CaptureWriter.hpp"
+
+#include <QFile>
+#include <QString>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/*
+ * 会话抓包格式（小端，.ndcap）：
+ *
+ *   FileHeader
+ *   { RecordHeader + payload } * N
+ *   IndexEntry * M               （关闭时写入，可缺失）
+ *   Trailer                      （关闭时写入，可缺失）
+ *
+ * - 每条记录带单调时间戳（自录制开始的微秒数）、通道号与方向；
+ * - 数据区每 64 KiB 记录一个索引项，按时间定位时二分查找索引，
+ *   再在块内顺序扫描；
+ * - 进程异常退出导致索引缺失时，读取端顺序扫描重建索引。
+ */
+namespace SessionCapture {
+
+constexpr char kFileMagic[8] = {'N', 'D', 'C', 'A', 'P', '0', '1', '\0'};
+constexpr char kIndexMagic[8] = {'N', 'D', 'I', 'D', 'X', '0', '1', '\0'};
+constexpr uint32_t kVersion = 1;
+constexpr uint64_t kIndexInterval = 64 * 1024;
+
+/* 通道号：0~0xFD 为终端后端序号 */
+constexpr uint8_t kChannelCommand = 0xFE; /* 直接发送的 Command 帧 */
+constexpr uint8_t kChannelTcpIn = 0xFF;   /* TCP 接收的原始字节流 */
+
+enum class Direction : uint8_t {
+  In = 0, /* 设备 -> 客户端 */
+  Out = 1 /* 客户端 -> 设备 */
+};
+
+#pragma pack(push, 1)
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t reserved;
+  int64_t start_unix_ms; /* 录制开始的墙钟时间，仅供参考 */
+};
+
+struct RecordHeader {
+  uint64_t timestamp_us;
+  uint32_t length;
+  uint8_t channel;
+  uint8_t direction;
+  uint16_t reserved;
+};
+
+struct IndexEntry {
+  uint64_t timestamp_us;
+  uint64_t offset; /* 记录头在文件中的偏移 */
+  uint64_t record; /* 记录序号 */
+};
+
+struct Trailer {
+  uint64_t index_offset;
+  uint64_t index_count;
+  char magic[8];
+};
+#pragma pack(pop)
+
+static_assert(sizeof(FileHeader) == 24, "unexpected FileHeader size");
+static_assert(sizeof(RecordHeader) == 16, "unexpected RecordHeader size");
+static_assert(sizeof(IndexEntry) == 24, "unexpected IndexEntry size");
+static_assert(sizeof(Trailer) == 24, "unexpected Trailer size");
+
+} // namespace SessionCapture
+
+/*
+ * SessionRecorder：会话录制
+ * - Record() 仅限单一线程调用（工作线程），写盘由 CaptureWriter 完成；
+ * - 记录头与负载整体追加，缓冲区满时整条丢弃，保证文件结构完整；
+ * - Finish() 追加索引与尾部并关闭文件。
+ */
+class SessionRecorder {
+public:
+  explicit SessionRecorder(const QString &directory,
+                           const QString &name = "session");
+  ~SessionRecorder();
+
+  void Record(uint8_t channel, SessionCapture::Direction direction,
+              const void *data, size_t size);
+
+  void Finish();
+
+  uint64_t Records() const { return records_; }
+  uint64_t Dropped() const { return dropped_; }
+
+private:
+  std::unique_ptr<CaptureWriter> writer_;
+  uint64_t start_us_ = 0; /* 录制起点（QTTimebase 单调时钟） */
+  uint64_t offset_ = 0;
+  uint64_t last_index_offset_ = 0;
+  uint64_t records_ = 0;
+  uint64_t dropped_ = 0;
+  std::vector<SessionCapture::IndexEntry> index_;
+  bool finished_ = false;
+};
+
+/*
+ * SessionReader：会话回放读取
+ * - 整个文件以只读方式映射，记录负载直接指向映射内存；
+ * - SeekTime() 通过索引二分定位，复杂度 O(log n) + 块内扫描；
+ */
+class SessionReader {
+public:
+  struct Record {
+    uint64_t timestamp_us = 0;
+    uint8_t channel = 0;
+    SessionCapture::Direction direction = SessionCapture::Direction::In;
+    const uint8_t *data = nullptr;
+    uint32_t size = 0;
+  };
+
+  bool Open(const QString &path);
+
+  /* 读取下一条记录，到达末尾返回 false */
+  bool Next(Record &record);
+
+  /* 定位到第一条时间戳不小于 timestamp_us 的记录 */
+  void SeekTime(uint64_t timestamp_us);
+
+  void Rewind() { position_ = sizeof(SessionCapture::FileHeader); }
+
+  uint64_t DataBytes() const { return data_end_; }
+  size_t IndexSize() const { return index_.size(); }
+  bool IndexRebuilt() const { return index_rebuilt_; }
+  const QString &ErrorString() const { return error_; }
+
+private:
+  bool LoadIndex();
+  void RebuildIndex();
+  bool ReadHeaderAt(uint64_t offset, SessionCapture::RecordHeader &header) const;
+
+  QFile file_;
+  const uint8_t *base_ = nullptr;
+  uint64_t size_ = 0;
+  uint64_t data_end_ = 0;
+  uint64_t position_ = 0;
+  std::vector<SessionCapture::IndexEntry> index_;
+  bool index_rebuilt_ = false;
+  QString error_;
+};
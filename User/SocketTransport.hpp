@@ -0,0 +1,132 @@
+#pragma once
+
+#include <QAbstractSocket>
+#include <QString>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/*
+ * 传输模式：
+ * - LATENCY：关闭 Nagle（TCP_NODELAY），每段数据写入后立即 flush，
+ *   交互输入与命令应答的延迟最低；
+ * - THROUGHPUT：保留 Nagle，一次唤醒内所有通道的封包先汇集到
+ *   gather 缓冲区，最后一次 write + flush，减少系统调用与小包数量。
+ */
+enum class TransportMode : uint8_t { LATENCY, THROUGHPUT };
+
+/* 解析模式名称（latency / throughput），非法时返回 false */
+inline bool ParseTransportMode(const QString &text, TransportMode *mode) {
+  const QString name = text.trimmed().toLower();
+  if (name == "latency") {
+    *mode = TransportMode::LATENCY;
+  } else if (name == "throughput") {
+    *mode = TransportMode::THROUGHPUT;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+inline const char *TransportModeName(TransportMode mode) {
+  return mode == TransportMode::THROUGHPUT ? "throughput" : "latency";
+}
+
+struct TransportOptions {
+  TransportMode mode = TransportMode::LATENCY;
+  int send_buffer_bytes = 0;    /* SO_SNDBUF，0 表示系统默认 */
+  int receive_buffer_bytes = 0; /* SO_RCVBUF，0 表示系统默认 */
+};
+
+/*
+ * SocketTransport：已接受连接上的发送策略
+ * - Attach() 时按模式设置 LowDelay 与收发缓冲区大小；
+ * - Write() 在 LATENCY 模式下直接写入并 flush，在 THROUGHPUT 模式下
+ *   拷贝到 gather 缓冲区，满时写出一次；
+ * - Finish() 在一次唤醒结束时调用，写出剩余的 gather 数据并 flush；
+ * - gather 缓冲区由外部（BufferArena）提供，LATENCY 模式可以为空；
+ * - 只在 socket 所属线程中使用。
+ */
+class SocketTransport {
+public:
+  SocketTransport(const TransportOptions &options, uint8_t *gather,
+                  size_t capacity)
+      : options_(options), gather_(gather),
+        capacity_(gather != nullptr ? capacity : 0) {}
+
+  void Attach(QAbstractSocket *socket) {
+    socket_ = socket;
+    used_ = 0;
+    socket_->setSocketOption(
+        QAbstractSocket::LowDelayOption,
+        options_.mode == TransportMode::LATENCY ? 1 : 0);
+    if (options_.send_buffer_bytes > 0) {
+      socket_->setSocketOption(QAbstractSocket::SendBufferSizeSocketOption,
+                               options_.send_buffer_bytes);
+    }
+    if (options_.receive_buffer_bytes > 0) {
+      socket_->setSocketOption(
+          QAbstractSocket::ReceiveBufferSizeSocketOption,
+          options_.receive_buffer_bytes);
+    }
+  }
+
+  void Detach() {
+    socket_ = nullptr;
+    used_ = 0;
+  }
+
+  /* 写入一段数据（可以是半个封包，TCP 是字节流） */
+  void Write(const uint8_t *data, size_t size) {
+    if (capacity_ == 0 || options_.mode == TransportMode::LATENCY) {
+      socket_->write(reinterpret_cast<const char *>(data),
+                     static_cast<qint64>(size));
+      socket_->flush();
+      ++writes_;
+      return;
+    }
+    while (size > 0) {
+      if (used_ == capacity_) {
+        WriteGather();
+      }
+      const size_t n = std::min(size, capacity_ - used_);
+      std::memcpy(gather_ + used_, data, n);
+      used_ += n;
+      data += n;
+      size -= n;
+    }
+  }
+
+  /* 一次唤醒结束：写出 gather 中的数据并 flush */
+  void Finish() {
+    if (used_ > 0) {
+      WriteGather();
+      socket_->flush();
+    }
+  }
+
+  /* 已汇集但尚未交给 socket 的字节数 */
+  size_t Pending() const { return used_; }
+
+  /* 累计 write() 次数（用于比较两种模式） */
+  uint64_t Writes() const { return writes_; }
+
+  TransportMode Mode() const { return options_.mode; }
+
+private:
+  void WriteGather() {
+    socket_->write(reinterpret_cast<const char *>(gather_),
+                   static_cast<qint64>(used_));
+    ++writes_;
+    used_ = 0;
+  }
+
+  TransportOptions options_;
+  QAbstractSocket *socket_ = nullptr;
+  uint8_t *gather_;
+  size_t capacity_;
+  size_t used_ = 0;
+  uint64_t writes_ = 0;
+};
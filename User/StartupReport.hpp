@@ -0,0 +1,60 @@
+#pragma once
+
+#include "AsyncLogger.hpp"
+#include "MemoryUsage.hpp"
+#include "QTTimebase.hpp"
+
+#include <QCoreApplication>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+/*
+ * StartupReport：冷启动耗时与内存报告
+ * - 耗时取自 QTTimebase 单调时钟，起点为进程启动；
+ * - 终端页面在初始视图全部加载完成后调用 viewsReady()，
+ *   输出耗时与进程树常驻内存（含 WebEngine 子进程）；
+ * - 稳定 kSettleMs 后再采样一次内存，Chromium 的后台初始化不计入首帧；
+ * - exit_after 为 true 时在第二次采样后退出，供启动基准脚本使用。
+ */
+class StartupReport : public QObject {
+  Q_OBJECT
+public:
+  StartupReport(const QString &mode, bool exit_after,
+                QObject *parent = nullptr)
+      : QObject(parent), mode_(mode), exit_after_(exit_after) {}
+
+  /* views 为初始加载的终端页面数 */
+  Q_INVOKABLE void viewsReady(int views) {
+    if (reported_) {
+      return;
+    }
+    reported_ = true;
+
+    const int64_t elapsed = LibXR::QTTimebase::NowMillis();
+    APP_LOG_INFO("Startup (%s): %d view(s) ready in %lld ms, process tree "
+                 "rss %.1f MiB",
+                 mode_.toUtf8().constData(), views,
+                 static_cast<long long>(elapsed), TreeRssMiB());
+
+    QTimer::singleShot(kSettleMs, this, [this, views]() {
+      APP_LOG_INFO("Startup (%s): %d view(s), settled process tree rss "
+                   "%.1f MiB",
+                   mode_.toUtf8().constData(), views, TreeRssMiB());
+      if (exit_after_) {
+        QCoreApplication::quit();
+      }
+    });
+  }
+
+private:
+  static double TreeRssMiB() {
+    return ProcessMemory::QueryTreeRss() / (1024.0 * 1024.0);
+  }
+
+  QString mode_;
+  bool exit_after_;
+  bool reported_ = false;
+
+  static constexpr int kSettleMs = 2000;
+};
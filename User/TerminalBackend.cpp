@@ -1,27 +1,30 @@
 #include "TerminalBackend.hpp"
+#include "AsyncLogger.hpp"
+#include "FanoutServer.hpp"
+#include "PtyBridge.hpp"
+#include "QTTimebase.hpp"
 #include "libxr_def.hpp"
 #include "libxr_rw.hpp"
 #include "libxr_type.hpp"
 #include "lockfree_queue.hpp"
-#include "logger.hpp"
 #include "ramfs.hpp"
 
+#include <QDateTime>
 #include <QDebug>
 #include <QDir>
 #include <QFile>
 #include <QIODevice>
-#include <QQmlApplicationEngine>
-#include <QQmlContext>
 #include <QTextStream>
 #include <QVariant>
 #include <QVariantMap>
+#include <algorithm>
 #include <string>
 
 using namespace LibXR;
 
 /*
  * 写回调函数：
- * - 将 WritePort 中的数据转为 UTF-8 字符串并发出 receiveText 信号；
+ * - 将 WritePort 中的数据追加到输出合并器；
  * - 用于终端界面输出；
  */
 static ErrorCode Write(WritePort &port) {
@@ -32,115 +35,304 @@ static ErrorCode Write(WritePort &port) {
   while (port.Size() > 0) {
     port.queue_info_->Pop(info);
     port.queue_data_->PopBatch(buffer, info.data.size_);
-    emit self->receiveText(
-        QString::fromUtf8(reinterpret_cast<char *>(buffer), info.data.size_));
+    self->output_->append(reinterpret_cast<char *>(buffer),
+                          static_cast<qsizetype>(info.data.size_));
     port.Finish(false, ErrorCode::OK, info, 0);
   }
 
   return ErrorCode::OK;
 }
 
-/*
- * 读回调函数（当前未使用）；
- */
-static ErrorCode Read(ReadPort &port) {
-  TerminalBackend *self = CONTAINER_OF(&port, TerminalBackend, read_);
-  return ErrorCode::FAILED;
-}
-
 /*
  * 构造函数：
- * - 绑定读写函数；
+ * - 绑定写函数；
  * - 从配置文件加载串口参数；
- * - 注册 Topic 回调处理；
- * - 将自身注入 QML 上下文中；
- */
-TerminalBackend::TerminalBackend(const char *name, uint8_t index,
-                                 QQmlApplicationEngine *parent)
-    : QObject(parent), name_(name), index_(index), read_(0x100000),
-      write_(0x100000), topic_(name, 0x100000), output_file_dir_("./output"),
-      output_file_(output_file_dir_ + "/" + output_file_tag_ + QString(name) +
-                   ".output") {
-  read_ = Read;
+ * - 在所属会话的 Topic 域中创建 Topic 并注册回调处理；
+ */
+TerminalBackend::TerminalBackend(const ChannelSpec &spec, uint8_t index,
+                                 int session, const BufferConfig &buffers,
+                                 BufferArena &arena,
+                                 LibXR::Topic::Domain *domain,
+                                 uint32_t command_key, QObject *parent)
+    : QObject(parent), name_(spec.name), title_(spec.title), index_(index),
+      tunnel_(spec.tunnel), overflow_(spec.overflow),
+      label_(session == 0 ? spec.name
+                          : "s" + QByteArray::number(session) + "_" +
+                                spec.name),
+      command_key_(command_key),
+      outbound_(arena.AllocateArray<uint8_t>(buffers.port_queue_bytes,
+                                             "terminal.outbound"),
+                buffers.port_queue_bytes),
+      write_(buffers.write_queue_depth, buffers.port_queue_bytes),
+      topic_(name_.constData(), buffers.topic_max_bytes, domain),
+      encoder_(topic_.GetKey(), tunnel_, buffers.max_payload_bytes,
+               arena.AllocateArray<uint8_t>(
+                   TopicEncoder::ScratchSize(buffers.max_payload_bytes),
+                   "terminal.pack")),
+      metrics_(session, spec.name), output_(new OutputCoalescer(this)) {
   write_ = Write;
+  output_->setDropCounter(metrics_.display_dropped_bytes);
+
+  /* 暂存上限：阻塞策略允许较大的积压，丢弃最早策略只保留一个队列容量 */
+  switch (overflow_) {
+  case OverflowPolicy::BLOCK:
+    send_pending_limit_ = kMaxPendingSend;
+    break;
+  case OverflowPolicy::DROP_OLDEST:
+    send_pending_limit_ = buffers.port_queue_bytes;
+    break;
+  case OverflowPolicy::DROP_NEWEST:
+    send_pending_limit_ = 0;
+    break;
+  }
 
-  QDir().mkpath(output_file_dir_);
-
-  output_file_.open(QIODevice::WriteOnly | QIODevice::Text);
-
-  output_file_stream_ = new QTextStream(&output_file_);
+  arena.Account("terminal.write_port", buffers.port_queue_bytes);
+  arena.Account("terminal.topic", buffers.topic_max_bytes);
+
+  /* 预分配一个最大 Topic 包对应的转储缓冲区 */
+  hex_buffer_.resize(hex_dump_.MaxOutputSize(buffers.topic_max_bytes));
+
+  /*
+   * 合并后的输出在 GUI 线程发出：
+   * - 历史记录保存原始字节，不含告警高亮标记；
+   * - 原始模式原样发出，由无界面前端写到输出目标；
+   * - 二进制模式直接发送原始字节，由 xterm.js 做流式 UTF-8 解码；
+   * - 文本模式使用有状态解码器，跨包截断的多字节字符不会被破坏；
+   * - 二进制与文本模式下在发出前插入高亮标记；
+   * - 页面尚未连接时暂存视图数据，由 attachView() 交付。
+   */
+  connect(output_, &OutputCoalescer::flushed, this,
+          [this](const QByteArray &data,
+                 const OutputCoalescer::Highlights &highlights) {
+            if (scrollback_) {
+              scrollback_->Append(data.constData(),
+                                  static_cast<size_t>(data.size()));
+            }
+            if (raw_output_.load(std::memory_order_relaxed)) {
+              emit receiveRaw(data);
+              return;
+            }
+            const QByteArray &view =
+                highlights.empty() ? data : markHighlights(data, highlights);
+            if (!view_attached_) {
+              holdForView(view);
+              return;
+            }
+            if (binary_output_.load(std::memory_order_relaxed)) {
+              emit receiveData(QString::fromLatin1(view.toBase64()));
+            } else {
+              emit receiveText(utf8_decoder_(view));
+            }
+          });
 
   loadConfigFromFile();
 
   void (*from_tcp_cb_fun)(bool, TerminalBackend *, RawData &) =
       [](bool, TerminalBackend *self, RawData &data) {
-        XR_LOG_DEBUG("%s received data: %d", self->name_, data.size_);
+        APP_LOG_DEBUG("%s received data: %zu", self->label_.constData(),
+                      data.size_);
+        self->metrics_.rx_bytes->Add(data.size_);
+        self->metrics_.rx_packets->Add();
+        self->metrics_.frame_bytes->Add(data.size_ +
+                                        LibXR::Topic::PACK_BASE_SIZE);
+
+        /* 本地 PTY 收到原始字节，不受十六进制显示影响 */
+        if (self->pty_ != nullptr) {
+          self->pty_->Write(data.addr_, data.size_);
+        }
+        if (self->fanout_ != nullptr) {
+          self->fanout_->Publish(data.addr_, data.size_);
+        }
 
-        if (self->save_to_file_) {
-          *self->output_file_stream_
-              << QByteArray(reinterpret_cast<char *>(data.addr_), data.size_);
-          self->output_file_stream_->flush();
+        if (self->save_to_file_.load(std::memory_order_relaxed)) {
+          CaptureWriter *capture =
+              self->capture_.load(std::memory_order_acquire);
+          if (capture != nullptr) {
+            capture->Append(data.addr_, data.size_);
+          }
         }
 
-        if (self->hex_output_) {
-          QString hexStr;
-          for (size_t i = 0; i < data.size_; ++i) {
-            self->count_++;
-            hexStr += QString::asprintf(
-                "%02X ", reinterpret_cast<uint8_t *>(data.addr_)[i]);
-            if ((self->count_) % 16 == 0)
-              hexStr += "\r\n";
+        const size_t alerts =
+            self->alerts_ ? self->scanAlerts(data.addr_, data.size_) : 0;
+
+        if (self->hex_output_.load(std::memory_order_relaxed)) {
+          if (self->hex_layout_dirty_.exchange(false,
+                                               std::memory_order_acquire)) {
+            HexDumpFormatter::Options options;
+            {
+              QMutexLocker locker(&self->hex_layout_mutex_);
+              options = self->hex_layout_;
+            }
+            /* 当前行未结束时先按旧布局补齐该行 */
+            self->hex_buffer_.resize(std::max(
+                self->hex_buffer_.size(), self->hex_dump_.MaxOutputSize(0)));
+            size_t len =
+                self->hex_dump_.SetOptions(options, self->hex_buffer_.data());
+            self->output_->append(self->hex_buffer_.data(),
+                                  static_cast<qsizetype>(len));
+          }
+
+          size_t need = self->hex_dump_.MaxOutputSize(data.size_);
+          if (self->hex_buffer_.size() < need) {
+            self->hex_buffer_.resize(need);
           }
-          emit self->receiveText(hexStr);
+          size_t len = self->hex_dump_.Format(
+              reinterpret_cast<const uint8_t *>(data.addr_), data.size_,
+              self->hex_buffer_.data());
+          self->output_->append(self->hex_buffer_.data(),
+                                static_cast<qsizetype>(len));
+        } else if (alerts > 0) {
+          self->appendHighlighted(reinterpret_cast<char *>(data.addr_),
+                                  data.size_);
         } else {
-          emit self->receiveText(QString::fromUtf8(
-              reinterpret_cast<char *>(data.addr_), data.size_));
+          self->output_->append(reinterpret_cast<char *>(data.addr_),
+                                static_cast<qsizetype>(data.size_));
         }
+        self->metrics_.display_queue->Set(self->output_->pendingBytes());
       };
 
   auto callback = Topic::Callback::Create(from_tcp_cb_fun, this);
   topic_.RegisterCallback(callback);
+}
 
-  parent->rootContext()->setContextProperty(
-      (std::string("backend") + std::to_string(index_) + "Obj").c_str(), this);
+/*
+ * 析构：停止抓包写线程并写出残留数据，结束历史搜索并删除段文件；
+ */
+TerminalBackend::~TerminalBackend() {
+  delete capture_.exchange(nullptr);
+  scrollback_.reset();
 }
 
 /*
  * 向串口发送文本指令；
- * - 将指令打包为 Topic 格式数据并写入 ReadPort；
+ * - UTF-8 编码追加到待发送缓冲区，再尽量封包入队；
+ * - 阻塞策略下积压超过上限时拒绝本次输入并提示，不静默丢弃；
+ * - 丢弃策略下由 drainPendingSend() 在入队后裁剪积压；
  */
 void TerminalBackend::sendText(const QString &command) {
-  constexpr size_t MAX_PAYLOAD_SIZE = 512;
-
-  QByteArray bytes = command.toUtf8();
-  XR_LOG_DEBUG("Send command: %s", bytes.constData());
-
-  size_t total_size = static_cast<size_t>(bytes.size());
-  char *data_ptr = bytes.data();
+  if (command.isEmpty()) {
+    return;
+  }
 
-  size_t offset = 0;
-  while (offset < total_size) {
-    size_t chunk_size = std::min(MAX_PAYLOAD_SIZE, total_size - offset);
+  const size_t pending = send_pending_.size() - send_pending_offset_;
+  const size_t need = static_cast<size_t>(
+      utf8_encoder_.requiredSpace(command.size()));
+  if (overflow_ == OverflowPolicy::BLOCK &&
+      pending + need > send_pending_limit_) {
+    outbound_.AddDropped(need);
+    metrics_.dropped_bytes->Add(need);
+    APP_LOG_WARN("%s send backlog full, dropped %d characters",
+                 label_.constData(), static_cast<int>(command.size()));
+    output_->append(
+        QByteArrayLiteral("\r\n[send backlog full, input dropped]\r\n"));
+    return;
+  }
 
-    // 第一级打包：原始数据 -> pack_buffer_[0]
-    LibXR::Topic::PackData(topic_.GetKey(), pack_buffer_[0],
-                           {data_ptr + offset, chunk_size});
+  /* 已全部入队时从头复用缓冲区，已入队部分过半时前移剩余数据 */
+  if (pending == 0) {
+    send_pending_.clear();
+    send_pending_offset_ = 0;
+  } else if (send_pending_offset_ > send_pending_.size() / 2) {
+    send_pending_.erase(send_pending_.begin(),
+                        send_pending_.begin() + send_pending_offset_);
+    send_pending_offset_ = 0;
+  }
+  const size_t used = send_pending_.size();
+  send_pending_.resize(used + need);
+  char *end =
+      utf8_encoder_.appendToBuffer(send_pending_.data() + used, command);
+  send_pending_.resize(static_cast<size_t>(end - send_pending_.data()));
+
+  metrics_.send_bytes->Add(send_pending_.size() - used);
+  APP_LOG_DEBUG("Send command: %zu bytes", send_pending_.size() - used);
+  drainPendingSend();
+}
 
-    if (index_ == 0) {
-      // 第二级打包（仅在 index_ == 0 时启用）：嵌套封装
-      LibXR::Topic::PackData(
-          topic_.GetKey(), pack_buffer_[1],
-          {pack_buffer_[0], chunk_size + LibXR::Topic::PACK_BASE_SIZE});
+/*
+ * 按最大负载分包，直接在发送队列的预留空间中封包；
+ * - 透传通道（如 MiniPC）为两层嵌套封包；
+ * - 队列放不下的分包留待会话消费后继续（socket 写缓冲达到上限时
+ *   会话暂停消费，积压由此一路传回到这里）；
+ * - 剩余积压超过策略上限时丢弃：DROP_OLDEST 丢最早的字节，
+ *   DROP_NEWEST 丢全部剩余字节；
+ */
+void TerminalBackend::drainPendingSend() {
+  const char *data = send_pending_.data();
+  const size_t total_size = send_pending_.size();
+  const size_t begin = send_pending_offset_;
+  const bool was_blocked = hasPendingSend();
+
+  {
+    auto lock = outbound_.LockProducer();
+    while (send_pending_offset_ < total_size) {
+      const size_t chunk_size =
+          std::min(encoder_.MaxPayload(), total_size - send_pending_offset_);
+      uint8_t *frame = outbound_.Reserve(encoder_.FrameSize(chunk_size));
+      if (frame == nullptr) {
+        break;
+      }
+      outbound_.Commit(
+          encoder_.Encode(data + send_pending_offset_, chunk_size, frame));
+      send_pending_offset_ += chunk_size;
+    }
+  }
+  const size_t queued = send_pending_offset_ - begin;
 
-      read_.queue_data_->PushBatch(
-          pack_buffer_[1], chunk_size + LibXR::Topic::PACK_BASE_SIZE * 2);
+  const size_t backlog = total_size - send_pending_offset_;
+  if (backlog > send_pending_limit_) {
+    const size_t dropped = backlog - send_pending_limit_;
+    if (overflow_ == OverflowPolicy::DROP_OLDEST) {
+      send_pending_offset_ += dropped;
     } else {
-      // 直接使用一级封包
-      read_.queue_data_->PushBatch(pack_buffer_[0],
-                                   chunk_size + LibXR::Topic::PACK_BASE_SIZE);
+      send_pending_.resize(total_size - dropped);
     }
+    outbound_.AddDropped(dropped);
+    metrics_.dropped_bytes->Add(dropped);
+    APP_LOG_WARN("%s send queue full, dropped %zu bytes (%s)",
+                 label_.constData(), dropped, OverflowPolicyName(overflow_));
+  }
+
+  const bool blocked = send_pending_offset_ < send_pending_.size();
+  send_pending_flag_.store(blocked, std::memory_order_release);
+  if (blocked != was_blocked) {
+    emit sendBlockedChanged();
+  }
+
+  if (queued > 0) {
+    metrics_.send_queue->Set(outbound_.Size());
+    emit dataQueued();
+  }
+}
+
+/*
+ * 连接断开后清空发送队列（分片线程）；
+ */
+void TerminalBackend::discardQueued() {
+  const size_t dropped = outbound_.Discard();
+  metrics_.send_queue->Set(0);
+  if (dropped > 0) {
+    metrics_.dropped_bytes->Add(dropped);
+    APP_LOG_INFO("%s: discarded %zu queued bytes after disconnect",
+                 label_.constData(), dropped);
+  }
+  QMetaObject::invokeMethod(this, &TerminalBackend::discardPendingSend,
+                            Qt::QueuedConnection);
+}
 
-    offset += chunk_size;
+/*
+ * 清空暂存的待发送文本（GUI 线程）；
+ */
+void TerminalBackend::discardPendingSend() {
+  const size_t dropped = send_pending_.size() - send_pending_offset_;
+  send_pending_.clear();
+  send_pending_offset_ = 0;
+  if (dropped > 0) {
+    metrics_.dropped_bytes->Add(dropped);
+    APP_LOG_INFO("%s: discarded %zu pending bytes after disconnect",
+                 label_.constData(), dropped);
+  }
+  if (send_pending_flag_.exchange(false, std::memory_order_acq_rel)) {
+    emit sendBlockedChanged();
   }
 }
 
@@ -148,8 +340,8 @@ void TerminalBackend::sendText(const QString &command) {
  * QML 调用：设置波特率并保存配置；
  */
 Q_INVOKABLE void TerminalBackend::setBaudrate(const QString &baud) {
-  if (config_.baudrate != baud.toUInt() && index_ != 0) {
-    XR_LOG_INFO("Baudrate set to %s", baud.toStdString().c_str());
+  if (config_.baudrate != baud.toUInt() && !tunnel_) {
+    APP_LOG_INFO("Baudrate set to %s", baud.toStdString().c_str());
     config_.baudrate = baud.toUInt();
     saveConfigToFile();
   }
@@ -160,8 +352,8 @@ Q_INVOKABLE void TerminalBackend::setBaudrate(const QString &baud) {
  */
 Q_INVOKABLE void TerminalBackend::setParity(const QString &parity) {
   if (config_.parity != static_cast<UART::Parity>(parity.toUInt()) &&
-      index_ != 0) {
-    XR_LOG_INFO("Parity set to %s", parity.toStdString().c_str());
+      !tunnel_) {
+    APP_LOG_INFO("Parity set to %s", parity.toStdString().c_str());
     if (parity == "None")
       config_.parity = UART::Parity::NO_PARITY;
     else if (parity == "Even")
@@ -176,8 +368,8 @@ Q_INVOKABLE void TerminalBackend::setParity(const QString &parity) {
  * QML 调用：设置停止位并保存配置；
  */
 Q_INVOKABLE void TerminalBackend::setStopBits(const QString &stopBits) {
-  if (config_.stop_bits != stopBits.toUInt() && index_ != 0) {
-    XR_LOG_INFO("Stop bits set to %s", stopBits.toStdString().c_str());
+  if (config_.stop_bits != stopBits.toUInt() && !tunnel_) {
+    APP_LOG_INFO("Stop bits set to %s", stopBits.toStdString().c_str());
     config_.stop_bits = stopBits.toUInt();
     saveConfigToFile();
   }
@@ -187,8 +379,8 @@ Q_INVOKABLE void TerminalBackend::setStopBits(const QString &stopBits) {
  * QML 调用：设置数据位并保存配置；
  */
 Q_INVOKABLE void TerminalBackend::setDataBits(const QString &dataBits) {
-  if (config_.data_bits != dataBits.toUInt() && index_ != 0) {
-    XR_LOG_INFO("Data bits set to %s", dataBits.toStdString().c_str());
+  if (config_.data_bits != dataBits.toUInt() && !tunnel_) {
+    APP_LOG_INFO("Data bits set to %s", dataBits.toStdString().c_str());
     config_.data_bits = dataBits.toUInt();
     saveConfigToFile();
   }
@@ -198,20 +390,363 @@ Q_INVOKABLE void TerminalBackend::setDataBits(const QString &dataBits) {
  * QML 调用：设置十六进制输出并保存配置;
  */
 void TerminalBackend::setHexOutput(bool enabled) {
-  if (hex_output_ != enabled) {
-    hex_output_ = enabled;
-    XR_LOG_INFO("Hex Output set to %s", enabled ? "true" : "false");
-    emit receiveText("\r\nHex Ouput Mode\r\n");
+  if (hex_output_.load(std::memory_order_relaxed) != enabled) {
+    hex_output_.store(enabled, std::memory_order_relaxed);
+    APP_LOG_INFO("Hex Output set to %s", enabled ? "true" : "false");
+    output_->append(QByteArrayLiteral("\r\nHex Ouput Mode\r\n"));
+  }
+}
+
+/*
+ * QML 调用：设置十六进制转储布局（每行列数、偏移量、ASCII 栏）;
+ * - 只记录新布局，由 Topic 回调在处理下一包前应用，
+ *   避免与回调线程同时修改格式化器状态；
+ */
+void TerminalBackend::setHexLayout(int columns, bool showOffset,
+                                   bool showAscii) {
+  {
+    QMutexLocker locker(&hex_layout_mutex_);
+    hex_layout_.columns = static_cast<unsigned>(qBound(1, columns, 255));
+    hex_layout_.show_offset = showOffset;
+    hex_layout_.show_ascii = showAscii;
   }
+  hex_layout_dirty_.store(true, std::memory_order_release);
+  APP_LOG_INFO("%s hex layout: columns=%d offset=%d ascii=%d",
+               label_.constData(), columns, showOffset, showAscii);
 }
 
 /*
  * QML 调用：设置保存到文件并保存配置;
  */
 void TerminalBackend::setSaveToFile(bool enabled) {
-  if (save_to_file_ != enabled) {
-    save_to_file_ = enabled;
-    XR_LOG_INFO("Save to File set to %s", enabled ? "true" : "false");
+  if (save_to_file_.load(std::memory_order_relaxed) != enabled) {
+    if (enabled && capture_.load(std::memory_order_acquire) == nullptr) {
+      CaptureWriter::Options options = capture_options_;
+      options.name = QString::fromLatin1(label_);
+      capture_.store(new CaptureWriter(options), std::memory_order_release);
+    }
+    save_to_file_.store(enabled, std::memory_order_relaxed);
+
+    /* 关闭时结束当前文件，下次开启写入新文件 */
+    CaptureWriter *capture = capture_.load(std::memory_order_acquire);
+    if (!enabled && capture != nullptr) {
+      capture->Close();
+    }
+    APP_LOG_INFO("Save to File set to %s", enabled ? "true" : "false");
+  }
+}
+
+/*
+ * 页面调用：切换二进制输出模式；
+ * - 切换前先发出已合并的数据，保证顺序；
+ * - 文本解码器中残留的半个字符在切换时丢弃；
+ */
+void TerminalBackend::setBinaryOutput(bool enabled) {
+  if (binary_output_.load(std::memory_order_relaxed) != enabled) {
+    output_->flush();
+    binary_output_.store(enabled, std::memory_order_relaxed);
+    utf8_decoder_.resetState();
+    APP_LOG_INFO("%s binary output set to %s", label_.constData(),
+                 enabled ? "true" : "false");
+  }
+}
+
+/*
+ * 无界面前端调用：切换原始输出模式；
+ * - 切换前先发出已合并的数据，保证顺序；
+ */
+void TerminalBackend::setRawOutput(bool enabled) {
+  if (raw_output_.load(std::memory_order_relaxed) != enabled) {
+    output_->flush();
+    raw_output_.store(enabled, std::memory_order_relaxed);
+    utf8_decoder_.resetState();
+  }
+}
+
+/*
+ * 界面前端调用：启用历史记录；
+ * - 只在 GUI 线程调用，之后每次合并输出都追加到存储；
+ */
+void TerminalBackend::enableScrollback(
+    const ScrollbackStore::Options &options) {
+  if (!scrollback_) {
+    scrollback_ = std::make_unique<ScrollbackStore>(options);
+  }
+}
+
+/*
+ * 会话启动前设置抓包写盘参数；
+ */
+void TerminalBackend::setCaptureOptions(
+    const CaptureWriter::Options &options) {
+  capture_options_ = options;
+}
+
+/*
+ * 会话启动前设置告警模式；
+ * - 每个通道持有自己的扫描状态，编译结果在通道与会话间共享；
+ */
+void TerminalBackend::setAlertPatterns(
+    std::shared_ptr<const PatternSet> patterns) {
+  if (patterns && !patterns->empty()) {
+    alerts_ = std::make_unique<PatternScanner>(std::move(patterns));
+  } else {
+    alerts_.reset();
+  }
+}
+
+/*
+ * Topic 回调扫描一个包；
+ * - 没有匹配时只有自动机查表的开销；
+ * - 有匹配时生成事件并安排一次 flushAlerts()，已安排时不重复投递；
+ */
+size_t TerminalBackend::scanAlerts(const void *data, size_t size) {
+  alert_matches_.clear();
+  alert_packet_offset_ = alerts_->Offset();
+  alerts_->Scan(static_cast<const uint8_t *>(data), size, alert_matches_);
+  if (alert_matches_.empty()) {
+    return 0;
+  }
+  metrics_.alerts->Add(alert_matches_.size());
+
+  const qint64 now_us = static_cast<qint64>(LibXR::QTTimebase::NowMicros());
+  const qint64 wall_ms = QDateTime::currentMSecsSinceEpoch();
+  const std::vector<PatternSet::Pattern> &patterns = alerts_->set().patterns();
+  bool schedule = false;
+  {
+    QMutexLocker locker(&alert_mutex_);
+    for (const PatternMatch &match : alert_matches_) {
+      if (alert_pending_.size() >= kMaxPendingAlerts) {
+        ++alert_suppressed_;
+        continue;
+      }
+      QVariantMap event;
+      event["channel"] = title_;
+      event["name"] = QString::fromUtf8(label_);
+      event["pattern"] = patterns[match.pattern].source;
+      event["offset"] = static_cast<qint64>(match.offset);
+      event["length"] = match.length;
+      event["timestamp_us"] = now_us;
+      event["wall_ms"] = wall_ms;
+      alert_pending_.append(event);
+    }
+    schedule = !alert_flush_pending_;
+    alert_flush_pending_ = true;
+  }
+  if (schedule) {
+    QMetaObject::invokeMethod(this, &TerminalBackend::flushAlerts,
+                              Qt::QueuedConnection);
+  }
+  return alert_matches_.size();
+}
+
+/*
+ * 把落在当前包内的命中区间随数据一起追加；
+ * - 跨包的匹配只标记落在当前包内的部分；
+ * - 重叠的匹配合并为一段；
+ */
+void TerminalBackend::appendHighlighted(const char *data, size_t size) {
+  std::sort(alert_matches_.begin(), alert_matches_.end(),
+            [](const PatternMatch &a, const PatternMatch &b) {
+              return a.offset < b.offset;
+            });
+  alert_highlights_.clear();
+  const uint64_t base = alert_packet_offset_;
+  qsizetype cursor = 0;
+  for (const PatternMatch &match : alert_matches_) {
+    if (match.offset + match.length <= base) {
+      continue;
+    }
+    const qsizetype begin = std::max(
+        cursor, static_cast<qsizetype>(std::max(match.offset, base) - base));
+    const qsizetype end = static_cast<qsizetype>(
+        std::min<uint64_t>(match.offset + match.length - base, size));
+    if (end <= begin) {
+      continue;
+    }
+    if (!alert_highlights_.empty() && alert_highlights_.back().end == begin) {
+      alert_highlights_.back().end = end;
+    } else {
+      alert_highlights_.push_back({begin, end});
+    }
+    cursor = end;
+  }
+  output_->append(data, static_cast<qsizetype>(size),
+                  alert_highlights_.data(), alert_highlights_.size());
+}
+
+/*
+ * 页面连接前暂存发往视图的数据；
+ * - 超过两倍上限时才截断，每次截断的拷贝摊到多次追加上；
+ */
+void TerminalBackend::holdForView(const QByteArray &view) {
+  view_backlog_.append(view);
+  if (view_backlog_.size() <= kViewBacklogBytes * 2) {
+    return;
+  }
+  const qsizetype newline =
+      view_backlog_.indexOf('\n', view_backlog_.size() - kViewBacklogBytes);
+  const qsizetype cut = newline >= 0 ? newline + 1 : view_backlog_.size();
+  view_backlog_omitted_ += static_cast<quint64>(cut);
+  view_backlog_.remove(0, cut);
+}
+
+/*
+ * 页面连接后交付暂存的视图数据；
+ * - 先把合并器中的数据并入暂存，再切换为直接发出，保证顺序；
+ * - 页面重新加载时再次调用返回空串；
+ */
+QString TerminalBackend::attachView() {
+  output_->flush();
+  view_attached_ = true;
+
+  QByteArray backlog;
+  if (view_backlog_omitted_ > 0) {
+    backlog = QStringLiteral("[%1 bytes of earlier output omitted]\r\n")
+                  .arg(view_backlog_omitted_)
+                  .toLatin1();
+  }
+  backlog.append(view_backlog_);
+  view_backlog_ = QByteArray();
+  view_backlog_omitted_ = 0;
+
+  if (binary_output_.load(std::memory_order_relaxed)) {
+    return QString::fromLatin1(backlog.toBase64());
+  }
+  return utf8_decoder_(backlog);
+}
+
+/*
+ * 显示路径：把高亮区间包上 SGR 反色（ESC[7m … ESC[27m）；
+ * - 结果写入复用的 highlight_buffer_（GUI 线程）；
+ */
+const QByteArray &
+TerminalBackend::markHighlights(const QByteArray &data,
+                                const OutputCoalescer::Highlights &highlights) {
+  static constexpr char kOn[] = "\x1b[7m";
+  static constexpr char kOff[] = "\x1b[27m";
+
+  highlight_buffer_.resize(0);
+  qsizetype cursor = 0;
+  for (const OutputCoalescer::Highlight &highlight : highlights) {
+    highlight_buffer_.append(data.constData() + cursor,
+                             highlight.begin - cursor);
+    highlight_buffer_.append(kOn, sizeof(kOn) - 1);
+    highlight_buffer_.append(data.constData() + highlight.begin,
+                             highlight.end - highlight.begin);
+    highlight_buffer_.append(kOff, sizeof(kOff) - 1);
+    cursor = highlight.end;
+  }
+  highlight_buffer_.append(data.constData() + cursor, data.size() - cursor);
+  return highlight_buffer_;
+}
+
+/*
+ * GUI 线程发出积累的告警事件；
+ */
+void TerminalBackend::flushAlerts() {
+  QVariantList events;
+  uint64_t suppressed = 0;
+  {
+    QMutexLocker locker(&alert_mutex_);
+    events.swap(alert_pending_);
+    suppressed = alert_suppressed_;
+    alert_suppressed_ = 0;
+    alert_flush_pending_ = false;
+  }
+  if (suppressed > 0) {
+    APP_LOG_WARN("%s: %llu alerts suppressed", label_.constData(),
+                 static_cast<unsigned long long>(suppressed));
+  }
+  if (!events.isEmpty()) {
+    emit alertsRaised(events);
+  }
+}
+
+/*
+ * 页面获取历史记录范围；
+ */
+QVariantMap TerminalBackend::scrollbackInfo() const {
+  QVariantMap info;
+  info["enabled"] = scrollback_ != nullptr;
+  if (scrollback_) {
+    info["firstLine"] = static_cast<qint64>(scrollback_->FirstLine());
+    info["endLine"] = static_cast<qint64>(scrollback_->EndLine());
+    info["bytes"] = static_cast<qint64>(scrollback_->Bytes());
+  }
+  return info;
+}
+
+/*
+ * 页面按需读取历史行（分页显示）；
+ */
+QStringList TerminalBackend::scrollbackLines(double first, int count) const {
+  QStringList lines;
+  if (!scrollback_ || first < 0 || count <= 0) {
+    return lines;
+  }
+  const QList<QByteArray> raw = scrollback_->ReadLines(
+      static_cast<uint64_t>(first), static_cast<size_t>(qMin(count, 1000)));
+  lines.reserve(raw.size());
+  for (const QByteArray &line : raw) {
+    lines.append(QString::fromUtf8(line));
+  }
+  return lines;
+}
+
+/*
+ * 页面发起历史搜索；
+ * - 搜索线程整理结果后投递回 GUI 线程发出信号；
+ * - 被新搜索或取消打断的结果不发出；
+ */
+double TerminalBackend::searchScrollback(const QString &pattern, bool regex,
+                                         bool caseSensitive) {
+  if (!scrollback_) {
+    return 0;
+  }
+  ScrollbackStore::Query query;
+  query.pattern = pattern;
+  query.regex = regex;
+  query.case_sensitive = caseSensitive;
+
+  const uint64_t id = scrollback_->Search(
+      query, [this](ScrollbackStore::SearchResult &&result) {
+        if (result.cancelled) {
+          return;
+        }
+        QVariantList matches;
+        matches.reserve(static_cast<qsizetype>(result.matches.size()));
+        for (const ScrollbackStore::Match &match : result.matches) {
+          QVariantMap entry;
+          entry["line"] = static_cast<qint64>(match.line);
+          entry["column"] = match.column;
+          entry["length"] = match.length;
+          entry["preview"] = match.preview;
+          matches.append(entry);
+        }
+        APP_LOG_DEBUG("%s scrollback search: %llu matches in %llu bytes",
+                      label_.constData(),
+                      static_cast<unsigned long long>(result.total),
+                      static_cast<unsigned long long>(result.scanned_bytes));
+        QMetaObject::invokeMethod(
+            this,
+            [this, id = static_cast<double>(result.id),
+             matches = std::move(matches),
+             total = static_cast<double>(result.total),
+             error = result.error]() {
+              emit scrollbackSearchFinished(id, matches, total, error);
+            },
+            Qt::QueuedConnection);
+      });
+  return static_cast<double>(id);
+}
+
+/*
+ * 页面取消仍在进行的历史搜索；
+ */
+void TerminalBackend::cancelScrollbackSearch() {
+  if (scrollback_) {
+    scrollback_->CancelSearch();
   }
 }
 
@@ -226,31 +761,69 @@ Q_INVOKABLE QVariantMap TerminalBackend::defaultConfig() const {
                                                                     : "Odd";
   configMap["stopBits"] = QString::number(config_.stop_bits);
   configMap["dataBits"] = QString::number(config_.data_bits);
-  configMap["hexOutput"] = hex_output_;
-  configMap["saveToFile"] = save_to_file_;
+  configMap["hexOutput"] = hex_output_.load(std::memory_order_relaxed);
+  {
+    QMutexLocker locker(&hex_layout_mutex_);
+    configMap["hexColumns"] = QString::number(hex_layout_.columns);
+    configMap["hexOffset"] = hex_layout_.show_offset;
+    configMap["hexAscii"] = hex_layout_.show_ascii;
+  }
+  configMap["saveToFile"] = save_to_file_.load(std::memory_order_relaxed);
 
-  XR_LOG_INFO("%d:Load current config: Baudrate = %d, Parity = %d, Stop Bits = "
-              "%d, Data Bits = %d",
-              index_, config_.baudrate, static_cast<int>(config_.parity),
-              config_.stop_bits, config_.data_bits);
+  APP_LOG_INFO("%d:Load current config: Baudrate = %d, Parity = %d, "
+               "Stop Bits = %d, Data Bits = %d",
+               index_, config_.baudrate, static_cast<int>(config_.parity),
+               config_.stop_bits, config_.data_bits);
 
   return configMap;
 }
 
 /*
- * 从配置文件加载串口参数（如 uart_config_0.cfg）；
+ * QML 获取输出合并统计；
+ * - merged 为被合并掉的包数（packets - flushes）；
+ */
+Q_INVOKABLE QVariantMap TerminalBackend::outputStats() const {
+  const quint64 packets = output_->packetsIn();
+  const quint64 flushes = output_->flushes();
+
+  QVariantMap stats;
+  stats["packets"] = packets;
+  stats["flushes"] = flushes;
+  stats["merged"] = packets > flushes ? packets - flushes : 0;
+  stats["bytes"] = output_->bytesIn();
+  stats["dropped"] = output_->droppedBytes();
+  return stats;
+}
+
+/*
+ * 配置文件按通道标签（含会话号）命名，如 uart_config_uart1.cfg、
+ * uart_config_s1_uart1.cfg，各会话槽的设备互不覆盖；
+ */
+QString TerminalBackend::configFileName() const {
+  return QString("uart_config_%1.cfg").arg(QString::fromUtf8(label_));
+}
+
+/*
+ * 从配置文件加载串口参数；
+ * - 会话 0 的文件不存在时读取旧版按串口索引命名的 uart_config_<索引>.cfg；
  */
 void TerminalBackend::loadConfigFromFile() {
-  if (index_ == 0) {
+  if (tunnel_) {
     return;
   }
 
-  QString filename = QString("uart_config_%1.cfg").arg(index_);
+  QString filename = configFileName();
+  if (!QFile::exists(filename) && label_ == name_) {
+    const QString legacy = QString("uart_config_%1.cfg").arg(index_);
+    if (QFile::exists(legacy)) {
+      filename = legacy;
+    }
+  }
   QFile file(filename);
 
   if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-    XR_LOG_WARN("Failed to open %s for reading, using default config.",
-                filename.toStdString().c_str());
+    APP_LOG_WARN("Failed to open %s for reading, using default config.",
+                 filename.toStdString().c_str());
     return;
   }
 
@@ -278,10 +851,10 @@ void TerminalBackend::loadConfigFromFile() {
   if (!dataBitsStr.isEmpty())
     config_.data_bits = dataBitsStr.toUInt();
 
-  XR_LOG_INFO("Loaded configuration: Baudrate = %d, Parity = %d, Stop Bits = "
-              "%d, Data Bits = %d",
-              config_.baudrate, static_cast<int>(config_.parity),
-              config_.stop_bits, config_.data_bits);
+  APP_LOG_INFO("Loaded configuration: Baudrate = %d, Parity = %d, Stop Bits = "
+               "%d, Data Bits = %d",
+               config_.baudrate, static_cast<int>(config_.parity),
+               config_.stop_bits, config_.data_bits);
 
   file.close();
 }
@@ -290,20 +863,20 @@ void TerminalBackend::loadConfigFromFile() {
  * 将当前配置保存到文件，并调用 syncConfig 推送命令；
  */
 void TerminalBackend::saveConfigToFile() {
-  if (index_ == 0) {
+  if (tunnel_) {
     return;
   }
 
-  emit receiveText("\r\nReloading configuration...\r\n");
+  output_->append(QByteArrayLiteral("\r\nReloading configuration...\r\n"));
 
   syncConfig();
 
-  QString filename = QString("uart_config_%1.cfg").arg(index_);
+  const QString filename = configFileName();
   QFile file(filename);
 
   if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
-    XR_LOG_WARN("Failed to open %s for writing.",
-                filename.toStdString().c_str());
+    APP_LOG_WARN("Failed to open %s for writing.",
+                 filename.toStdString().c_str());
     return;
   }
 
@@ -316,34 +889,31 @@ void TerminalBackend::saveConfigToFile() {
   out << config_.stop_bits << "\n";
   out << config_.data_bits << "\n";
 
-  XR_LOG_INFO("Saved configuration: Baudrate = %d, Parity = %d, Stop Bits = "
-              "%d, Data Bits = %d",
-              config_.baudrate, static_cast<int>(config_.parity),
-              config_.stop_bits, config_.data_bits);
+  APP_LOG_INFO("Saved configuration: Baudrate = %d, Parity = %d, Stop Bits = "
+               "%d, Data Bits = %d",
+               config_.baudrate, static_cast<int>(config_.parity),
+               config_.stop_bits, config_.data_bits);
 
   file.close();
 }
 
 /*
- * 将当前 config_ 封装为命令，推送至 ReadPort 供主控模块处理；
+ * 将当前 config_ 封装为命令，经控制通道发给主控模块；
+ * - 不占用发送队列，批量数据积压时配置仍能立即送达；
  */
 void TerminalBackend::syncConfig() {
-  if (index_ == 0) {
+  if (tunnel_) {
     return;
   }
 
-  static uint32_t topic_key = LibXR::Topic::Find("command")->key;
   Command cmd;
   cmd.type = Command::Type::CONFIG_UART;
   cmd.data.uart_config.uart_index = index_;
   cmd.data.uart_config.config = config_;
 
   LibXR::Topic::PackedData<Command> packed_cmd;
-  LibXR::Topic::PackData(topic_key, packed_cmd, cmd);
-
-  if (read_.EmptySize() < sizeof(packed_cmd)) {
-    read_.Reset();
-  }
+  LibXR::Topic::PackData(command_key_, packed_cmd, cmd);
 
-  read_.queue_data_->PushBatch(&packed_cmd, sizeof(packed_cmd));
+  emit commandReady(QByteArray(reinterpret_cast<const char *>(&packed_cmd),
+                               sizeof(packed_cmd)));
 }
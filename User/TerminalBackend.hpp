@@ -1,5 +1,16 @@
 #pragma once
 
+#include "BufferArena.hpp"
+#include "CaptureWriter.hpp"
+#include "ChannelSpec.hpp"
+#include "Command.hpp"
+#include "HexDump.hpp"
+#include "Metrics.hpp"
+#include "OutboundQueue.hpp"
+#include "OutputCoalescer.hpp"
+#include "PatternMatcher.hpp"
+#include "ScrollbackStore.hpp"
+#include "TopicEncoder.hpp"
 #include "libxr.hpp"
 #include "libxr_rw.hpp"
 #include "ramfs.hpp"
@@ -8,39 +19,61 @@
 
 #include <QFile>
 #include <QIODevice>
+#include <QMutex>
 #include <QObject>
-#include <QQmlApplicationEngine>
-#include <QQmlContext>
+#include <QStringDecoder>
+#include <QStringEncoder>
 #include <QStringList>
 #include <QTextStream>
 #include <QVariant>
 #include <QVariantMap>
 
+#include <atomic>
+#include <memory>
+#include <vector>
+
+class FanoutServer;
+class PtyBridge;
+
 /*
- * 命令结构体：
- * 通过 Topic 通道在前后端之间传输控制命令；
- * 包括 Ping、重启、重命名、串口配置等。
+ * ChannelMetrics：单个通道的吞吐与队列指标（名称前缀 s<会话>.<通道>.）
+ * - rx_*：设备经 Topic 送达终端的字节数与包数；
+ * - tx_bytes：从发送队列写入 socket 的字节数；
+ * - send_bytes / dropped_bytes：sendText 与配置命令入队、被拒绝的字节数；
+ * - frame_bytes：会话共享，Topic 回调按负载加封包头累加，
+ *   与会话入站字节数之差即为未能解析的字节；
+ * - send_queue / display_queue：发送队列与输出合并缓冲区深度；
+ * - display_dropped_bytes：输出合并缓冲区达到上限时丢弃的字节数；
+ * - alerts：告警模式的匹配次数。
  */
-class Command {
-public:
-  enum class Type : uint8_t {
-    PING = 0,        /* 前端 Ping 后端，用于状态检测 */
-    REMOTE_PING = 1, /* 后端 Ping 前端，用于状态检测 */
-    REBOOT = 2,      /* 重启 MiniPC */
-    RENAME = 3,      /* 重命名设备 */
-    CONFIG_UART = 4  /* 配置指定串口参数 */
-  };
-
-  Type type;
-
-  union {
-    char device_name[32]; /* 用于 RENAME 命令 */
-
-    struct {
-      uint8_t uart_index;                /* 串口索引 */
-      LibXR::UART::Configuration config; /* 串口配置结构体 */
-    } uart_config;
-  } data;
+struct ChannelMetrics {
+  MetricsRegistry::Counter *rx_bytes;
+  MetricsRegistry::Counter *rx_packets;
+  MetricsRegistry::Counter *tx_bytes;
+  MetricsRegistry::Counter *send_bytes;
+  MetricsRegistry::Counter *dropped_bytes;
+  MetricsRegistry::Counter *frame_bytes;
+  MetricsRegistry::Gauge *send_queue;
+  MetricsRegistry::Gauge *display_queue;
+  MetricsRegistry::Counter *display_dropped_bytes;
+  MetricsRegistry::Counter *alerts;
+
+  ChannelMetrics(int session, const QByteArray &name) {
+    MetricsRegistry &registry = MetricsRegistry::Instance();
+    const std::string session_prefix = "s" + std::to_string(session) + ".";
+    const std::string prefix = session_prefix + name.toStdString() + ".";
+    rx_bytes = registry.AddCounter(prefix + "rx_bytes");
+    rx_packets = registry.AddCounter(prefix + "rx_packets");
+    tx_bytes = registry.AddCounter(prefix + "tx_bytes");
+    send_bytes = registry.AddCounter(prefix + "send_bytes");
+    dropped_bytes = registry.AddCounter(prefix + "dropped_bytes");
+    frame_bytes = registry.AddCounter(session_prefix + "parse.frame_bytes");
+    send_queue = registry.AddGauge(prefix + "send_queue");
+    display_queue = registry.AddGauge(prefix + "display_queue");
+    display_dropped_bytes =
+        registry.AddCounter(prefix + "display_dropped_bytes");
+    alerts = registry.AddCounter(prefix + "alerts");
+  }
 };
 
 /*
@@ -52,24 +85,43 @@ public:
  */
 class TerminalBackend : public QObject {
   Q_OBJECT
+  Q_PROPERTY(bool sendBlocked READ sendBlocked NOTIFY sendBlockedChanged)
 
 public:
   /*
    * 构造函数：
-   * - name 表示终端名称（如 "uart1"）；
-   * - index 表示序号；
-   * - parent 通常为 QQmlApplicationEngine 指针，用于注入上下文。
+   * - spec 给出 Topic 名称、标题与是否为透传通道；
+   * - index 表示通道序号（串口索引），session 表示所属会话槽；
+   * - buffers 给出队列与打包缓冲区容量，发送队列与打包缓冲区从 arena 分配；
+   * - domain 为所属会话的 Topic 域，command_key 为该域中命令 Topic 的 key；
+   * - 注入 QML 上下文由创建者负责（只有界面绑定的会话需要）。
    */
-  explicit TerminalBackend(const char *name, uint8_t index,
-                           QQmlApplicationEngine *parent = nullptr);
+  TerminalBackend(const ChannelSpec &spec, uint8_t index, int session,
+                  const BufferConfig &buffers, BufferArena &arena,
+                  LibXR::Topic::Domain *domain, uint32_t command_key,
+                  QObject *parent = nullptr);
+  ~TerminalBackend() override;
 
 public slots:
   /*
    * 向串口发送文本：
    * - 支持从 QML 调用；
+   * - 发送队列放不下的部分暂存，队列腾出空间后继续入队；
    */
   void sendText(const QString &text);
 
+  /*
+   * 将暂存的待发送文本尽量编码入队（GUI 线程）：
+   * - 由 sendText 与 Worker 消费发送队列后调用；
+   */
+  void drainPendingSend();
+
+  /*
+   * 丢弃暂存的待发送文本（GUI 线程）：
+   * - 由 discardQueued() 在连接断开后投递；
+   */
+  void discardPendingSend();
+
   /*
    * 设置串口配置项（由 QML 控制）：
    * - 分别为波特率、校验位、停止位、数据位；
@@ -79,19 +131,134 @@ public slots:
   Q_INVOKABLE void setStopBits(const QString &stopBits);
   Q_INVOKABLE void setDataBits(const QString &dataBits);
   Q_INVOKABLE void setHexOutput(bool enabled);
+  Q_INVOKABLE void setHexLayout(int columns, bool showOffset, bool showAscii);
   Q_INVOKABLE void setSaveToFile(bool enabled);
+
+  /*
+   * 设置二进制输出模式（由页面在连接后调用）：
+   * - true：通过 receiveData 发送 Base64 编码的原始字节；
+   * - false：通过 receiveText 发送解码后的文本（默认）；
+   */
+  Q_INVOKABLE void setBinaryOutput(bool enabled);
+
+  /*
+   * 设置原始输出模式（无界面前端使用）：
+   * - true：合并后的字节直接通过 receiveRaw 发出，不解码也不编码；
+   * - 优先于文本与二进制模式；
+   */
+  void setRawOutput(bool enabled);
+
+  /*
+   * 启用 C++ 侧历史记录（界面绑定的会话使用）：
+   * - 之后发往视图的字节同时追加到内存映射的段文件；
+   */
+  void enableScrollback(const ScrollbackStore::Options &options);
+
+  /*
+   * 设置告警模式（会话启动前调用，空集合表示关闭）：
+   * - Topic 回调对每个包扫描一次，命中的区间在终端中反色显示
+   *   （十六进制与原始输出模式下只上报不标记），标记只加在发往视图
+   *   的数据上，历史记录与抓包保存原始字节；
+   * - 匹配事件合并后由 alertsRaised 在 GUI 线程发出；
+   */
+  void setAlertPatterns(std::shared_ptr<const PatternSet> patterns);
+
+  /*
+   * 设置 "保存到文件" 的写盘参数（会话启动前调用）：
+   * - fsync 策略与按大小/时间轮转，在第一次开启保存、创建写线程时生效；
+   * - 文件名主体固定为通道标签；
+   */
+  void setCaptureOptions(const CaptureWriter::Options &options);
+
   /*
    * 获取默认串口配置（用于界面初始化）；
    */
   Q_INVOKABLE QVariantMap defaultConfig() const;
 
+  /*
+   * 获取输出合并统计（输入包数、发出次数、合并包数、字节数、丢弃字节数）；
+   */
+  Q_INVOKABLE QVariantMap outputStats() const;
+
+  /*
+   * 历史记录查询（页面调用，未启用时返回空结果）：
+   * - scrollbackInfo：enabled、firstLine、endLine 与 bytes；
+   * - scrollbackLines：按行号读取 [first, first + count) 行；
+   * - searchScrollback：后台搜索，返回本次搜索的 id（未启用时为 0），
+   *   结果由 scrollbackSearchFinished 发出；
+   */
+  Q_INVOKABLE QVariantMap scrollbackInfo() const;
+  Q_INVOKABLE QStringList scrollbackLines(double first, int count) const;
+  Q_INVOKABLE double searchScrollback(const QString &pattern, bool regex,
+                                      bool caseSensitive);
+  Q_INVOKABLE void cancelScrollbackSearch();
+
+  /*
+   * 页面连接 receiveText / receiveData 后调用（GUI 线程）：
+   * - 在此之前发往视图的数据暂存在后端，懒加载的标签页首次打开时
+   *   不会缺少之前的输出；
+   * - 返回暂存内容（二进制模式为 Base64，否则为文本），之后的输出
+   *   直接通过信号发出；
+   */
+  Q_INVOKABLE QString attachView();
+
 signals:
   /*
    * 接收到串口文本数据信号（供 QML 显示）；
    */
   void receiveText(const QString &text);
 
+  /*
+   * 二进制模式下的原始字节输出（Base64 编码，页面侧解码为 Uint8Array）；
+   */
+  void receiveData(const QString &base64);
+
+  /*
+   * 原始模式下的字节输出（写入标准输出、文件或 socket）；
+   */
+  void receiveRaw(const QByteArray &data);
+
+  /*
+   * 历史记录搜索完成：
+   * - matches 为 {line, column, length, preview} 列表，最多 1000 项；
+   * - total 为全部匹配数，error 非空表示正则非法；
+   */
+  void scrollbackSearchFinished(double id, const QVariantList &matches,
+                                double total, const QString &error);
+
+  /*
+   * 告警模式命中（GUI 线程，同一显示帧内的事件合并为一次）：
+   * - 每项为 {channel, name, pattern, offset, length, timestamp_us,
+   *   wall_ms}，offset 为通道字节流中的偏移；
+   * - timestamp_us 为 QTTimebase 单调微秒，与日志、抓包记录同一时基，
+   *   wall_ms 为墙钟毫秒，仅用于界面显示时刻；
+   */
+  void alertsRaised(const QVariantList &events);
+
+  /*
+   * 待发送队列有新数据入队（sendText 之后发出）：
+   * - 会话以 DirectConnection 订阅，用于唤醒转发；
+   */
+  void dataQueued();
+
+  /*
+   * 控制命令帧（CONFIG_UART）：
+   * - 不经过发送队列，由会话直接写入 socket，不会被批量数据挤掉，
+   *   也不受 socket 写缓冲上限限制；
+   */
+  void commandReady(const QByteArray &frame);
+
+  /*
+   * 发送受阻状态变化（有输入因发送队列已满而暂存时为 true）；
+   */
+  void sendBlockedChanged();
+
 public:
+  /*
+   * 当前终端的配置文件名（按通道标签区分会话）；
+   */
+  QString configFileName() const;
+
   /*
    * 从配置文件加载当前终端串口参数；
    */
@@ -107,14 +274,75 @@ public:
    */
   void syncConfig();
 
+  /*
+   * 连接断开时丢弃发给上一台设备的积压（分片线程，发送队列的消费者）：
+   * - 清空发送队列，暂存文本投递到 GUI 线程清空；
+   * - 槽位可能分配给另一台设备，旧的输入不能发给它；
+   */
+  void discardQueued();
+
+  /* 是否有因发送队列已满而暂存的文本（任意线程） */
+  bool hasPendingSend() const {
+    return send_pending_flag_.load(std::memory_order_acquire);
+  }
+
+  bool sendBlocked() const { return hasPendingSend(); }
+
+  /*
+   * 告警扫描（Topic 回调线程）：
+   * - scanAlerts 扫描一个包，匹配留在 alert_matches_ 中，返回匹配数；
+   * - appendHighlighted 把该包连同包内的高亮区间追加到输出合并器；
+   * - markHighlights 在 GUI 线程为发往视图的数据插入反色标记；
+   * - flushAlerts 在 GUI 线程发出积累的事件；
+   */
+  size_t scanAlerts(const void *data, size_t size);
+  void appendHighlighted(const char *data, size_t size);
+  const QByteArray &
+  markHighlights(const QByteArray &data,
+                 const OutputCoalescer::Highlights &highlights);
+  void flushAlerts();
+  void holdForView(const QByteArray &view);
+
 public:
-  const char *name_;       /* 串口终端名称 */
+  QByteArray name_;        /* 串口终端名称（Topic 名称） */
+  QString title_;          /* 标签页标题 */
   uint8_t index_;          /* 串口索引 */
-  LibXR::ReadPort read_;   /* 读取端口 */
+  bool tunnel_;            /* 透传通道：嵌套封包，不下发串口配置 */
+  OverflowPolicy overflow_; /* 发送队列溢出策略 */
+  QByteArray label_;       /* 日志与抓包文件名使用的名称（含会话号） */
+  uint32_t command_key_;   /* 所属会话命令 Topic 的 key */
+  OutboundQueue outbound_; /* 发送队列（发往 TCP 客户端） */
   LibXR::WritePort write_; /* 写入端口 */
   LibXR::Topic topic_;     /* 本终端使用的 Topic 通道 */
+  TopicEncoder encoder_;   /* 直接在发送队列中封包 */
+  ChannelMetrics metrics_; /* 吞吐与队列深度（任意线程，无锁） */
+
+  OutputCoalescer *output_; /* 按显示帧合并 receiveText 输出 */
+  QStringDecoder utf8_decoder_{QStringDecoder::Utf8}; /* 跨块保留未完成字符 */
+
+  /*
+   * 输出模式开关：GUI 线程写入，Topic 回调（分片线程）与 GUI 线程读取，
+   * 只作为独立标志使用，读写均为 relaxed；
+   */
+  std::atomic<bool> binary_output_{false};
+  std::atomic<bool> raw_output_{false};
+  std::atomic<bool> hex_output_{false};
+  std::atomic<bool> save_to_file_{false};
 
-  uint8_t pack_buffer_[2][0x100000]; /* 打包用的临时缓冲区 */
+  std::unique_ptr<ScrollbackStore> scrollback_; /* 未启用时为空 */
+
+  /*
+   * 发送文本（仅 GUI 线程访问）：
+   * - UTF-16 直接编码到复用的 send_pending_，不产生临时 QByteArray；
+   * - send_pending_offset_ 之前的部分已入队（或按策略丢弃）；
+   */
+  QStringEncoder utf8_encoder_{QStringEncoder::Utf8,
+                               QStringEncoder::Flag::Stateless};
+  std::vector<char> send_pending_;
+  size_t send_pending_offset_ = 0;
+  size_t send_pending_limit_; /* 暂存上限，由溢出策略决定 */
+  std::atomic<bool> send_pending_flag_{false};
+  static constexpr size_t kMaxPendingSend = 16 * 1024 * 1024;
 
   /*
    * 串口配置（默认值为 460800 8N1）：
@@ -123,13 +351,53 @@ public:
   LibXR::UART::Configuration config_ = {460800, LibXR::UART::Parity::NO_PARITY,
                                         8, 1};
 
-  bool hex_output_ = false;
-  bool save_to_file_ = false;
-  uint64_t count_ = 0;
+  HexDumpFormatter hex_dump_;   /* 跨包保持行内位置 */
+  std::vector<char> hex_buffer_; /* 转储输出缓冲区（按需扩容后复用） */
+  HexDumpFormatter::Options hex_layout_; /* 待应用的转储布局 */
+  mutable QMutex hex_layout_mutex_;
+  std::atomic<bool> hex_layout_dirty_{false};
 
-  const QString output_file_dir_;
-  const QString output_file_tag_ =
-      QDateTime::currentDateTime().toString("yyyy-MM-dd_HH:mm:ss_");
-  QFile output_file_;
-  QTextStream *output_file_stream_ = NULL;
+  /*
+   * 抓包写盘（save_to_file_）：
+   * - 第一次开启时创建，之后常驻；写线程与文件均为懒创建；
+   * - Topic 回调线程是唯一生产者；
+   */
+  std::atomic<CaptureWriter *> capture_{nullptr};
+  CaptureWriter::Options capture_options_;
+
+  /*
+   * 本地伪终端（--pty 或通道标记 pty）：
+   * - 由会话在分片线程创建，Topic 回调直接写入，未启用时为空；
+   */
+  PtyBridge *pty_ = nullptr;
+
+  /* 本地分发服务（--fanout-port / --fanout-dir），未启用时为空 */
+  FanoutServer *fanout_ = nullptr;
+
+  /*
+   * 告警匹配（--alert）：
+   * - 扫描器只在 Topic 回调线程使用，未启用时为空；
+   * - 待发事件受 alert_mutex_ 保护，每次发出前最多积累
+   *   kMaxPendingAlerts 项，超出部分只计数；
+   */
+  std::unique_ptr<PatternScanner> alerts_;
+  std::vector<PatternMatch> alert_matches_;
+  uint64_t alert_packet_offset_ = 0; /* 当前包在字节流中的起点 */
+  OutputCoalescer::Highlights alert_highlights_; /* 当前包内的高亮区间 */
+  QByteArray highlight_buffer_; /* 加标记后的视图数据（GUI 线程） */
+  QMutex alert_mutex_;
+  QVariantList alert_pending_;
+  uint64_t alert_suppressed_ = 0;
+  bool alert_flush_pending_ = false;
+  static constexpr qsizetype kMaxPendingAlerts = 256;
+
+  /*
+   * 页面连接前的视图输出（GUI 线程）：
+   * - 只保留最近约 kViewBacklogBytes，超出两倍时从换行处截断，
+   *   截掉的字节数在交付时提示；
+   */
+  bool view_attached_ = false;
+  QByteArray view_backlog_;
+  quint64 view_backlog_omitted_ = 0;
+  static constexpr qsizetype kViewBacklogBytes = 256 * 1024;
 };
@@ -0,0 +1,92 @@
+#pragma once
+
+#include "libxr.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+/*
+ * TopicEncoder：单次拷贝的 Topic 封包
+ * - LibXR 的包格式为 包头 + 负载 + CRC8（CRC 覆盖包头与负载）；
+ * - 目标地址一律以 {指针, 长度} 形式传给 PackData（单参数指针会被
+ *   RawData 当作对象本身取址）；
+ * - 内层包直接由 PackData 写入目标内存（例如发送队列的预留空间），
+ *   负载只拷贝一次；
+ * - 嵌套封包（MiniPC 通道）的外层包头只取决于长度，满长分包的外层
+ *   包头预先算好，外层 CRC 在原地计算，不再整包二次拷贝；
+ * - 不足满长的末尾分包借助 scratch 生成外层包头与 CRC，每次发送至多一次。
+ */
+class TopicEncoder {
+public:
+  static constexpr size_t kOverhead = LibXR::Topic::PACK_BASE_SIZE;
+  static constexpr size_t kHeaderSize = kOverhead - 1;
+
+  /* 构造所需 scratch 的字节数 */
+  static constexpr size_t ScratchSize(size_t max_payload) {
+    return (max_payload + kOverhead * 2) * 2;
+  }
+
+  /*
+   * - scratch 至少 ScratchSize(max_payload) 字节；
+   * - nested 为 true 时输出两层封包。
+   */
+  TopicEncoder(uint32_t key, bool nested, size_t max_payload, uint8_t *scratch)
+      : key_(key), nested_(nested), max_payload_(max_payload),
+        scratch_(scratch) {
+    static_assert(kHeaderSize <= sizeof(full_outer_header_),
+                  "topic header larger than expected");
+    if (nested_) {
+      /* 外层包头只与 key 和长度有关，负载内容不影响包头 */
+      const size_t inner = max_payload_ + kOverhead;
+      std::memset(ScratchSource(), 0, inner);
+      LibXR::Topic::PackData(key_, {ScratchTarget(), inner + kOverhead},
+                             {ScratchSource(), inner});
+      std::memcpy(full_outer_header_.data(), ScratchTarget(), kHeaderSize);
+    }
+  }
+
+  size_t MaxPayload() const { return max_payload_; }
+
+  /* 负载为 size 字节时的完整封包长度 */
+  size_t FrameSize(size_t size) const {
+    return size + kOverhead * (nested_ ? 2 : 1);
+  }
+
+  /* 将 size（<= MaxPayload()）字节负载编码到 out，返回写入字节数 */
+  size_t Encode(const void *data, size_t size, uint8_t *out) {
+    if (!nested_) {
+      LibXR::Topic::PackData(key_, {out, size + kOverhead},
+                             {const_cast<void *>(data), size});
+      return size + kOverhead;
+    }
+
+    /* 内层包写在外层包头之后 */
+    const size_t inner = size + kOverhead;
+    LibXR::Topic::PackData(key_, {out + kHeaderSize, inner},
+                           {const_cast<void *>(data), size});
+
+    if (size == max_payload_) {
+      std::memcpy(out, full_outer_header_.data(), kHeaderSize);
+      out[kHeaderSize + inner] =
+          LibXR::CRC8::Calculate(out, kHeaderSize + inner);
+    } else {
+      LibXR::Topic::PackData(key_, {ScratchTarget(), inner + kOverhead},
+                             {out + kHeaderSize, inner});
+      std::memcpy(out, ScratchTarget(), kHeaderSize);
+      out[kHeaderSize + inner] = ScratchTarget()[kHeaderSize + inner];
+    }
+    return inner + kOverhead;
+  }
+
+private:
+  uint8_t *ScratchSource() { return scratch_; }
+  uint8_t *ScratchTarget() { return scratch_ + max_payload_ + kOverhead * 2; }
+
+  uint32_t key_;
+  bool nested_;
+  size_t max_payload_;
+  uint8_t *scratch_;
+  std::array<uint8_t, 32> full_outer_header_{};
+};
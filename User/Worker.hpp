@@ -0,0 +1,510 @@
+#pragma once
+
+#include "AppOptions.hpp"
+#include "AsyncLogger.hpp"
+#include "BufferArena.hpp"
+#include "DeviceManager.hpp"
+#include "DeviceSession.hpp"
+#include "MemoryUsage.hpp"
+#include "MetricsExporter.hpp"
+#include "QTTimebase.hpp"
+#include "TerminalBackend.hpp"
+#include "libxr.hpp"
+
+#include <QHostAddress>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QThread>
+#include <QTimer>
+#include <QUdpSocket>
+
+#include <map>
+#include <string>
+#include <vector>
+
+/*
+ * SessionTcpServer：只取出连接描述符
+ * - socket 在会话所属的解析线程中由描述符创建，
+ *   不在监听线程中构造后再跨线程移动。
+ */
+class SessionTcpServer : public QTcpServer {
+  Q_OBJECT
+public:
+  using QTcpServer::QTcpServer;
+
+signals:
+  void pendingDescriptor(qintptr descriptor);
+
+protected:
+  void incomingConnection(qintptr descriptor) override {
+    emit pendingDescriptor(descriptor);
+  }
+};
+
+class Worker : public QObject {
+  Q_OBJECT
+public:
+  /*
+   * - deviceManager 为界面状态对象（GUI 线程），由前端创建并持有；
+   * - backendParent 为各会话 TerminalBackend 的父对象（GUI 线程），
+   *   界面模式下为 QML 引擎，无界面模式下为前端对象；
+   * - 在 GUI 线程构造，随后移动到工作线程。
+   */
+  Worker(const AppOptions &options, DeviceManager *deviceManager,
+         QObject *backendParent, QObject *parent = nullptr)
+      : QObject(parent), options_(options), deviceManager_(deviceManager) {
+    initSessions(backendParent);
+    initShards();
+    logMemoryReport("startup");
+  }
+
+  /*
+   * 析构（GUI 线程，须先调用 shutdown()）：
+   *  - 各会话已在自己的分片线程上析构；
+   *  - 后端属于 GUI 线程且引用会话 arena 中的队列，在这里、arena 之前释放。
+   */
+  ~Worker() {
+    if (!sessions_.empty()) {
+      /* 工作线程未启动、没有经过 shutdown() 时直接结束分片线程 */
+      for (QThread *shard : shards_) {
+        shard->quit();
+        shard->wait();
+      }
+      qDeleteAll(sessions_);
+    }
+    qDeleteAll(shards_);
+    for (ChannelRegistry *registry : registries_) {
+      qDeleteAll(registry->begin(), registry->end());
+      delete registry;
+    }
+  }
+
+  /*
+   * 有序退出（GUI 线程，工作线程仍在运行时调用）：
+   *  - 断开各后端发出的全部连接，界面与输出目标不再收到数据；
+   *  - 在工作线程上阻塞执行 stop()，释放监听与定时器，
+   *    各会话在自己的分片线程上析构；
+   *  - 最后结束工作线程，之后可在 GUI 线程 delete Worker。
+   */
+  void shutdown() {
+    for (ChannelRegistry *registry : registries_) {
+      for (TerminalBackend *backend : *registry) {
+        QObject::disconnect(backend, nullptr, nullptr, nullptr);
+      }
+    }
+    QMetaObject::invokeMethod(this, &Worker::stop,
+                              Qt::BlockingQueuedConnection);
+    QThread *thread = this->thread();
+    thread->quit();
+    thread->wait();
+  }
+
+  /* 会话槽（GUI 线程只读：槽与通道表在构造后不再增删） */
+  const std::vector<DeviceSession *> &sessions() const { return sessions_; }
+
+public slots:
+  void start() {
+    for (QThread *shard : shards_) {
+      shard->start();
+    }
+
+    /* 回放模式下数据来自抓包文件，不启动 TCP 服务器 */
+    if (options_.replaying()) {
+      initReplay();
+    } else {
+      initTcpServer();
+    }
+    initTimers();
+  }
+
+private:
+  /*
+   * 停止（工作线程，由 shutdown() 阻塞调用）：
+   *  - 监听 socket、UDP、定时器与指标导出器都是本对象的子对象，
+   *    在创建它们的线程上释放；
+   *  - 会话 deleteLater 后结束分片线程，QThread 结束时处理延迟删除，
+   *    socket、PTY 通知器、分发服务与 Topic 域都在分片线程上析构。
+   */
+  void stop() {
+    const QObjectList objects = children();
+    qDeleteAll(objects);
+    tcpServer_ = nullptr;
+    udpSocket_ = nullptr;
+    metricsExporter_ = nullptr;
+    broadcastTimer_ = nullptr;
+    uiStatusTimer_ = nullptr;
+    memoryCheckTimer_ = nullptr;
+    linkStatsTimer_ = nullptr;
+    metricsTimer_ = nullptr;
+
+    for (DeviceSession *session : sessions_) {
+      session->deleteLater();
+    }
+    for (QThread *shard : shards_) {
+      shard->quit();
+      shard->wait();
+    }
+    sessions_.clear();
+  }
+
+  void initSessions(QObject *backendParent) {
+    /*
+     * 预先创建全部会话槽（GUI 线程）：
+     *  - 每个槽有独立的 Topic 域、Topic Server 与通道表；
+     *  - 后端是界面可绑定的 QObject，必须在 GUI 线程创建；
+     *  - 通道表由前端取用：界面注入槽 0 的通道表，
+     *    无界面模式把各通道输出接到标准输出、文件或 socket。
+     */
+    for (int i = 0; i < options_.max_sessions; ++i) {
+      sessions_.push_back(
+          new DeviceSession(i, options_, arena_, backendParent));
+      registries_.push_back(sessions_.back()->channels());
+    }
+
+    APP_LOG_INFO("%zu terminal channels per session",
+                 options_.channels.size());
+  }
+
+  void initShards() {
+    /*
+     * 解析分片线程：
+     *  - 会话按槽号轮流分配到各线程，一个会话的接收、解析与转发
+     *    始终在同一线程；
+     *  - 会话断开后通知 Worker 立即补发广播。
+     */
+    for (int i = 0; i < options_.parse_threads; ++i) {
+      QThread *shard = new QThread();
+      shard->setObjectName(QString("parser%1").arg(i));
+      shards_.push_back(shard);
+    }
+
+    for (DeviceSession *session : sessions_) {
+      QThread *shard = shards_[session->slot() % shards_.size()];
+      session->moveToThread(shard);
+      connect(shard, &QThread::started, session, &DeviceSession::start);
+      connect(session, &DeviceSession::closed, this,
+              &Worker::onSessionClosed);
+    }
+    APP_LOG_INFO("Serving up to %d devices on %d parser threads",
+                 options_.max_sessions, options_.parse_threads);
+  }
+
+  void initReplay() {
+    /* 回放占用槽 0，结果显示在主界面 */
+    if (options_.record) {
+      APP_LOG_INFO("Session recording is ignored while replaying");
+    }
+    DeviceSession *session = sessions_[0];
+    session->tryClaim();
+    QMetaObject::invokeMethod(session, [session, this]() {
+      session->startReplay(options_.replay_file, options_.replay_speed,
+                           options_.replay_from_us);
+    }, Qt::QueuedConnection);
+  }
+
+  void initTcpServer() {
+    /* 启动 TCP 服务器，监听端口 */
+    tcpServer_ = new SessionTcpServer(this);
+    udpSocket_ = new QUdpSocket(this);
+
+    connect(tcpServer_, &SessionTcpServer::pendingDescriptor, this,
+            &Worker::onNewConnection);
+    if (!tcpServer_->listen(QHostAddress::Any, kTcpPort)) {
+      APP_LOG_ERROR("Failed to start TCP server");
+      return;
+    }
+    APP_LOG_DEBUG("TCP Server started on port %d", kTcpPort);
+
+    if (options_.record) {
+      APP_LOG_INFO("Session recording enabled, directory: %s",
+                   options_.record_dir.toLocal8Bit().constData());
+    }
+  }
+
+  void initTimers() {
+    /*
+     * 定时广播设备标识（通过 UDP）：
+     *  - 仍有空闲会话槽时执行；
+     *  - 若设置了设备名过滤器，则广播带过滤名的消息；
+     *  - 否则广播默认消息；
+     *  - 周期为 1000 毫秒。
+     */
+    broadcastTimer_ = new QTimer(this);
+    connect(broadcastTimer_, &QTimer::timeout, this, [this]() {
+      if (hasFreeSession() && !options_.replaying()) {
+        if (deviceManager_->filter_is_set_) {
+          broadcastUdpMessage();
+        } else {
+          APP_LOG_INFO("Device name filter is not set, skipping broadcast");
+        }
+      }
+    });
+    broadcastTimer_->start(1000);
+
+    /*
+     * 定期刷新界面状态（槽 0）：
+     *  - 周期为 100 毫秒；
+     *  - 超时断开由各会话在自己的解析线程中处理；
+     *  - 若状态变化，更新 UI 状态（Backend/MiniPC Online）；
+     *  - 若有重启/重命名请求，则向槽 0 的设备发送命令。
+     */
+    uiStatusTimer_ = new QTimer(this);
+    connect(uiStatusTimer_, &QTimer::timeout, this, [this]() {
+      DeviceSession *session = sessions_[0];
+      const uint64_t now = LibXR::QTTimebase::NowMicros();
+
+      /* 更新本地后端在线状态 */
+      const bool isOnline = session->isOnline(now);
+      if (deviceManager_->isBackendConnected() != isOnline) {
+        deviceManager_->SetBackendConnected(isOnline);
+        APP_LOG_INFO("Backend status changed: %s",
+                     isOnline ? "online" : "offline");
+      }
+
+      /* 更新 MiniPC 在线状态 */
+      const bool isRemoteOnline = session->isRemoteOnline(now);
+      if (deviceManager_->isMiniPCOnline() != isRemoteOnline) {
+        deviceManager_->SetMiniPCOnline(isRemoteOnline);
+        APP_LOG_INFO("MiniPC status changed: %s",
+                     isRemoteOnline ? "online" : "offline");
+      }
+
+      /* 如果 UI 请求设备重启，经透传通道发送 REBOOT 命令 */
+      if (deviceManager_->require_restart_) {
+        deviceManager_->require_restart_ = false;
+        TerminalBackend *tunnel = session->channels()->tunnel();
+        if (tunnel == nullptr) {
+          APP_LOG_WARN("No tunnel channel configured, cannot send REBOOT");
+        } else {
+          LibXR::Topic::PackedData<Command::Type> command;
+          LibXR::Topic::PackData(session->commandKey(), command,
+                                 Command::Type::REBOOT);
+          uint8_t buf[sizeof(command) + LibXR::Topic::PACK_BASE_SIZE];
+          LibXR::Topic::PackData(tunnel->topic_.GetKey(), buf, command);
+          sendCommand(session, buf, sizeof(buf));
+        }
+      }
+
+      /* 如果 UI 请求设备改名，发送 RENAME 命令 */
+      if (deviceManager_->require_rename_) {
+        deviceManager_->require_rename_ = false;
+        LibXR::Topic::PackedData<Command> command_buf;
+        Command cmd;
+        cmd.type = Command::Type::RENAME;
+        strncpy(cmd.data.device_name,
+                deviceManager_->last_device_name_.toUtf8().data(),
+                sizeof(cmd.data.device_name));
+        LibXR::Topic::PackData(session->commandKey(), command_buf, cmd);
+        sendCommand(session, &command_buf, sizeof(command_buf));
+        APP_LOG_INFO("Rename");
+      }
+    });
+    uiStatusTimer_->start(100);
+
+    /* 链路统计（槽 0，每秒一次）：GUI 线程中更新状态栏 */
+    linkStatsTimer_ = new QTimer(this);
+    connect(linkStatsTimer_, &QTimer::timeout, this, [this]() {
+      const LinkStats stats = sessions_[0]->linkStats();
+      auto ms = [](uint64_t us) { return us / 1000.0; };
+      QVariantMap map;
+      map["rttSupported"] = stats.rtt_supported;
+      map["rttP50"] = ms(stats.rtt_p50_us);
+      map["rttP99"] = ms(stats.rtt_p99_us);
+      map["rttMax"] = ms(stats.rtt_max_us);
+      map["jitterP50"] = ms(stats.jitter_p50_us);
+      map["jitterP99"] = ms(stats.jitter_p99_us);
+      map["jitterMax"] = ms(stats.jitter_max_us);
+      map["timeout"] = ms(stats.timeout_us);
+      map["degraded"] = stats.degraded;
+      DeviceManager *manager = deviceManager_;
+      QMetaObject::invokeMethod(
+          manager, [manager, map]() { manager->SetLinkStats(map); },
+          Qt::QueuedConnection);
+    });
+    linkStatsTimer_->start(1000);
+
+    /*
+     * 指标快照（默认每秒一次）：
+     *  - 计数器换算为每秒速率，量表取本周期高水位；
+     *  - 送往诊断面板，并按 --metrics-export 导出到文件或 UDP。
+     */
+    if (!options_.metrics_export.isEmpty()) {
+      metricsExporter_ = new MetricsExporter(options_.metrics_export, this);
+    }
+    metricsTimer_ = new QTimer(this);
+    connect(metricsTimer_, &QTimer::timeout, this, &Worker::publishMetrics);
+    metricsTimer_->start(options_.metrics_interval_ms);
+
+    /* 峰值常驻内存明显增长时重新输出内存报告（每秒检查一次） */
+    memoryCheckTimer_ = new QTimer(this);
+    connect(memoryCheckTimer_, &QTimer::timeout, this, [this]() {
+      const ProcessMemory memory = ProcessMemory::Query();
+      if (memory.peak_rss >= lastReportedPeakRss_ + kMemoryReportStep) {
+        logMemoryReport("under load");
+      }
+    });
+    memoryCheckTimer_->start(1000);
+  }
+
+  void logMemoryReport(const char *when) {
+    /*
+     * 内存报告：
+     *  - 进程常驻内存（当前/峰值）；
+     *  - arena 已分配/已预留字节数，以及 LibXR 内部队列的登记容量；
+     *  - 按标签汇总各类缓冲区。
+     */
+    const ProcessMemory memory = ProcessMemory::Query();
+    lastReportedPeakRss_ = memory.peak_rss;
+
+    APP_LOG_INFO("Memory (%s): rss %.1f MiB, peak %.1f MiB, arena used "
+                 "%zu / reserved %zu bytes, external buffers %zu bytes",
+                 when, memory.rss / (1024.0 * 1024.0),
+                 memory.peak_rss / (1024.0 * 1024.0), arena_.Used(),
+                 arena_.Reserved(), arena_.External());
+
+    std::map<std::string, size_t> totals;
+    for (const BufferArena::Usage &usage : arena_.Usages()) {
+      totals[usage.tag] += usage.bytes;
+    }
+    for (const auto &[tag, bytes] : totals) {
+      APP_LOG_INFO("  %-20s %zu bytes", tag.c_str(), bytes);
+    }
+  }
+
+  void publishMetrics() {
+    const uint64_t now = LibXR::QTTimebase::NowMicros();
+    const std::vector<MetricsRegistry::Sample> samples =
+        MetricsRegistry::Instance().Snapshot(now);
+    if (metricsExporter_ != nullptr) {
+      metricsExporter_->Export(now, samples);
+    }
+
+    QVariantList list;
+    list.reserve(static_cast<qsizetype>(samples.size()));
+    for (const MetricsRegistry::Sample &sample : samples) {
+      const bool counter = sample.kind == MetricsRegistry::Kind::COUNTER;
+      QVariantMap item;
+      item["name"] = QString::fromStdString(sample.name);
+      item["counter"] = counter;
+      item["value"] = static_cast<qulonglong>(sample.value);
+      item["rate"] = sample.rate;
+      item["highWater"] = static_cast<qulonglong>(sample.high_water);
+      list.append(item);
+    }
+    DeviceManager *manager = deviceManager_;
+    QMetaObject::invokeMethod(
+        manager, [manager, list]() { manager->SetMetrics(list); },
+        Qt::QueuedConnection);
+  }
+
+  void sendCommand(DeviceSession *session, const void *data, size_t size) {
+    /* Command 帧交给会话所在的解析线程录制并写入客户端 */
+    const QByteArray frame(static_cast<const char *>(data),
+                           static_cast<qsizetype>(size));
+    QMetaObject::invokeMethod(
+        session, [session, frame]() { session->sendCommand(frame); },
+        Qt::QueuedConnection);
+  }
+
+  bool hasFreeSession() const {
+    for (const DeviceSession *session : sessions_) {
+      if (!session->isActive()) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+private slots:
+  void onNewConnection(qintptr descriptor) {
+    /*
+     * 处理新的 TCP 客户端连接：
+     *  - 占用第一个空闲会话槽，由该槽所在的解析线程接管描述符；
+     *  - 没有空闲槽时拒绝连接。
+     */
+    for (DeviceSession *session : sessions_) {
+      if (session->tryClaim()) {
+        APP_LOG_DEBUG("Assigning new client to session %d", session->slot());
+        QMetaObject::invokeMethod(
+            session, [session, descriptor]() { session->accept(descriptor); },
+            Qt::QueuedConnection);
+        return;
+      }
+    }
+
+    QTcpSocket rejected;
+    if (rejected.setSocketDescriptor(descriptor)) {
+      rejected.abort();
+    }
+    APP_LOG_INFO("All %d sessions busy, rejecting new client connection",
+                 options_.max_sessions);
+  }
+
+  void onSessionClosed(int slot) {
+    /* 有槽位空出，立即广播让设备重新发现 */
+    APP_LOG_DEBUG("Session %d released", slot);
+    if (deviceManager_->filter_is_set_) {
+      broadcastUdpMessage();
+    }
+  }
+
+  void broadcastUdpMessage() {
+    /*
+     * 通过 UDP 广播设备识别信息：
+     *  - 如果已设置设备名过滤器，则使用带设备名的消息；
+     *  - 否则使用默认广播消息；
+     *  - 用于局域网内设备自动发现；
+     *  - 实际广播地址为 255.255.255.255:kUdpPort。
+     */
+    QString filter =
+        deviceManager_->filter_name_.isEmpty()
+            ? kUdpBroadcastMessageDefault
+            : kUdpBroadcastMessageFiltered + deviceManager_->filter_name_;
+
+    QByteArray message = filter.toUtf8();
+    int sent =
+        udpSocket_->writeDatagram(message, QHostAddress::Broadcast, kUdpPort);
+
+    if (sent == -1) {
+      APP_LOG_ERROR("Failed to send UDP broadcast");
+    } else {
+      APP_LOG_DEBUG("UDP broadcast sent");
+    }
+  }
+
+private:
+  AppOptions options_;
+  BufferArena arena_; /* 先于所有使用它的成员构造 */
+
+  /* 系统组件 */
+  DeviceManager *deviceManager_; /* GUI 线程对象，由前端持有 */
+  MetricsExporter *metricsExporter_ = nullptr;
+
+  /* 会话槽与解析线程 */
+  std::vector<DeviceSession *> sessions_;
+  std::vector<ChannelRegistry *> registries_; /* GUI 线程对象 */
+  std::vector<QThread *> shards_;
+
+  /* 网络通信 */
+  SessionTcpServer *tcpServer_ = nullptr;
+  QUdpSocket *udpSocket_ = nullptr;
+
+  /* 定时器 */
+  QTimer *broadcastTimer_ = nullptr;
+  QTimer *uiStatusTimer_ = nullptr;
+  QTimer *memoryCheckTimer_ = nullptr;
+  QTimer *linkStatsTimer_ = nullptr;
+  QTimer *metricsTimer_ = nullptr;
+
+  /* 状态变量 */
+  uint64_t lastReportedPeakRss_ = 0;
+
+  /* 常量定义 */
+  static constexpr quint16 kTcpPort = 5000;
+  static constexpr quint16 kUdpPort = 5001;
+  static constexpr uint64_t kMemoryReportStep = 4 * 1024 * 1024;
+  static constexpr char kUdpBroadcastMessageDefault[] =
+      "XRobot Debug Tools Default Message";
+  static constexpr char kUdpBroadcastMessageFiltered[] =
+      "XRobot Debug Tools Message Filtered:";
+};
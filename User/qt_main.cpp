@@ -1,17 +1,27 @@
-#include "DeviceManager.hpp"
+#include "AppOptions.hpp"
+#include "AsyncLogger.hpp"
+#include "HeadlessMain.hpp"
 #include "QTTimebase.hpp"
-#include "TerminalBackend.hpp"
+
+#include <QCoreApplication>
+#include <qdebug.h>
+
+/*
+ * NETDEBUG_HEADLESS_ONLY：只编译无界面前端（NetDebugClientHeadless 目标），
+ * 不链接 Qt Quick 与 WebEngine。
+ */
+#ifndef NETDEBUG_HEADLESS_ONLY
 #include "app_main.hpp"
 
 #include <QGuiApplication>
+#include <QIcon>
 #include <QQmlApplicationEngine>
 #include <QtWebChannel>
 #include <QtWebEngineQuick>
-#include <QIcon>
-#include <qdebug.h>
+#endif
 
 int main(int argc, char *argv[]) {
-  /* 初始化 LibXR 时间基准（用于毫秒级计时） */
+  /* 初始化 LibXR 时间基准（单调时钟，微秒精度） */
   LibXR::QTTimebase timebase;
 
   /*
@@ -39,11 +49,41 @@ int main(int argc, char *argv[]) {
   LibXR::STDIO::write_ = new LibXR::WritePort(32, 4096);
   (*LibXR::STDIO::write_) = write_fun;
 
+  /*
+   * 启动异步日志线程：
+   *  - APP_LOG_* 在调用线程只入队参数，格式化与输出在后台线程完成；
+   *  - 输出端同样重定向到 qDebug。
+   */
+  AsyncLogger::SetSink(
+      [](AsyncLogger::Level, const char *text, size_t len) {
+        qDebug("%.*s", static_cast<int>(len), text);
+      });
+  AsyncLogger::Start();
+
+  /*
+   * 无界面模式：
+   *  - 只创建 QCoreApplication，不初始化 WebEngine 与 QML；
+   *  - 通道数据写到标准输出（或 --output 目标），日志经 qDebug 写到标准错误。
+   */
+#ifndef NETDEBUG_HEADLESS_ONLY
+  if (AppOptions::HeadlessRequested(argc, argv))
+#endif
+  {
+    QCoreApplication app(argc, argv);
+    const AppOptions options = AppOptions::Parse(app);
+    HeadlessMain headless_main(options);
+    app.exec();
+    AsyncLogger::Stop();
+    return 0;
+  }
+
+#ifndef NETDEBUG_HEADLESS_ONLY
   /* 初始化 Qt WebEngine 环境（必须在 QGuiApplication 前） */
   QtWebEngineQuick::initialize();
 
   /* 启动 Qt GUI 应用 */
   QGuiApplication app(argc, argv);
+  const AppOptions options = AppOptions::Parse(app);
   QQmlApplicationEngine engine;
 
   /* 添加 QML 导入路径（打包后路径） */
@@ -53,10 +93,13 @@ int main(int argc, char *argv[]) {
   app.setWindowIcon(QIcon(":/web/favicon.ico"));
 
   /* 创建主控制器并启动工作线程 */
-  AppMain app_main(&engine);
+  AppMain app_main(&engine, options);
 
   /* 启动 Qt 主事件循环 */
   app.exec();
 
+  AsyncLogger::Stop();
+
   return 0;
+#endif
 }
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/*
+ * 简易基准框架：
+ * - BENCH_CASE 注册一个用例，main 按名称过滤后依次运行；
+ * - 用例内通过 BenchContext::Report 输出吞吐量（MB/s）、ns/byte 与
+ *   每次操作的堆分配次数；--json 时每条结果输出一行 JSON，便于脚本比较；
+ * - 不依赖第三方库，便于在 CI 上直接构建。
+ */
+
+/* 堆分配计数（计数钩子定义在 bench_main.cpp，统计所有线程） */
+struct BenchAllocStats {
+  uint64_t count = 0;
+  uint64_t bytes = 0;
+};
+
+inline std::atomic<uint64_t> &BenchAllocCount() {
+  static std::atomic<uint64_t> count{0};
+  return count;
+}
+
+inline std::atomic<uint64_t> &BenchAllocBytes() {
+  static std::atomic<uint64_t> bytes{0};
+  return bytes;
+}
+
+inline BenchAllocStats BenchAllocNow() {
+  BenchAllocStats stats;
+  stats.count = BenchAllocCount().load(std::memory_order_relaxed);
+  stats.bytes = BenchAllocBytes().load(std::memory_order_relaxed);
+  return stats;
+}
+
+/* BenchTime 计时区间内累计的分配，Report 时取出并清零 */
+inline BenchAllocStats &BenchTimedAllocs() {
+  static BenchAllocStats stats;
+  return stats;
+}
+
+/* 输出格式：false 为表格，true 为 JSON Lines */
+inline bool &BenchJsonOutput() {
+  static bool json = false;
+  return json;
+}
+
+class BenchContext {
+public:
+  explicit BenchContext(const char *name) : name_(name) {}
+
+  /*
+   * 记录一次测量结果：
+   * - 分配次数取自本次 Report 之前所有 BenchTime 区间的累计值，
+   *   准备数据与校验的分配不计入；
+   * - ops 为用例定义的操作数（包数、轮数或 write 次数）。
+   */
+  void Report(const char *variant, size_t bytes, size_t ops, double seconds,
+              const char *note = "") {
+    const BenchAllocStats allocs = BenchTimedAllocs();
+    BenchTimedAllocs() = BenchAllocStats();
+
+    const double mbps = seconds > 0 ? bytes / seconds / (1024.0 * 1024.0) : 0;
+    const double ns_per_byte = bytes > 0 ? seconds * 1e9 / bytes : 0;
+    const double allocs_per_op =
+        ops > 0 ? static_cast<double>(allocs.count) / ops : 0;
+
+    if (BenchJsonOutput()) {
+      std::printf("{\"bench\":\"%s\",\"variant\":\"%s\",\"bytes\":%zu,"
+                  "\"ops\":%zu,\"seconds\":%.9g,\"mb_per_s\":%.6g,"
+                  "\"ns_per_byte\":%.6g,\"allocs\":%llu,"
+                  "\"alloc_bytes\":%llu,\"allocs_per_op\":%.6g,"
+                  "\"note\":\"%s\"}\n",
+                  name_, variant, bytes, ops, seconds, mbps, ns_per_byte,
+                  static_cast<unsigned long long>(allocs.count),
+                  static_cast<unsigned long long>(allocs.bytes), allocs_per_op,
+                  JsonEscape(note).c_str());
+    } else {
+      std::printf("%-24s %-28s %10.1f MB/s %8.3f ns/B %10zu ops %9.3f "
+                  "alloc/op  %s\n",
+                  name_, variant, mbps, ns_per_byte, ops, allocs_per_op, note);
+    }
+    std::fflush(stdout);
+  }
+
+  const char *Name() const { return name_; }
+
+private:
+  static std::string JsonEscape(const char *text) {
+    std::string out;
+    for (; *text != '\0'; ++text) {
+      if (*text == '"' || *text == '\\') {
+        out.push_back('\\');
+      }
+      out.push_back(*text);
+    }
+    return out;
+  }
+
+  const char *name_;
+};
+
+using BenchFun = void (*)(BenchContext &ctx);
+
+struct BenchCase {
+  const char *name;
+  BenchFun fun;
+};
+
+inline std::vector<BenchCase> &BenchCases() {
+  static std::vector<BenchCase> cases;
+  return cases;
+}
+
+struct BenchRegistrar {
+  BenchRegistrar(const char *name, BenchFun fun) {
+    BenchCases().push_back({name, fun});
+  }
+};
+
+#define BENCH_CASE(name)                                                       \
+  static void name(BenchContext &ctx);                                         \
+  static BenchRegistrar name##_registrar(#name, name);                         \
+  static void name(BenchContext &ctx)
+
+/* 计时辅助：返回 fun 执行耗时（秒），并累计区间内的堆分配 */
+template <typename Fun> double BenchTime(Fun &&fun) {
+  const BenchAllocStats before = BenchAllocNow();
+  const auto begin = std::chrono::steady_clock::now();
+  fun();
+  const auto end = std::chrono::steady_clock::now();
+  const BenchAllocStats after = BenchAllocNow();
+  BenchTimedAllocs().count += after.count - before.count;
+  BenchTimedAllocs().bytes += after.bytes - before.bytes;
+  return std::chrono::duration<double>(end - begin).count();
+}
+
+/* 防止编译器把基准结果优化掉 */
+template <typename T> inline void BenchKeep(const T &value) {
+#if defined(__GNUC__) || defined(__clang__)
+  asm volatile("" : : "g"(&value) : "memory");
+#else
+  static volatile const void *sink;
+  sink = &value;
+#endif
+}
+
+/*
+ * 生成确定性的包长序列（xorshift，范围 [min_size, max_size]）：
+ * - 模拟 MCU 以不定长小包输出日志的情形。
+ */
+inline std::vector<size_t> BenchPacketSizes(size_t total, size_t min_size,
+                                            size_t max_size,
+                                            uint32_t seed = 0x9e3779b9u) {
+  std::vector<size_t> sizes;
+  size_t sum = 0;
+  while (sum < total) {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    size_t size = min_size + seed % (max_size - min_size + 1);
+    if (size > total - sum) {
+      size = total - sum;
+    }
+    sizes.push_back(size);
+    sum += size;
+  }
+  return sizes;
+}
@@ -0,0 +1,90 @@
+#include "Bench.hpp"
+#include "HexDump.hpp"
+
+#include <QString>
+
+/*
+ * hex_output_ 转储吞吐量：
+ *  - asprintf_loop：旧实现，逐字节 QString::asprintf("%02X ") 拼接；
+ *  - lut_*：HexDumpFormatter 写入预分配缓冲区，含不同布局。
+ * 输入按 1~512 字节随机包长切分，验证跨包换行状态。
+ */
+namespace {
+
+constexpr size_t kInputBytes = 4 * 1024 * 1024;
+
+std::vector<uint8_t> MakeInput() {
+  std::vector<uint8_t> data(kInputBytes);
+  uint32_t seed = 1;
+  for (uint8_t &byte : data) {
+    seed = seed * 1103515245u + 12345u;
+    byte = static_cast<uint8_t>(seed >> 16);
+  }
+  return data;
+}
+
+void RunFormatter(BenchContext &ctx, const char *variant,
+                  const std::vector<uint8_t> &data,
+                  const std::vector<size_t> &sizes,
+                  const HexDumpFormatter::Options &options) {
+  HexDumpFormatter formatter(options);
+  std::vector<char> out(formatter.MaxOutputSize(512) + 64);
+  size_t produced = 0;
+
+  double seconds = BenchTime([&] {
+    size_t offset = 0;
+    for (size_t size : sizes) {
+      produced += formatter.Format(data.data() + offset, size, out.data());
+      offset += size;
+    }
+  });
+  BenchKeep(produced);
+  ctx.Report(variant, data.size(), sizes.size(), seconds);
+}
+
+} // namespace
+
+BENCH_CASE(hex_dump) {
+  const std::vector<uint8_t> data = MakeInput();
+  const std::vector<size_t> sizes = BenchPacketSizes(data.size(), 1, 512);
+
+  /* 旧实现（只跑 1/8 数据量，结果按实际字节数折算） */
+  {
+    const size_t limit = data.size() / 8;
+    uint64_t count = 0;
+    size_t bytes = 0;
+    size_t packets = 0;
+    qsizetype produced = 0;
+    double seconds = BenchTime([&] {
+      size_t offset = 0;
+      for (size_t size : sizes) {
+        if (offset >= limit) {
+          break;
+        }
+        QString hexStr;
+        for (size_t i = 0; i < size; ++i) {
+          count++;
+          hexStr += QString::asprintf("%02X ", data[offset + i]);
+          if (count % 16 == 0)
+            hexStr += "\r\n";
+        }
+        produced += hexStr.size();
+        offset += size;
+        bytes += size;
+        ++packets;
+      }
+    });
+    BenchKeep(produced);
+    ctx.Report("asprintf_loop", bytes, packets, seconds);
+  }
+
+  HexDumpFormatter::Options options;
+  RunFormatter(ctx, "lut_16col", data, sizes, options);
+
+  options.show_offset = true;
+  options.show_ascii = true;
+  RunFormatter(ctx, "lut_16col_offset_ascii", data, sizes, options);
+
+  options.columns = 32;
+  RunFormatter(ctx, "lut_32col_offset_ascii", data, sizes, options);
+}
@@ -0,0 +1,82 @@
+#include "Bench.hpp"
+
+#include <QCoreApplication>
+
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+/*
+ * 堆分配计数钩子：
+ * - glibc 下替换 malloc / calloc / realloc，Qt 容器（QArrayData 直接
+ *   调用 malloc）与 operator new（libstdc++ 内部调用 malloc）都会计入；
+ * - 其他平台替换全局 operator new，只统计 C++ 分配，Qt 容器不计入。
+ */
+#if defined(__GLIBC__)
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *ptr, size_t size);
+
+void *malloc(size_t size) {
+  BenchAllocCount().fetch_add(1, std::memory_order_relaxed);
+  BenchAllocBytes().fetch_add(size, std::memory_order_relaxed);
+  return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+  BenchAllocCount().fetch_add(1, std::memory_order_relaxed);
+  BenchAllocBytes().fetch_add(count * size, std::memory_order_relaxed);
+  return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+  BenchAllocCount().fetch_add(1, std::memory_order_relaxed);
+  BenchAllocBytes().fetch_add(size, std::memory_order_relaxed);
+  return __libc_realloc(ptr, size);
+}
+}
+#else
+void *operator new(size_t size) {
+  BenchAllocCount().fetch_add(1, std::memory_order_relaxed);
+  BenchAllocBytes().fetch_add(size, std::memory_order_relaxed);
+  if (void *ptr = std::malloc(size == 0 ? 1 : size)) {
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+#endif
+
+/*
+ * NetDebugClient_bench 入口：
+ *  - 无参数时运行全部用例；
+ *  - 参数为用例名子串过滤，例如 `NetDebugClient_bench output`；
+ *  - --json 时每条结果输出一行 JSON，例如
+ *    `NetDebugClient_bench --json > before.jsonl`，便于比较两次运行。
+ */
+int main(int argc, char *argv[]) {
+  QCoreApplication app(argc, argv);
+
+  const char *filter = "";
+  for (int i = 1; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--json") == 0) {
+      BenchJsonOutput() = true;
+    } else {
+      filter = argv[i];
+    }
+  }
+
+  for (const BenchCase &bench : BenchCases()) {
+    if (std::strstr(bench.name, filter) == nullptr) {
+      continue;
+    }
+    BenchContext ctx(bench.name);
+    bench.fun(ctx);
+  }
+
+  return 0;
+}
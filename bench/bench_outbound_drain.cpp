@@ -0,0 +1,119 @@
+#include "Bench.hpp"
+#include "OutboundQueue.hpp"
+#include "TopicEncoder.hpp"
+#include "libxr.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+
+/*
+ * forwardTcpData 的发送队列消费开销（3 个通道，每通道 1 MiB 已封包数据，
+ * 负载 16~512 字节）：
+ *  - popbatch_4k：旧实现，LockFreeQueue::PopBatch 拷贝到 4 KiB 静态
+ *    缓冲区，再交给 socket；
+ *  - peek_consume：OutboundQueue 连续区段直接交给 socket，无中间拷贝。
+ * socket 的写缓冲以一次 memcpy 到预分配 sink 模拟；队列填充不计入耗时。
+ */
+namespace {
+
+constexpr size_t kChannels = 3;
+constexpr size_t kChannelBytes = 1024 * 1024;
+constexpr size_t kQueueBytes = 4 * kChannelBytes;
+constexpr size_t kLegacyBuffer = 4096;
+constexpr int kRounds = 16;
+
+std::vector<uint8_t> MakeFrames() {
+  const std::vector<size_t> sizes = BenchPacketSizes(kChannelBytes, 16, 512);
+  std::vector<uint8_t> payload(512, 'x');
+  std::vector<uint8_t> frames;
+  for (size_t size : sizes) {
+    const size_t offset = frames.size();
+    frames.resize(offset + size + TopicEncoder::kOverhead);
+    LibXR::Topic::PackData(
+        0x12345678, {frames.data() + offset, size + TopicEncoder::kOverhead},
+        {payload.data(), size});
+  }
+  return frames;
+}
+
+/* 模拟 QTcpSocket::write 追加到写缓冲 */
+struct Sink {
+  std::vector<uint8_t> buffer = std::vector<uint8_t>(kChannels * kQueueBytes);
+  size_t used = 0;
+  size_t writes = 0;
+
+  void Write(const uint8_t *data, size_t size) {
+    std::memcpy(buffer.data() + used, data, size);
+    used += size;
+    ++writes;
+  }
+};
+
+void RunPopBatch(BenchContext &ctx, const std::vector<uint8_t> &frames) {
+  std::vector<std::unique_ptr<LibXR::LockFreeQueue<uint8_t>>> queues;
+  for (size_t i = 0; i < kChannels; ++i) {
+    queues.push_back(
+        std::make_unique<LibXR::LockFreeQueue<uint8_t>>(kQueueBytes));
+  }
+  static uint8_t buffer[kLegacyBuffer];
+  Sink sink;
+
+  double seconds = 0;
+  for (int round = 0; round < kRounds; ++round) {
+    for (auto &queue : queues) {
+      queue->PushBatch(frames.data(), frames.size());
+    }
+    sink.used = 0;
+    seconds += BenchTime([&] {
+      for (auto &queue : queues) {
+        while (queue->Size() > 0) {
+          const size_t size = std::min(queue->Size(), sizeof(buffer));
+          queue->PopBatch(buffer, size);
+          sink.Write(buffer, size);
+        }
+      }
+    });
+  }
+  ctx.Report("popbatch_4k", frames.size() * kChannels * kRounds, sink.writes,
+             seconds);
+}
+
+void RunPeekConsume(BenchContext &ctx, const std::vector<uint8_t> &frames) {
+  std::vector<std::vector<uint8_t>> storage(
+      kChannels, std::vector<uint8_t>(kQueueBytes));
+  std::vector<std::unique_ptr<OutboundQueue>> queues;
+  for (auto &block : storage) {
+    queues.push_back(
+        std::make_unique<OutboundQueue>(block.data(), block.size()));
+  }
+  Sink sink;
+
+  double seconds = 0;
+  for (int round = 0; round < kRounds; ++round) {
+    for (auto &queue : queues) {
+      queue->Push(frames.data(), frames.size());
+    }
+    sink.used = 0;
+    seconds += BenchTime([&] {
+      for (auto &queue : queues) {
+        const uint8_t *data = nullptr;
+        size_t size = 0;
+        while ((size = queue->Peek(&data)) > 0) {
+          sink.Write(data, size);
+          queue->Consume(size);
+        }
+      }
+    });
+  }
+  ctx.Report("peek_consume", frames.size() * kChannels * kRounds,
+             sink.writes, seconds);
+}
+
+} // namespace
+
+BENCH_CASE(outbound_drain) {
+  const std::vector<uint8_t> frames = MakeFrames();
+  RunPopBatch(ctx, frames);
+  RunPeekConsume(ctx, frames);
+}
@@ -0,0 +1,158 @@
+#include "Bench.hpp"
+#include "OutboundQueue.hpp"
+#include "TopicEncoder.hpp"
+
+#include <QString>
+#include <QStringEncoder>
+
+#include <cstring>
+
+/*
+ * sendText 封包吞吐量（模拟一次 4 MiB 粘贴，512 字节分包）：
+ *  - legacy_*：旧实现，toUtf8 + PackData 到 pack_buffer_[0]
+ *    （嵌套时再打包到 pack_buffer_[1]）+ 拷贝入队；
+ *  - encoder_*：TopicEncoder 直接在 OutboundQueue 的预留空间中封包。
+ * 每轮结束后消费者一次性清空队列，不计入耗时。
+ */
+namespace {
+
+constexpr size_t kPasteBytes = 4 * 1024 * 1024;
+constexpr size_t kMaxPayload = 512;
+constexpr size_t kQueueBytes = 8 * 1024 * 1024;
+constexpr uint32_t kTopicKey = 0x12345678;
+constexpr int kRounds = 8;
+
+void DrainQueue(OutboundQueue &queue) {
+  const uint8_t *data = nullptr;
+  size_t size = 0;
+  while ((size = queue.Peek(&data)) > 0) {
+    queue.Consume(size);
+  }
+}
+
+void RunLegacy(BenchContext &ctx, const char *variant, const QString &text,
+               size_t bytes_per_round, bool nested) {
+  std::vector<uint8_t> storage(kQueueBytes);
+  OutboundQueue queue(storage.data(), storage.size());
+  std::vector<uint8_t> pack[2];
+  pack[0].resize(kMaxPayload + TopicEncoder::kOverhead * 2);
+  pack[1].resize(kMaxPayload + TopicEncoder::kOverhead * 2);
+
+  double seconds = 0;
+  for (int round = 0; round < kRounds; ++round) {
+    seconds += BenchTime([&] {
+      QByteArray bytes = text.toUtf8();
+      size_t offset = 0;
+      const size_t total = static_cast<size_t>(bytes.size());
+      while (offset < total) {
+        const size_t chunk = std::min(kMaxPayload, total - offset);
+        LibXR::Topic::PackData(kTopicKey, {pack[0].data(), pack[0].size()},
+                               {bytes.data() + offset, chunk});
+        if (nested) {
+          LibXR::Topic::PackData(
+              kTopicKey, {pack[1].data(), pack[1].size()},
+              {pack[0].data(), chunk + TopicEncoder::kOverhead});
+          queue.Push(pack[1].data(), chunk + TopicEncoder::kOverhead * 2);
+        } else {
+          queue.Push(pack[0].data(), chunk + TopicEncoder::kOverhead);
+        }
+        offset += chunk;
+      }
+    });
+    DrainQueue(queue);
+  }
+  ctx.Report(variant, bytes_per_round * kRounds, kRounds, seconds);
+}
+
+void RunEncoder(BenchContext &ctx, const char *variant, const QString &text,
+                size_t bytes_per_round, bool nested, const char *note) {
+  std::vector<uint8_t> storage(kQueueBytes);
+  OutboundQueue queue(storage.data(), storage.size());
+  std::vector<uint8_t> scratch(TopicEncoder::ScratchSize(kMaxPayload));
+  TopicEncoder encoder(kTopicKey, nested, kMaxPayload, scratch.data());
+  QStringEncoder utf8(QStringEncoder::Utf8, QStringEncoder::Flag::Stateless);
+  std::vector<char> utf8_buffer;
+
+  double seconds = 0;
+  for (int round = 0; round < kRounds; ++round) {
+    seconds += BenchTime([&] {
+      utf8_buffer.resize(
+          static_cast<size_t>(utf8.requiredSpace(text.size())));
+      char *end = utf8.appendToBuffer(utf8_buffer.data(), text);
+      const size_t total = static_cast<size_t>(end - utf8_buffer.data());
+
+      auto lock = queue.LockProducer();
+      size_t offset = 0;
+      while (offset < total) {
+        const size_t chunk = std::min(kMaxPayload, total - offset);
+        uint8_t *frame = queue.Reserve(encoder.FrameSize(chunk));
+        queue.Commit(
+            encoder.Encode(utf8_buffer.data() + offset, chunk, frame));
+        offset += chunk;
+      }
+    });
+    DrainQueue(queue);
+  }
+  ctx.Report(variant, bytes_per_round * kRounds, kRounds, seconds, note);
+}
+
+/* 验证两种实现输出的字节流一致 */
+bool SameOutput(const QString &text, bool nested) {
+  std::vector<uint8_t> a(kQueueBytes), b(kQueueBytes);
+  OutboundQueue legacy(a.data(), a.size());
+  OutboundQueue direct(b.data(), b.size());
+  std::vector<uint8_t> pack[2];
+  pack[0].resize(kMaxPayload + TopicEncoder::kOverhead * 2);
+  pack[1].resize(kMaxPayload + TopicEncoder::kOverhead * 2);
+  std::vector<uint8_t> scratch(TopicEncoder::ScratchSize(kMaxPayload));
+  TopicEncoder encoder(kTopicKey, nested, kMaxPayload, scratch.data());
+
+  QByteArray bytes = text.toUtf8();
+  const size_t total = static_cast<size_t>(bytes.size());
+  for (size_t offset = 0; offset < total;) {
+    const size_t chunk = std::min(kMaxPayload, total - offset);
+    LibXR::Topic::PackData(kTopicKey, {pack[0].data(), pack[0].size()},
+                           {bytes.data() + offset, chunk});
+    if (nested) {
+      LibXR::Topic::PackData(kTopicKey, {pack[1].data(), pack[1].size()},
+                             {pack[0].data(), chunk + TopicEncoder::kOverhead});
+      legacy.Push(pack[1].data(), chunk + TopicEncoder::kOverhead * 2);
+    } else {
+      legacy.Push(pack[0].data(), chunk + TopicEncoder::kOverhead);
+    }
+
+    auto lock = direct.LockProducer();
+    uint8_t *frame = direct.Reserve(encoder.FrameSize(chunk));
+    direct.Commit(encoder.Encode(bytes.data() + offset, chunk, frame));
+    offset += chunk;
+  }
+
+  const uint8_t *x = nullptr;
+  const uint8_t *y = nullptr;
+  const size_t nx = legacy.Peek(&x);
+  const size_t ny = direct.Peek(&y);
+  return nx == ny && std::memcmp(x, y, nx) == 0;
+}
+
+} // namespace
+
+BENCH_CASE(outbound_pack) {
+  /* 以 ASCII 为主、夹杂中文的粘贴文本，末包不满 512 字节 */
+  QString text;
+  const QString line = QStringLiteral("set motor.pid.kp 1.25 # 电机参数\n");
+  while (text.size() * 2 < static_cast<qsizetype>(kPasteBytes)) {
+    text += line;
+  }
+  text.truncate(static_cast<qsizetype>(kPasteBytes / 2) - 7);
+
+  const char *check = SameOutput(text, false) && SameOutput(text, true)
+                          ? "output identical"
+                          : "OUTPUT MISMATCH";
+
+  const size_t bytes = static_cast<size_t>(text.toUtf8().size());
+
+  RunLegacy(ctx, "legacy_single", text, bytes, false);
+  RunEncoder(ctx, "encoder_single", text, bytes, false, check);
+  RunLegacy(ctx, "legacy_nested", text, bytes, true);
+  RunEncoder(ctx, "encoder_nested", text, bytes, true, check);
+}
@@ -0,0 +1,123 @@
+#include "Bench.hpp"
+
+#include <QByteArray>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QString>
+#include <QStringDecoder>
+
+/*
+ * 终端输出路径对比（大段日志突发）：
+ *  - text_per_packet：每个 Topic 包 QString::fromUtf8 + WebChannel JSON（旧路径）；
+ *  - text_coalesced：按 64 KiB 合并后有状态解码 + JSON；
+ *  - binary_coalesced：按 64 KiB 合并后 Base64 + JSON（receiveData 路径）。
+ * 另统计 U+FFFD 替换字符数量，体现逐包解码对跨包多字节字符的破坏。
+ */
+namespace {
+
+constexpr size_t kBurstBytes = 32 * 1024 * 1024;
+constexpr qsizetype kFlushBytes = 64 * 1024;
+
+QByteArray MakeBurst() {
+  const QByteArray line = QStringLiteral(
+                              "[  1234.567890] imu: gyro=(0.012,-0.004,0.998) "
+                              "温度=36.5°C 状态正常 ✓\r\n")
+                              .toUtf8();
+  QByteArray burst;
+  burst.reserve(static_cast<qsizetype>(kBurstBytes));
+  while (static_cast<size_t>(burst.size()) + line.size() <= kBurstBytes) {
+    burst.append(line);
+  }
+  return burst;
+}
+
+/* 模拟 QWebChannel 的信号消息封装 */
+QByteArray WrapSignal(const QJsonValue &arg) {
+  QJsonObject msg;
+  msg["type"] = 1;
+  msg["object"] = QStringLiteral("backend1");
+  msg["signal"] = 5;
+  msg["args"] = QJsonArray{arg};
+  return QJsonDocument(msg).toJson(QJsonDocument::Compact);
+}
+
+qsizetype CountReplacement(const QString &text) {
+  return text.count(QChar(QChar::ReplacementCharacter));
+}
+
+} // namespace
+
+BENCH_CASE(output_burst) {
+  const QByteArray burst = MakeBurst();
+  const std::vector<size_t> sizes =
+      BenchPacketSizes(static_cast<size_t>(burst.size()), 1, 512);
+
+  /* 旧路径：逐包解码并逐包发送 */
+  {
+    qsizetype replaced = 0;
+    size_t messages = 0;
+    size_t json_bytes = 0;
+    double seconds = BenchTime([&] {
+      qsizetype offset = 0;
+      for (size_t size : sizes) {
+        QString text = QString::fromUtf8(burst.constData() + offset,
+                                         static_cast<qsizetype>(size));
+        replaced += CountReplacement(text);
+        json_bytes += static_cast<size_t>(WrapSignal(text).size());
+        ++messages;
+        offset += static_cast<qsizetype>(size);
+      }
+    });
+    ctx.Report("text_per_packet", static_cast<size_t>(burst.size()), messages,
+               seconds,
+               QString("json=%1B fffd=%2")
+                   .arg(json_bytes)
+                   .arg(replaced)
+                   .toLatin1()
+                   .constData());
+  }
+
+  /* 合并 + 有状态文本解码 */
+  {
+    qsizetype replaced = 0;
+    size_t messages = 0;
+    size_t json_bytes = 0;
+    double seconds = BenchTime([&] {
+      QStringDecoder decoder(QStringDecoder::Utf8);
+      for (qsizetype offset = 0; offset < burst.size();
+           offset += kFlushBytes) {
+        QString text =
+            decoder(QByteArrayView(burst).mid(offset, kFlushBytes));
+        replaced += CountReplacement(text);
+        json_bytes += static_cast<size_t>(WrapSignal(text).size());
+        ++messages;
+      }
+    });
+    ctx.Report("text_coalesced", static_cast<size_t>(burst.size()), messages,
+               seconds,
+               QString("json=%1B fffd=%2")
+                   .arg(json_bytes)
+                   .arg(replaced)
+                   .toLatin1()
+                   .constData());
+  }
+
+  /* 合并 + 二进制（Base64）通道 */
+  {
+    size_t messages = 0;
+    size_t json_bytes = 0;
+    double seconds = BenchTime([&] {
+      for (qsizetype offset = 0; offset < burst.size();
+           offset += kFlushBytes) {
+        const QByteArray chunk = burst.mid(offset, kFlushBytes);
+        json_bytes += static_cast<size_t>(
+            WrapSignal(QString::fromLatin1(chunk.toBase64())).size());
+        ++messages;
+      }
+    });
+    ctx.Report("binary_coalesced", static_cast<size_t>(burst.size()), messages,
+               seconds,
+               QString("json=%1B fffd=0").arg(json_bytes).toLatin1().constData());
+  }
+}
@@ -0,0 +1,102 @@
+#include "Bench.hpp"
+#include "Command.hpp"
+#include "TopicEncoder.hpp"
+#include "libxr.hpp"
+
+#include <cstring>
+
+/*
+ * Topic::Server::ParseData 在多通道混合流上的解析吞吐量：
+ *  - 流中按 6:3:1 交错 uart1 / uart_cdc / command 三种封包，
+ *    负载长度为 16~512（mixed）或 8~32（small，逐包开销占主导）；
+ *  - 按不同的 TCP 读取粒度喂给解析器：mtu（1448 字节）、64k、
+ *    random（1~4096 字节，模拟 readyRead 的不规则分段）；
+ *  - ops 为封包数，回调收到的负载总字节数与生成值一致时 note 为 ok。
+ */
+namespace {
+
+constexpr size_t kStreamBytes = 32 * 1024 * 1024;
+constexpr size_t kServerBuffer = 256 * 1024;
+constexpr size_t kTopicMax = 512 + TopicEncoder::kOverhead;
+
+struct Stream {
+  std::vector<uint8_t> bytes;
+  size_t packets = 0;
+  size_t payload = 0;
+};
+
+Stream MakeStream(uint32_t uart1, uint32_t cdc, uint32_t command,
+                  size_t min_size, size_t max_size) {
+  const std::vector<size_t> sizes =
+      BenchPacketSizes(kStreamBytes, min_size, max_size);
+  std::vector<uint8_t> payload(max_size, 'a');
+  Stream stream;
+  stream.bytes.reserve(kStreamBytes + sizes.size() * TopicEncoder::kOverhead);
+  for (size_t i = 0; i < sizes.size(); ++i) {
+    size_t size = sizes[i];
+    uint32_t key = i % 10 < 6 ? uart1 : cdc;
+    Command cmd{};
+    const void *data = payload.data();
+    if (i % 10 == 9) {
+      key = command;
+      cmd.type = Command::Type::PING;
+      data = &cmd;
+      size = sizeof(cmd);
+    }
+    const size_t offset = stream.bytes.size();
+    stream.bytes.resize(offset + size + TopicEncoder::kOverhead);
+    LibXR::Topic::PackData(
+        key, {stream.bytes.data() + offset, size + TopicEncoder::kOverhead},
+        {const_cast<void *>(data), size});
+    stream.payload += size;
+    ++stream.packets;
+  }
+  return stream;
+}
+
+void RunParse(BenchContext &ctx, const char *variant, size_t min_size,
+              size_t max_size, size_t chunk_min, size_t chunk_max) {
+  /* LibXR 的 Topic 不会从域中注销，每个变体使用独立的域 */
+  LibXR::Topic::Domain domain(variant);
+  LibXR::Topic uart1("uart1", kTopicMax, &domain);
+  LibXR::Topic cdc("uart_cdc", kTopicMax, &domain);
+  LibXR::Topic command("command", sizeof(Command), &domain);
+  LibXR::Topic::Server server(kServerBuffer);
+
+  size_t received = 0;
+  auto cb = LibXR::Topic::Callback::Create(
+      [](bool, size_t *received, LibXR::RawData &data) {
+        *received += data.size_;
+      },
+      &received);
+  for (LibXR::Topic *topic : {&uart1, &cdc, &command}) {
+    topic->RegisterCallback(cb);
+    server.Register(*topic);
+  }
+
+  const Stream stream = MakeStream(uart1.GetKey(), cdc.GetKey(),
+                                   command.GetKey(), min_size, max_size);
+  const std::vector<size_t> chunks =
+      BenchPacketSizes(stream.bytes.size(), chunk_min, chunk_max, 7);
+
+  const double seconds = BenchTime([&] {
+    size_t offset = 0;
+    for (size_t size : chunks) {
+      server.ParseData({stream.bytes.data() + offset, size});
+      offset += size;
+    }
+  });
+
+  ctx.Report(variant, stream.bytes.size(), stream.packets, seconds,
+             received == stream.payload ? "ok" : "PAYLOAD MISMATCH");
+}
+
+} // namespace
+
+BENCH_CASE(topic_parse) {
+  RunParse(ctx, "mixed_mtu", 16, 512, 1448, 1448);
+  RunParse(ctx, "mixed_64k", 16, 512, 64 * 1024, 64 * 1024);
+  RunParse(ctx, "mixed_random", 16, 512, 1, 4096);
+  RunParse(ctx, "small_mtu", 8, 32, 1448, 1448);
+  RunParse(ctx, "small_random", 8, 32, 1, 4096);
+}
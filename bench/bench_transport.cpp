@@ -0,0 +1,197 @@
+#include "Bench.hpp"
+#include "LatencyHistogram.hpp"
+#include "SocketTransport.hpp"
+
+#include <QHostAddress>
+#include <QTcpServer>
+#include <QTcpSocket>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+/*
+ * 环回 TCP 上两种传输模式的吞吐量与往返延迟：
+ *  - stream_*：3 个通道交错输出 16..512 字节的小包，每次唤醒 64 包，
+ *    发送端 bytesToWrite 超过 256 KiB 时等待（与会话的写缓冲上限一致），
+ *    接收线程读满总字节数后计时结束；ops 为 write() 调用次数；
+ *  - pingpong_*：每轮写入两段 32 字节（模拟封包头与负载分开到达），
+ *    对端原样回显，统计往返时间分布；
+ *  - *_nagle_split：保留 Nagle 且逐段 flush（未设置 socket 选项、
+ *    也不汇集时的行为），用于对比 TCP_NODELAY 的作用。
+ */
+namespace {
+
+constexpr size_t kStreamBytes = 64 * 1024 * 1024;
+constexpr size_t kFramesPerWakeup = 64;
+constexpr qint64 kSocketBacklog = 256 * 1024;
+constexpr size_t kGatherBytes = 256 * 1024;
+constexpr size_t kPingSegment = 32;
+constexpr int kPingRounds = 2000;
+
+/* 接收端：在独立线程中连接、读满 total 字节；echo 为 true 时回显 */
+void RunPeer(quint16 port, size_t total, bool echo) {
+  QTcpSocket socket;
+  socket.connectToHost(QHostAddress::LocalHost, port);
+  if (!socket.waitForConnected(3000)) {
+    return;
+  }
+  socket.setSocketOption(QAbstractSocket::LowDelayOption, 1);
+
+  std::vector<char> buffer(256 * 1024);
+  size_t received = 0;
+  while (received < total) {
+    if (socket.bytesAvailable() == 0 && !socket.waitForReadyRead(3000)) {
+      break;
+    }
+    const qint64 n = socket.read(buffer.data(), buffer.size());
+    if (n <= 0) {
+      continue;
+    }
+    received += static_cast<size_t>(n);
+    if (echo) {
+      socket.write(buffer.data(), n);
+      socket.flush();
+    }
+  }
+  while (echo && socket.bytesToWrite() > 0 &&
+         socket.waitForBytesWritten(3000)) {
+  }
+}
+
+/* 建立一条环回连接，返回服务端接受的 socket（与应用中的会话一致） */
+QTcpSocket *Accept(QTcpServer &server, std::thread &peer, size_t total,
+                   bool echo) {
+  server.listen(QHostAddress::LocalHost, 0);
+  const quint16 port = server.serverPort();
+  peer = std::thread(RunPeer, port, total, echo);
+  if (!server.waitForNewConnection(3000)) {
+    return nullptr;
+  }
+  return server.nextPendingConnection();
+}
+
+void RunStream(BenchContext &ctx, const char *variant,
+               const TransportOptions &options, bool gather) {
+  const std::vector<size_t> sizes = BenchPacketSizes(kStreamBytes, 16, 512);
+  std::vector<uint8_t> payload(512, 'x');
+  std::vector<uint8_t> gather_buffer(gather ? kGatherBytes : 0);
+
+  QTcpServer server;
+  std::thread peer;
+  QTcpSocket *socket = Accept(server, peer, kStreamBytes, false);
+  if (socket == nullptr) {
+    std::fprintf(stderr, "%s: loopback connection failed\n", variant);
+    if (peer.joinable()) {
+      peer.join();
+    }
+    return;
+  }
+
+  SocketTransport transport(options, gather ? gather_buffer.data() : nullptr,
+                            gather_buffer.size());
+  transport.Attach(socket);
+
+  const double seconds = BenchTime([&] {
+    for (size_t i = 0; i < sizes.size();) {
+      while (socket->bytesToWrite() > kSocketBacklog) {
+        socket->waitForBytesWritten(1000);
+      }
+      const size_t end = std::min(sizes.size(), i + kFramesPerWakeup);
+      for (; i < end; ++i) {
+        transport.Write(payload.data(), sizes[i]);
+      }
+      transport.Finish();
+    }
+    while (socket->bytesToWrite() > 0 && socket->waitForBytesWritten(1000)) {
+    }
+    peer.join();
+  });
+
+  char note[64];
+  std::snprintf(note, sizeof(note), "%zu frames",
+                static_cast<size_t>(sizes.size()));
+  ctx.Report(variant, kStreamBytes, static_cast<size_t>(transport.Writes()),
+             seconds, note);
+  delete socket;
+}
+
+void RunPingPong(BenchContext &ctx, const char *variant,
+                 const TransportOptions &options, bool gather) {
+  const size_t round_bytes = kPingSegment * 2;
+  const size_t total = round_bytes * kPingRounds;
+  std::vector<uint8_t> segment(kPingSegment, 'p');
+  std::vector<uint8_t> gather_buffer(gather ? kGatherBytes : 0);
+  std::vector<char> reply(round_bytes);
+
+  QTcpServer server;
+  std::thread peer;
+  QTcpSocket *socket = Accept(server, peer, total, true);
+  if (socket == nullptr) {
+    std::fprintf(stderr, "%s: loopback connection failed\n", variant);
+    if (peer.joinable()) {
+      peer.join();
+    }
+    return;
+  }
+
+  SocketTransport transport(options, gather ? gather_buffer.data() : nullptr,
+                            gather_buffer.size());
+  transport.Attach(socket);
+
+  LatencyHistogram rtt;
+  const double seconds = BenchTime([&] {
+    for (int round = 0; round < kPingRounds; ++round) {
+      const auto begin = std::chrono::steady_clock::now();
+      transport.Write(segment.data(), segment.size());
+      transport.Write(segment.data(), segment.size());
+      transport.Finish();
+
+      size_t received = 0;
+      while (received < round_bytes) {
+        if (socket->bytesAvailable() == 0 &&
+            !socket->waitForReadyRead(3000)) {
+          break;
+        }
+        const qint64 n = socket->read(
+            reply.data(), static_cast<qint64>(round_bytes - received));
+        if (n > 0) {
+          received += static_cast<size_t>(n);
+        }
+      }
+      rtt.Record(static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::microseconds>(
+              std::chrono::steady_clock::now() - begin)
+              .count()));
+    }
+    peer.join();
+  });
+
+  char note[96];
+  std::snprintf(note, sizeof(note),
+                "rtt p50 %llu us, p99 %llu us, max %llu us",
+                static_cast<unsigned long long>(rtt.Percentile(0.50)),
+                static_cast<unsigned long long>(rtt.Percentile(0.99)),
+                static_cast<unsigned long long>(rtt.Max()));
+  ctx.Report(variant, total, kPingRounds, seconds, note);
+  delete socket;
+}
+
+} // namespace
+
+BENCH_CASE(transport) {
+  TransportOptions latency;
+  latency.mode = TransportMode::LATENCY;
+  TransportOptions throughput;
+  throughput.mode = TransportMode::THROUGHPUT;
+
+  RunStream(ctx, "stream_latency", latency, false);
+  RunStream(ctx, "stream_throughput", throughput, true);
+  RunStream(ctx, "stream_nagle_split", throughput, false);
+
+  RunPingPong(ctx, "pingpong_latency", latency, false);
+  RunPingPong(ctx, "pingpong_throughput", throughput, true);
+  RunPingPong(ctx, "pingpong_nagle_split", throughput, false);
+}
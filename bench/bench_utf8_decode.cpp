@@ -0,0 +1,91 @@
+#include "Bench.hpp"
+
+#include <QByteArray>
+#include <QString>
+#include <QStringDecoder>
+
+/*
+ * 单独测量 UTF-8 → QString 转换（不含 JSON 与 WebChannel）：
+ *  - fromutf8_*：每个 Topic 包调用一次 QString::fromUtf8（旧路径），
+ *    每包一次堆分配；
+ *  - decoder_*：有状态 QStringDecoder 追加到预分配的 QChar 缓冲区，
+ *    跨包的多字节字符可以正确拼接；
+ * 输入为纯 ASCII 日志或夹杂中文的日志，按 16~512 字节随机包长切分。
+ */
+namespace {
+
+constexpr size_t kInputBytes = 16 * 1024 * 1024;
+
+QByteArray MakeInput(const QString &line) {
+  const QByteArray bytes = line.toUtf8();
+  QByteArray input;
+  input.reserve(static_cast<qsizetype>(kInputBytes));
+  while (static_cast<size_t>(input.size()) + bytes.size() <= kInputBytes) {
+    input.append(bytes);
+  }
+  return input;
+}
+
+void RunFromUtf8(BenchContext &ctx, const char *variant,
+                 const QByteArray &input, const std::vector<size_t> &sizes) {
+  qsizetype chars = 0;
+  const double seconds = BenchTime([&] {
+    qsizetype offset = 0;
+    for (size_t size : sizes) {
+      const QString text =
+          QString::fromUtf8(input.constData() + offset,
+                            static_cast<qsizetype>(size));
+      chars += text.size();
+      BenchKeep(text);
+      offset += static_cast<qsizetype>(size);
+    }
+  });
+  char note[48];
+  std::snprintf(note, sizeof(note), "%lld chars",
+                static_cast<long long>(chars));
+  ctx.Report(variant, static_cast<size_t>(input.size()), sizes.size(),
+             seconds, note);
+}
+
+void RunDecoder(BenchContext &ctx, const char *variant,
+                const QByteArray &input, const std::vector<size_t> &sizes) {
+  QStringDecoder decoder(QStringDecoder::Utf8);
+  std::vector<QChar> buffer(512 + 4);
+  qsizetype chars = 0;
+  const double seconds = BenchTime([&] {
+    qsizetype offset = 0;
+    for (size_t size : sizes) {
+      QChar *end = decoder.appendToBuffer(
+          buffer.data(),
+          QByteArrayView(input.constData() + offset,
+                         static_cast<qsizetype>(size)));
+      chars += end - buffer.data();
+      BenchKeep(buffer);
+      offset += static_cast<qsizetype>(size);
+    }
+  });
+  char note[48];
+  std::snprintf(note, sizeof(note), "%lld chars",
+                static_cast<long long>(chars));
+  ctx.Report(variant, static_cast<size_t>(input.size()), sizes.size(),
+             seconds, note);
+}
+
+} // namespace
+
+BENCH_CASE(utf8_decode) {
+  const QByteArray ascii = MakeInput(QStringLiteral(
+      "[  1234.567890] imu: gyro=(0.012,-0.004,0.998) temp=36.5C ok\r\n"));
+  const QByteArray mixed = MakeInput(QStringLiteral(
+      "[  1234.567890] imu: gyro=(0.012,-0.004,0.998) "
+      "温度=36.5°C 状态正常 ✓\r\n"));
+  const std::vector<size_t> ascii_sizes =
+      BenchPacketSizes(static_cast<size_t>(ascii.size()), 16, 512);
+  const std::vector<size_t> mixed_sizes =
+      BenchPacketSizes(static_cast<size_t>(mixed.size()), 16, 512);
+
+  RunFromUtf8(ctx, "fromutf8_ascii", ascii, ascii_sizes);
+  RunDecoder(ctx, "decoder_ascii", ascii, ascii_sizes);
+  RunFromUtf8(ctx, "fromutf8_mixed", mixed, mixed_sizes);
+  RunDecoder(ctx, "decoder_mixed", mixed, mixed_sizes);
+}
@@ -0,0 +1,54 @@
+#!/usr/bin/env bash
+#
+# 启动耗时与内存基准：比较 eager / lazy / single 三种终端视图加载方式。
+#  - 每种方式冷启动 RUNS 次，应用输出启动报告后自动退出；
+#  - 报告首批视图就绪耗时、就绪时与稳定后的进程树常驻内存
+#    （含 QtWebEngineProcess 子进程）；
+#  - 无显示环境时使用 QT_QPA_PLATFORM=offscreen。
+#
+# 用法：bench/startup_views.sh [可执行文件] [次数]
+#   例如 bench/startup_views.sh build/NetDebugClient 5
+
+set -euo pipefail
+
+APP="${1:-build/NetDebugClient}"
+RUNS="${2:-3}"
+
+if [ ! -x "$APP" ]; then
+    echo "Executable not found: $APP" >&2
+    exit 1
+fi
+
+if [ -z "${DISPLAY:-}" ] && [ -z "${WAYLAND_DISPLAY:-}" ]; then
+    export QT_QPA_PLATFORM="${QT_QPA_PLATFORM:-offscreen}"
+fi
+
+printf "%-8s %6s %12s %14s %14s\n" "mode" "runs" "ready ms" "ready MiB" "settled MiB"
+
+for mode in eager lazy single; do
+    ready_ms=0
+    ready_mib=0
+    settled_mib=0
+    for _ in $(seq "$RUNS"); do
+        log="$(timeout 60 "$APP" --view-mode "$mode" --exit-after-startup \
+            --max-sessions 1 2>&1 || true)"
+
+        ready="$(grep -m1 "Startup ($mode):.*ready in" <<<"$log" || true)"
+        settled="$(grep -m1 "Startup ($mode):.*settled" <<<"$log" || true)"
+        if [ -z "$ready" ] || [ -z "$settled" ]; then
+            echo "$mode: no startup report, see application log:" >&2
+            echo "$log" | tail -20 >&2
+            exit 1
+        fi
+
+        ready_ms=$(awk -v a="$ready_ms" -v l="$ready" \
+            'BEGIN { match(l, /ready in [0-9]+/); print a + substr(l, RSTART + 9, RLENGTH - 9) }')
+        ready_mib=$(awk -v a="$ready_mib" -v l="$ready" \
+            'BEGIN { match(l, /rss [0-9.]+/); print a + substr(l, RSTART + 4, RLENGTH - 4) }')
+        settled_mib=$(awk -v a="$settled_mib" -v l="$settled" \
+            'BEGIN { match(l, /rss [0-9.]+/); print a + substr(l, RSTART + 4, RLENGTH - 4) }')
+    done
+
+    awk -v m="$mode" -v n="$RUNS" -v t="$ready_ms" -v r="$ready_mib" -v s="$settled_mib" \
+        'BEGIN { printf "%-8s %6d %12.0f %14.1f %14.1f\n", m, n, t / n, r / n, s / n }'
+done
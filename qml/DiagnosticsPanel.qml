@@ -0,0 +1,88 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import QtQuick.Layouts 1.15
+import QtQuick.Controls.Material 2.15
+
+/*
+ * 诊断面板：实时显示指标快照（每秒由 Worker 推送一次）
+ * - 计数器显示累计值与每秒速率；
+ * - 量表显示当前值与本周期高水位；
+ * - 可按名称过滤（如 "s0." 只看槽 0，"send_queue" 只看发送队列）。
+ */
+Dialog {
+    id: panel
+    title: "诊断"
+    modal: false
+    width: 560
+    height: 420
+
+    Material.theme: Material.Dark
+
+    standardButtons: Dialog.Close
+
+    // 字节数格式化：B / KiB / MiB
+    function formatBytes(value) {
+        if (value >= 1024 * 1024)
+            return (value / (1024 * 1024)).toFixed(1) + " MiB"
+        if (value >= 1024)
+            return (value / 1024).toFixed(1) + " KiB"
+        return value.toFixed(0) + " B"
+    }
+
+    function formatValue(name, value) {
+        return name.indexOf("bytes") >= 0 || name.indexOf("queue") >= 0
+                || name.indexOf("buffer") >= 0 ? formatBytes(value) : value.toFixed(0)
+    }
+
+    contentItem: ColumnLayout {
+        spacing: 8
+
+        TextField {
+            id: filterInput
+            Layout.fillWidth: true
+            placeholderText: "按名称过滤，如 s0. / send_queue"
+            selectByMouse: true
+        }
+
+        ListView {
+            id: metricList
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            clip: true
+            model: device_manager.metrics.filter(
+                       m => filterInput.text === "" || m.name.indexOf(filterInput.text) >= 0)
+
+            ScrollBar.vertical: ScrollBar {}
+
+            delegate: RowLayout {
+                width: metricList.width
+                spacing: 12
+
+                Label {
+                    Layout.fillWidth: true
+                    text: modelData.name
+                    color: "#cccccc"
+                    font.family: "monospace"
+                    font.pixelSize: 12
+                    elide: Text.ElideRight
+                }
+                Label {
+                    Layout.preferredWidth: 110
+                    horizontalAlignment: Text.AlignRight
+                    text: formatValue(modelData.name, modelData.value)
+                    color: "#cccccc"
+                    font.pixelSize: 12
+                }
+                Label {
+                    Layout.preferredWidth: 140
+                    horizontalAlignment: Text.AlignRight
+                    text: modelData.counter
+                          ? formatValue(modelData.name, modelData.rate) + "/s"
+                          : "峰值 " + formatValue(modelData.name, modelData.highWater)
+                    color: modelData.counter ? "#4caf50" : "#ff9800"
+                    font.pixelSize: 12
+                }
+            }
+        }
+    }
+}
@@ -2,7 +2,6 @@ import QtQuick 2.15
 import QtQuick.Controls 2.15
 import QtQuick.Controls.Material 2.15
 import QtWebChannel 1.1
-import com.example 1.0
 
 ApplicationWindow {
     id: root
@@ -14,11 +13,7 @@ ApplicationWindow {
     Material.theme: Material.Dark
     Material.accent: Material.Blue
 
-    /* 后端设备管理对象（绑定至 C++） */
-    DeviceManager {
-        id: device_manager
-        objectName: "device_manager"
-    }
+    /* 后端设备管理对象 device_manager 由 C++ 注入上下文 */
 
     /* 对话框：开机时提示用户输入设备名 */
     Dialog {
@@ -65,10 +60,9 @@ ApplicationWindow {
     Component {
         id: terminalComponent
         MainTerminalView {
-            backend0: backend0Obj
-            backend1: backend1Obj
-            backend2: backend2Obj
+            channels: channelRegistry
             channel: qmlWebChannel
+            viewMode: terminalViewMode
             anchors.fill: parent
         }
     }
@@ -77,51 +71,38 @@ ApplicationWindow {
     property var qmlWebChannel: null
     property var terminalView: null
 
-    /* 工具函数：验证 backend 是否可用 */
-    function isValidBackend(obj) {
-        return obj !== null && typeof obj === "object";
-    }
-
-    /* 初始化回调：检查并创建 WebChannel 和终端视图 */
+    /* 初始化回调：检查通道表并创建 WebChannel 和终端视图 */
     Component.onCompleted: {
         console.log("ApplicationWindow loaded")
-        console.debug("backend0Obj:", backend0Obj)
-        console.debug("backend1Obj:", backend1Obj)
-        console.debug("backend2Obj:", backend2Obj)
 
-        if (isValidBackend(backend0Obj) &&
-            isValidBackend(backend1Obj) &&
-            isValidBackend(backend2Obj)) {
+        if (!channelRegistry || channelRegistry.count === 0) {
+            console.error("Channel registry is null or empty")
+            return
+        }
+        console.debug("Channels:", channelRegistry.count)
+
+        qmlWebChannel = webChannelComponent.createObject(root)
+        if (!qmlWebChannel) {
+            console.error("Failed to create WebChannel")
+            return
+        }
+        console.log("WebChannel created")
 
-            console.log("All backends are valid")
+        /* 每个通道以 backend<N> 注册，页面通过 ?channel=backend<N> 查找 */
+        for (var i = 0; i < channelRegistry.count; ++i)
+            qmlWebChannel.registerObject("backend" + i, channelRegistry.backend(i))
+        console.log("WebChannel registered objects")
 
-            qmlWebChannel = webChannelComponent.createObject(root)
-            if (!qmlWebChannel) {
-                console.error("Failed to create WebChannel")
-                return
-            }
-            console.log("WebChannel created")
-
-            qmlWebChannel.registerObject("backend0", backend0Obj)
-            qmlWebChannel.registerObject("backend1", backend1Obj)
-            qmlWebChannel.registerObject("backend2", backend2Obj)
-            console.log("WebChannel registered objects")
-
-            terminalView = terminalComponent.createObject(root, {
-                backend0: backend0Obj,
-                backend1: backend1Obj,
-                backend2: backend2Obj,
-                channel: qmlWebChannel
-            })
-
-            if (!terminalView) {
-                console.error("Failed to create MainTerminalView")
-            } else {
-                console.log("MainTerminalView created")
-            }
+        terminalView = terminalComponent.createObject(root, {
+            channels: channelRegistry,
+            channel: qmlWebChannel,
+            viewMode: terminalViewMode
+        })
 
+        if (!terminalView) {
+            console.error("Failed to create MainTerminalView")
         } else {
-            console.error("One or more backends are null or invalid")
+            console.log("MainTerminalView created")
         }
     }
 }
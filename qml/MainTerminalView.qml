@@ -1,7 +1,6 @@
 import QtQuick 2.15
 import QtQuick.Controls 2.15
 import QtQuick.Layouts 1.15
-import QtWebEngine 1.15
 import QtWebChannel 1.1
 
 Item {
@@ -9,54 +8,54 @@ Item {
     width: 800
     height: 600
 
-    /* 串口后端对象和 WebChannel 绑定接口 */
-    property var backend0
-    property var backend1
-    property var backend2
+    /* 通道表（C++ ChannelRegistry 模型）和 WebChannel 绑定接口 */
+    property var channels
     property var channel
 
     /* 当前选择的终端索引 */
     property int currentIndex: 0
 
-    /* 每个终端的串口配置项（初始值） */
-    property var configs: [
-        {
-            baudrate: "115200",
-            parity: "None",
-            stopBits: "1",
-            dataBits: "8"
-        },
-        {
-            baudrate: "115200",
-            parity: "None",
-            stopBits: "1",
-            dataBits: "8"
-        },
-        {
-            baudrate: "115200",
-            parity: "None",
-            stopBits: "1",
-            dataBits: "8"
-        }
-    ]
+    /*
+     * 终端视图加载方式（--view-mode）：
+     *  - eager：全部标签页立即创建；
+     *  - lazy：标签页第一次被选中时创建，之后常驻；创建前的输出由后端
+     *    暂存（最近约 256 KiB），页面连接时经 attachView() 补上；
+     *  - single：一个页面承载全部通道的终端，只占用一个渲染进程。
+     */
+    property string viewMode: "lazy"
+
+    /* 启动报告：初始视图全部加载后回调一次 */
+    property int loadedViews: 0
+    readonly property int initialViews: viewMode === "eager" && channels ? channels.count : 1
+
+    function onViewLoaded() {
+        loadedViews += 1;
+        if (loadedViews === initialViews && typeof startupReport !== "undefined")
+            startupReport.viewsReady(loadedViews);
+    }
 
-    /* 标签页模型（串口名称） */
-    ListModel {
-        id: terminalModel
-        ListElement {
-            name: "MiniPC"
-        }
-        ListElement {
-            name: "USART1"
-        }
-        ListElement {
-            name: "USART2"
-        }
+    /* 当前显示的终端页面（可能尚未创建） */
+    function currentWebView() {
+        if (viewMode === "single")
+            return sharedPage.item;
+        const loader = terminalRepeater.itemAt(currentIndex);
+        return loader ? loader.item : null;
+    }
+
+    /* 单页模式下所有通道的 WebChannel 对象名 */
+    function channelIdList() {
+        let ids = [];
+        for (let i = 0; channels && i < channels.count; ++i)
+            ids.push("backend" + i);
+        return ids.join(",");
     }
 
+    /* 每个终端的串口配置项（按通道数在初始化时填充） */
+    property var configs: []
+
     /* 根据索引获取后端对象 */
     function getBackend(index) {
-        return index === 0 ? backend0 : index === 1 ? backend1 : backend2;
+        return channels ? channels.backend(index) : null;
     }
 
     /* 深拷贝配置对象 */
@@ -76,12 +75,13 @@ Item {
 
     Component.onCompleted: {
         Qt.callLater(() => {
-            if (!backend0 || !backend1 || !backend2 || !channel) {
-                console.error("One or more backend/channel objects are null");
+            if (!channels || !channel) {
+                console.error("Channel registry or WebChannel is null");
                 return;
             }
 
-            for (var i = 0; i < 3; ++i) {
+            for (var i = 0; i < channels.count; ++i) {
+                configs[i] = copyConfig(null);
                 var b = getBackend(i);
                 if (b && b.defaultConfig) {
                     var cfg = b.defaultConfig();
@@ -98,6 +98,8 @@ Item {
 
     onCurrentIndexChanged: {
         configPanel.config = copyConfig(configs[currentIndex]);
+        if (viewMode === "single" && sharedPage.item)
+            sharedPage.item.runJavaScript(`window.showChannel(${currentIndex});`);
     }
 
     /* 接收 C++ 发送的剪贴板文本，转发给当前 WebView */
@@ -105,9 +107,9 @@ Item {
         target: clipboardBridge
         function onClipboardTextReady(text) {
             console.log("Received clipboard text: " + text);
-            let currentWebView = terminalStack.itemAt(root.currentIndex);
-            if (currentWebView) {
-                currentWebView.runJavaScript(`window.pasteFromClipboard(${JSON.stringify(text)});`);
+            let webView = currentWebView();
+            if (webView) {
+                webView.runJavaScript(`window.pasteFromClipboard(${JSON.stringify(text)});`);
             } else {
                 console.error("Cannot find current WebView");
             }
@@ -120,7 +122,7 @@ Item {
         anchors.margins: 12
         spacing: 10
 
-        /* 顶部标签栏（MiniPC / USART1 / USART2） */
+        /* 顶部标签栏（每个通道一个标签） */
         Rectangle {
             Layout.fillWidth: true
             Layout.preferredHeight: 48
@@ -131,7 +133,7 @@ Item {
                 spacing: 0
 
                 Repeater {
-                    model: terminalModel
+                    model: root.channels
                     delegate: Rectangle {
                         Layout.fillWidth: true
                         Layout.fillHeight: true
@@ -146,7 +148,7 @@ Item {
 
                         Text {
                             anchors.centerIn: parent
-                            text: model.name
+                            text: model.title
                             color: currentIndex === index ? "white" : "#aaaaaa"
                             font.pixelSize: 16
                             font.bold: currentIndex === index
@@ -160,6 +162,8 @@ Item {
         SerialConfigPanel {
             id: configPanel
             index: currentIndex
+            backend: getBackend(currentIndex)
+            configurable: channels ? channels.isConfigurable(currentIndex) : false
             Layout.fillWidth: true
 
             onUserConfigUpdated: function (idx, newConfig) {
@@ -180,64 +184,57 @@ Item {
             }
         }
 
-        /* WebView 堆叠视图：三个终端页面 */
+        /* WebView 堆叠视图：每个通道一个终端页面（eager / lazy） */
         StackLayout {
             id: terminalStack
             Layout.fillWidth: true
             Layout.fillHeight: true
+            visible: root.viewMode !== "single"
             currentIndex: root.currentIndex
 
-            WebEngineView {
-                id: webview1
-                url: "qrc:/web/index.html?channel=backend0"
-                webChannel: channel
-                settings.localContentCanAccessFileUrls: true
-                settings.localContentCanAccessRemoteUrls: true
-                onContextMenuRequested: function (request) {
-                    request.accepted = true;
-                    const selected = request.selectedText;
-                    if (selected && selected.length > 0) {
-                        runJavaScript(`doCopy(${JSON.stringify(selected)});`);
-                    } else {
-                        forceActiveFocus();
-                        clipboardBridge.requestClipboardText();
+            Repeater {
+                id: terminalRepeater
+                model: root.viewMode !== "single" ? root.channels : null
+
+                Loader {
+                    required property int index
+                    required property string channelId
+
+                    /* 一旦创建便保持，切换标签不销毁页面 */
+                    property bool activated: false
+                    active: root.viewMode === "eager" || activated || root.currentIndex === index
+                    onActiveChanged: {
+                        if (active)
+                            activated = true;
+                    }
+                    Component.onCompleted: {
+                        if (active)
+                            activated = true;
                     }
-                }
-            }
 
-            WebEngineView {
-                id: webview2
-                url: "qrc:/web/index.html?channel=backend1"
-                webChannel: channel
-                settings.localContentCanAccessFileUrls: true
-                settings.localContentCanAccessRemoteUrls: true
-                onContextMenuRequested: function (request) {
-                    request.accepted = true;
-                    const selected = request.selectedText;
-                    if (selected && selected.length > 0) {
-                        runJavaScript(`doCopy(${JSON.stringify(selected)});`);
-                    } else {
-                        forceActiveFocus();
-                        clipboardBridge.requestClipboardText();
+                    sourceComponent: TerminalPage {
+                        url: "qrc:/web/index.html?channel=" + channelId
+                        webChannel: root.channel
+                        onPageReady: root.onViewLoaded()
                     }
                 }
             }
+        }
 
-            WebEngineView {
-                id: webview3
-                url: "qrc:/web/index.html?channel=backend2"
-                webChannel: channel
-                settings.localContentCanAccessFileUrls: true
-                settings.localContentCanAccessRemoteUrls: true
-                onContextMenuRequested: function (request) {
-                    request.accepted = true;
-                    const selected = request.selectedText;
-                    if (selected && selected.length > 0) {
-                        runJavaScript(`doCopy(${JSON.stringify(selected)});`);
-                    } else {
-                        forceActiveFocus();
-                        clipboardBridge.requestClipboardText();
-                    }
+        /* 单页模式：一个页面承载全部通道 */
+        Loader {
+            id: sharedPage
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            visible: active
+            active: root.viewMode === "single"
+
+            sourceComponent: TerminalPage {
+                url: "qrc:/web/index.html?channels=" + root.channelIdList()
+                webChannel: root.channel
+                onPageReady: {
+                    runJavaScript(`window.showChannel(${root.currentIndex});`);
+                    root.onViewLoaded();
                 }
             }
         }
@@ -11,9 +11,12 @@ Frame {
     Material.theme: Material.Dark
     Material.accent: Material.Teal
 
-    // 当前终端索引（0=MiniPC，配置不可编辑）
+    // 当前终端索引
     property int index: 0
 
+    // 当前终端是否可配置（透传通道如 MiniPC 不可编辑串口参数）
+    property bool configurable: true
+
     property bool updating: false
 
     // 当前配置
@@ -23,44 +26,8 @@ Frame {
         updateWidgets();
     }
 
-    property var backend: (index === 0 ? backend0Obj : index === 1 ? backend1Obj : index === 2 ? backend2Obj : null)
-
-    // 所有终端配置模型（应由外部初始化）
-    ListModel {
-        id: configModel
-        ListElement {
-            baudrate: "115200"
-            parity: "None"
-            stopBits: "1"
-            dataBits: "8"
-            hexOutput: false
-            saveToFile: false
-        }
-        ListElement {
-            baudrate: "115200"
-            parity: "None"
-            stopBits: "1"
-            dataBits: "8"
-            hexOutput: false
-            saveToFile: false
-        }
-        ListElement {
-            baudrate: "115200"
-            parity: "None"
-            stopBits: "1"
-            dataBits: "8"
-            hexOutput: false
-            saveToFile: false
-        }
-        ListElement {
-            baudrate: "115200"
-            parity: "None"
-            stopBits: "1"
-            dataBits: "8"
-            hexOutput: false
-            saveToFile: false
-        }
-    }
+    // 当前终端后端对象（由通道表提供）
+    property var backend: null
 
     // 向 C++ 通知当前终端配置变更
     signal userConfigUpdated(int index, var config)
@@ -73,9 +40,7 @@ Frame {
 
     // 切换 index 时载入配置
     onIndexChanged: {
-        if (index >= 0 && index < configModel.count) {
-            updateWidgets();
-        }
+        updateWidgets();
     }
 
     function findIndex(model, value) {
@@ -99,23 +64,32 @@ Frame {
         dataBitsBox.currentIndex = findIndex(dataBitsBox.model, config.dataBits);
 
         hexOutputBox.checked = !!config.hexOutput;
+        if (config.hexColumns !== undefined)
+            hexColumnsBox.currentIndex = findIndex(hexColumnsBox.model, config.hexColumns);
+        hexOffsetBox.checked = !!config.hexOffset;
+        hexAsciiBox.checked = !!config.hexAscii;
         saveToFileBox.checked = !!config.saveToFile;
 
         updating = false;
     }
 
-    // 更新字段：config + configModel
+    // 更新字段：config
     function updateConfigField(field, value) {
         if (!config || config[field] === value)
             return;
         config[field] = value;
-        var obj = {};
-        obj[field] = value;
-        configModel.set(index, obj);
         if (!updating)
             userConfigUpdated(index, config);
     }
 
+    // 十六进制转储布局：列数、行首偏移与行尾 ASCII
+    function applyHexLayout() {
+        if (!backend || hexColumnsBox.currentIndex < 0)
+            return;
+        backend.setHexLayout(parseInt(hexColumnsBox.model[hexColumnsBox.currentIndex]),
+                             hexOffsetBox.checked, hexAsciiBox.checked);
+    }
+
     Flow {
         spacing: 16
         Layout.fillWidth: true
@@ -125,7 +99,7 @@ Frame {
         Item {
             width: 120
             height: 40
-            opacity: index !== 0 ? 1 : 0.4
+            opacity: configurable ? 1 : 0.4
             Behavior on opacity {
                 NumberAnimation {
                     duration: 150
@@ -142,7 +116,7 @@ Frame {
                 }
                 ComboBox {
                     id: baudrateBox
-                    enabled: index !== 0
+                    enabled: configurable
                     width: parent.width
                     height: 40
                     font.pixelSize: 14
@@ -162,7 +136,7 @@ Frame {
         Item {
             width: 100
             height: 40
-            opacity: index !== 0 ? 1 : 0.4
+            opacity: configurable ? 1 : 0.4
             Behavior on opacity {
                 NumberAnimation {
                     duration: 150
@@ -179,7 +153,7 @@ Frame {
                 }
                 ComboBox {
                     id: parityBox
-                    enabled: index !== 0
+                    enabled: configurable
                     width: parent.width
                     height: 40
                     font.pixelSize: 14
@@ -199,7 +173,7 @@ Frame {
         Item {
             width: 70
             height: 40
-            opacity: index !== 0 ? 1 : 0.4
+            opacity: configurable ? 1 : 0.4
             Behavior on opacity {
                 NumberAnimation {
                     duration: 150
@@ -216,7 +190,7 @@ Frame {
                 }
                 ComboBox {
                     id: stopBitsBox
-                    enabled: index !== 0
+                    enabled: configurable
                     width: parent.width
                     height: 40
                     font.pixelSize: 14
@@ -236,7 +210,7 @@ Frame {
         Item {
             width: 70
             height: 40
-            opacity: index !== 0 ? 1 : 0.4
+            opacity: configurable ? 1 : 0.4
             Behavior on opacity {
                 NumberAnimation {
                     duration: 150
@@ -253,7 +227,7 @@ Frame {
                 }
                 ComboBox {
                     id: dataBitsBox
-                    enabled: index !== 0
+                    enabled: configurable
                     width: parent.width
                     height: 40
                     font.pixelSize: 14
@@ -305,6 +279,115 @@ Frame {
             }
         }
 
+        // Hex Columns
+        Item {
+            width: 70
+            height: 40
+            opacity: hexOutputBox.checked ? 1 : 0.4
+            Behavior on opacity {
+                NumberAnimation {
+                    duration: 150
+                }
+            }
+
+            Column {
+                anchors.fill: parent
+                spacing: 2
+                Label {
+                    text: "Columns:"
+                    color: "#dddddd"
+                    font.pixelSize: 12
+                }
+                ComboBox {
+                    id: hexColumnsBox
+                    enabled: hexOutputBox.checked
+                    width: parent.width
+                    height: 40
+                    font.pixelSize: 14
+                    model: ["8", "16", "32"]
+                    currentIndex: 1
+                    onCurrentIndexChanged: {
+                        if (updating)
+                            return;
+                        updateConfigField("hexColumns", model[currentIndex]);
+                        applyHexLayout();
+                    }
+                }
+            }
+        }
+
+        // Hex Offset
+        Item {
+            width: 60
+            height: 40
+            opacity: hexOutputBox.checked ? 1 : 0.4
+            Behavior on opacity {
+                NumberAnimation {
+                    duration: 150
+                }
+            }
+
+            Column {
+                anchors.fill: parent
+                spacing: 2
+                Label {
+                    text: "Offset:"
+                    color: "#dddddd"
+                    font.pixelSize: 12
+                }
+                CheckBox {
+                    id: hexOffsetBox
+                    enabled: hexOutputBox.checked
+                    width: parent.width
+                    height: 40
+                    font.pixelSize: 14
+                    checked: false
+                    onCheckedChanged: {
+                        if (updating)
+                            return;
+                        updateConfigField("hexOffset", checked);
+                        applyHexLayout();
+                    }
+                }
+            }
+        }
+
+        // Hex ASCII
+        Item {
+            width: 60
+            height: 40
+            opacity: hexOutputBox.checked ? 1 : 0.4
+            Behavior on opacity {
+                NumberAnimation {
+                    duration: 150
+                }
+            }
+
+            Column {
+                anchors.fill: parent
+                spacing: 2
+                Label {
+                    text: "ASCII:"
+                    color: "#dddddd"
+                    font.pixelSize: 12
+                }
+                CheckBox {
+                    id: hexAsciiBox
+                    enabled: hexOutputBox.checked
+                    width: parent.width
+                    height: 40
+                    font.pixelSize: 14
+                    checked: false
+                    onCheckedChanged: {
+                        if (updating)
+                            return;
+                        updateConfigField("hexAscii", checked);
+                        applyHexLayout();
+                    }
+                }
+            }
+        }
+
         // Save to File
         Item {
             width: 60
@@ -341,11 +424,11 @@ Frame {
             }
         }
 
-        // MiniPC 专用按钮
+        // 透传通道（MiniPC）专用按钮
         Item {
             width: 90
             height: 40
-            opacity: index === 0 ? 1 : 0.4
+            opacity: !configurable ? 1 : 0.4
             Behavior on opacity {
                 NumberAnimation {
                     duration: 150
@@ -364,7 +447,7 @@ Frame {
                     width: parent.width
                     height: 40
                     font.pixelSize: 14
-                    enabled: index === 0
+                    enabled: !configurable
                     onClicked: {
                         console.log("重启MiniPC");
                         device_manager.RestartMiniPC();
@@ -372,16 +455,29 @@ Frame {
                 }
             }
         }
-    }
 
-    Component.onCompleted: {
-        if (index >= 0 && index < configModel.count) {
-            var defaultCfg = backend ? backend.defaultConfig() : null;
-            if (defaultCfg) {
-                for (var key in defaultCfg)
-                    configModel.setProperty(index, key, defaultCfg[key]);
+        // 发送受阻提示：发送队列已满，输入暂存等待链路腾出空间
+        Item {
+            width: 90
+            height: 40
+            visible: backend !== null && backend.sendBlocked
+
+            Column {
+                anchors.fill: parent
+                spacing: 2
+                Label {
+                    text: " "
+                }
+                Label {
+                    text: "发送积压"
+                    color: "#ff6d00"
+                    font.pixelSize: 14
+                }
             }
-            updateWidgets();
         }
     }
+
+    Component.onCompleted: {
+        updateWidgets();
+    }
 }
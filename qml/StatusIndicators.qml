@@ -45,6 +45,42 @@ RowLayout {
         }
     }
 
+    // 链路质量：RTT / 抖动 / 当前离线阈值（毫秒），劣化时显示为橙色
+    Label {
+        property var stats: device_manager.linkStats
+        visible: device_manager.backendConnected && stats.timeout !== undefined
+        color: stats.degraded ? "#ff6d00" : "#cccccc"
+        font.pixelSize: 13
+        text: (stats.rttSupported
+               ? "RTT " + stats.rttP50.toFixed(1) + "/" + stats.rttP99.toFixed(1)
+                 + "/" + stats.rttMax.toFixed(1) + " ms"
+               : "RTT n/a")
+              + "  Jitter p99 " + (stats.jitterP99 || 0).toFixed(1) + " ms"
+              + "  Timeout " + (stats.timeout || 0).toFixed(0) + " ms"
+              + (stats.degraded ? "  (degraded)" : "")
+    }
+
+    // 告警：设备输出命中告警模式的次数与最近一次，点击查看列表
+    RowLayout {
+        spacing: 6
+        visible: channelRegistry && channelRegistry.alertCount > 0
+        Rectangle {
+            width: 12; height: 12; radius: 6
+            color: "#f44336"
+            border.color: "#333333"
+        }
+        Label {
+            text: "Alerts " + channelRegistry.alertCount + "  " + channelRegistry.lastAlert
+            color: "#ff8a80"
+            font.pixelSize: 13
+            MouseArea {
+                anchors.fill: parent
+                cursorShape: Qt.PointingHandCursor
+                onClicked: alertDialog.open()
+            }
+        }
+    }
+
     // 重命名按钮：打开对话框
     Button {
         text: "修改名称"
@@ -53,6 +89,59 @@ RowLayout {
         Layout.alignment: Qt.AlignLeft
     }
 
+    // 诊断按钮：打开吞吐与队列深度面板
+    Button {
+        text: "诊断"
+        onClicked: diagnosticsPanel.open()
+        Layout.alignment: Qt.AlignLeft
+    }
+
+    DiagnosticsPanel {
+        id: diagnosticsPanel
+        anchors.centerIn: parent.parent
+    }
+
+    // 弹出对话框：最近的告警（新的在前），清除后状态栏指示消失
+    Dialog {
+        id: alertDialog
+        title: "告警"
+        modal: true
+        width: 480
+        height: 360
+        anchors.centerIn: parent.parent
+        standardButtons: Dialog.Close
+
+        contentItem: ColumnLayout {
+            spacing: 8
+
+            ListView {
+                Layout.fillWidth: true
+                Layout.fillHeight: true
+                clip: true
+                model: channelRegistry ? channelRegistry.recentAlerts : []
+                delegate: Label {
+                    width: ListView.view.width
+                    elide: Text.ElideRight
+                    color: "#cccccc"
+                    font.pixelSize: 12
+                    font.family: "monospace"
+                    text: new Date(modelData.wall_ms).toLocaleTimeString(Qt.locale(), "HH:mm:ss.zzz")
+                          + "  " + modelData.channel + "  @" + modelData.offset
+                          + "  " + modelData.pattern
+                }
+            }
+
+            Button {
+                text: "清除"
+                Layout.alignment: Qt.AlignRight
+                onClicked: {
+                    channelRegistry.clearAlerts()
+                    alertDialog.close()
+                }
+            }
+        }
+    }
+
     // 弹出对话框：重命名设备
     Dialog {
         id: renameDialog
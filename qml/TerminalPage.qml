@@ -0,0 +1,33 @@
+import QtQuick 2.15
+import QtWebEngine 1.15
+
+/* 终端页面：加载 xterm.js 页面并通过 WebChannel 连接后端 */
+WebEngineView {
+    id: page
+
+    /* 页面首次加载成功时发出（用于启动报告） */
+    signal pageReady
+
+    property bool readyReported: false
+
+    settings.localContentCanAccessFileUrls: true
+    settings.localContentCanAccessRemoteUrls: true
+
+    onLoadingChanged: function (loadingInfo) {
+        if (!readyReported && loadingInfo.status === WebEngineLoadingInfo.LoadSucceededStatus) {
+            readyReported = true;
+            pageReady();
+        }
+    }
+
+    onContextMenuRequested: function (request) {
+        request.accepted = true;
+        const selected = request.selectedText;
+        if (selected && selected.length > 0) {
+            runJavaScript(`doCopy(${JSON.stringify(selected)});`);
+        } else {
+            forceActiveFocus();
+            clipboardBridge.requestClipboardText();
+        }
+    }
+}
@@ -0,0 +1,513 @@
+#pragma once
+
+#include "Command.hpp"
+#include "LatencyHistogram.hpp"
+#include "QTTimebase.hpp"
+#include "TopicEncoder.hpp"
+#include "libxr.hpp"
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QHostAddress>
+#include <QObject>
+#include <QStringList>
+#include <QTcpSocket>
+#include <QTimer>
+#include <QUdpSocket>
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+/*
+ * 模拟器选项：
+ * - name 为设备名，只响应默认广播或过滤名与之相同的广播；
+ * - host 非空时跳过 UDP 发现，直接连接；
+ * - rate 为每个通道的发送速率（字节/秒），0 表示尽力发送（受 TCP 背压）；
+ * - 每 burst_ms 毫秒发出一批，批内总字节数为 rate × burst_ms，
+ *   包长在 [min_packet, max_packet] 之间随机，burst_ms 越大越突发；
+ * - ping_ms / probe_ms 为 PING 与 PROBE 周期，0 表示不发送；
+ * - echo 为 true 时把客户端发往串口的数据原样回传到同一通道；
+ * - duration_s 为运行时长，0 表示一直运行。
+ */
+struct SimOptions {
+  QString name;
+  QString host;
+  quint16 port = 5000;
+  quint16 discovery_port = 5001;
+  QStringList channels = {"uart_cdc", "uart1", "uart2"};
+  QString tunnel = "uart_cdc";
+  double rate = 10 * 1024;
+  size_t min_packet = 16;
+  size_t max_packet = 256;
+  int burst_ms = 10;
+  int ping_ms = 100;
+  int probe_ms = 100;
+  bool remote_ping = true;
+  bool echo = false;
+  int duration_s = 0;
+  int report_s = 1;
+};
+
+/*
+ * LinkSimulator：NetDebugLink 设备端（ESP32）的本机模拟
+ * - 监听 UDP 发现广播，收到后向广播源的 TCP 端口发起连接；
+ * - 各通道按 Topic 协议封包输出生成的文本流；命令 Topic 上周期发送
+ *   PING / REMOTE_PING，回应客户端的 PROBE；
+ * - 自己也周期发送 PROBE，客户端经完整的接收、解析、命令分发路径
+ *   回 PROBE_ACK，得到端到端往返时间；
+ * - 透传通道（默认 uart_cdc）收到的是两层封包，回传时去掉内层；
+ * - 按周期与结束时输出吞吐量、往返时间分布与探测丢失数。
+ */
+class LinkSimulator : public QObject {
+  Q_OBJECT
+public:
+  explicit LinkSimulator(const SimOptions &options, QObject *parent = nullptr)
+      : QObject(parent), options_(options), domain_("sim"),
+        command_topic_("command", sizeof(Command), &domain_),
+        server_(kServerBuffer) {
+    options_.max_packet =
+        std::max(options_.max_packet, std::max<size_t>(options_.min_packet, 1));
+    payload_.resize(options_.max_packet);
+    frame_.resize(std::max(options_.max_packet, kMaxEcho) +
+                  TopicEncoder::kOverhead);
+
+    for (const QString &name : options_.channels) {
+      auto channel = std::make_unique<Channel>();
+      channel->self = this;
+      channel->name = name.toUtf8();
+      channel->tunnel = name == options_.tunnel;
+      channel->topic = std::make_unique<LibXR::Topic>(
+          channel->name.constData(), kMaxEcho + TopicEncoder::kOverhead,
+          &domain_);
+      channels_.push_back(std::move(channel));
+    }
+    for (const auto &channel : channels_) {
+      auto cb = LibXR::Topic::Callback::Create(
+          [](bool, Channel *channel, LibXR::RawData &data) {
+            channel->self->onChannelData(*channel, data);
+          },
+          channel.get());
+      channel->topic->RegisterCallback(cb);
+      server_.Register(*channel->topic);
+    }
+
+    auto cb = LibXR::Topic::Callback::Create(
+        [](bool, LinkSimulator *self, LibXR::RawData &data) {
+          self->onCommand(data);
+        },
+        this);
+    command_topic_.RegisterCallback(cb);
+    server_.Register(command_topic_);
+
+    socket_ = new QTcpSocket(this);
+    connect(socket_, &QTcpSocket::connected, this, &LinkSimulator::onConnected);
+    connect(socket_, &QTcpSocket::disconnected, this,
+            &LinkSimulator::onDisconnected);
+    connect(socket_, &QTcpSocket::readyRead, this, &LinkSimulator::onReadyRead);
+    connect(socket_, &QTcpSocket::errorOccurred, this, [this]() {
+      /* 连接失败不会触发 disconnected，这里同样安排重连 */
+      if (socket_->state() == QAbstractSocket::UnconnectedState) {
+        scheduleReconnect();
+      }
+    });
+    connect(socket_, &QTcpSocket::bytesWritten, this, [this]() {
+      if (options_.rate <= 0) {
+        generate();
+      }
+    });
+
+    trafficTimer_ = new QTimer(this);
+    trafficTimer_->setTimerType(Qt::PreciseTimer);
+    connect(trafficTimer_, &QTimer::timeout, this, &LinkSimulator::generate);
+    pingTimer_ = new QTimer(this);
+    connect(pingTimer_, &QTimer::timeout, this, &LinkSimulator::sendPing);
+    probeTimer_ = new QTimer(this);
+    connect(probeTimer_, &QTimer::timeout, this, &LinkSimulator::sendProbe);
+    reportTimer_ = new QTimer(this);
+    connect(reportTimer_, &QTimer::timeout, this, [this]() { report(false); });
+  }
+
+  void start() {
+    if (options_.duration_s > 0) {
+      QTimer::singleShot(options_.duration_s * 1000, this,
+                         &LinkSimulator::finish);
+    }
+    if (!options_.host.isEmpty()) {
+      std::printf("[sim] connecting to %s:%u\n",
+                  options_.host.toUtf8().constData(), options_.port);
+      socket_->connectToHost(options_.host, options_.port);
+      return;
+    }
+    startDiscovery();
+  }
+
+  /* 是否曾建立过连接（用于退出码） */
+  bool everConnected() const { return ever_connected_; }
+
+private:
+  struct Channel {
+    LinkSimulator *self = nullptr;
+    QByteArray name;
+    bool tunnel = false;
+    std::unique_ptr<LibXR::Topic> topic;
+    double budget = 0;
+    uint64_t seq = 0;
+  };
+
+  struct Totals {
+    uint64_t tx_bytes = 0;
+    uint64_t tx_packets = 0;
+    uint64_t rx_bytes = 0;
+    uint64_t echo_bytes = 0;
+    uint64_t probes_sent = 0;
+    uint64_t probes_lost = 0;
+  };
+
+  void startDiscovery() {
+    if (udp_ == nullptr) {
+      udp_ = new QUdpSocket(this);
+      connect(udp_, &QUdpSocket::readyRead, this,
+              &LinkSimulator::onDiscovery);
+      if (!udp_->bind(QHostAddress::AnyIPv4, options_.discovery_port,
+                      QUdpSocket::ShareAddress |
+                          QUdpSocket::ReuseAddressHint)) {
+        std::printf("[sim] failed to bind udp port %u\n",
+                    options_.discovery_port);
+        return;
+      }
+    }
+    discovering_ = true;
+    std::printf("[sim] waiting for discovery broadcast on udp %u\n",
+                options_.discovery_port);
+  }
+
+  void onDiscovery() {
+    while (udp_->hasPendingDatagrams()) {
+      QByteArray datagram(static_cast<int>(udp_->pendingDatagramSize()), 0);
+      QHostAddress sender;
+      udp_->readDatagram(datagram.data(), datagram.size(), &sender);
+      if (!discovering_ || !MatchesDiscovery(datagram)) {
+        continue;
+      }
+      discovering_ = false;
+      std::printf("[sim] discovered client at %s\n",
+                  sender.toString().toUtf8().constData());
+      socket_->connectToHost(sender, options_.port);
+    }
+  }
+
+  bool MatchesDiscovery(const QByteArray &datagram) const {
+    static const QByteArray kDefault = "XRobot Debug Tools Default Message";
+    static const QByteArray kFiltered = "XRobot Debug Tools Message Filtered:";
+    if (datagram == kDefault) {
+      return true;
+    }
+    return datagram.startsWith(kFiltered) &&
+           datagram.mid(kFiltered.size()) == options_.name.toUtf8();
+  }
+
+  void onConnected() {
+    ever_connected_ = true;
+    socket_->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+    std::printf("[sim] connected, %lld channels, rate %.0f B/s per channel, "
+                "packets %zu-%zu B, burst %d ms\n",
+                static_cast<long long>(channels_.size()), options_.rate,
+                options_.min_packet, options_.max_packet, options_.burst_ms);
+    last_tick_us_ = LibXR::QTTimebase::NowMicros();
+    window_start_us_ = last_tick_us_;
+    connected_us_ = last_tick_us_;
+    for (const auto &channel : channels_) {
+      channel->budget = 0;
+    }
+    sendPing();
+    trafficTimer_->start(std::max(1, options_.burst_ms));
+    if (options_.ping_ms > 0) {
+      pingTimer_->start(options_.ping_ms);
+    }
+    if (options_.probe_ms > 0) {
+      probeTimer_->start(options_.probe_ms);
+    }
+    reportTimer_->start(std::max(1, options_.report_s) * 1000);
+  }
+
+  void onDisconnected() {
+    std::printf("[sim] disconnected\n");
+    trafficTimer_->stop();
+    pingTimer_->stop();
+    probeTimer_->stop();
+    reportTimer_->stop();
+    scheduleReconnect();
+  }
+
+  /* 未指定 host 时回到发现阶段，否则 1 秒后重连 */
+  void scheduleReconnect() {
+    if (finished_ || reconnect_pending_) {
+      return;
+    }
+    if (options_.host.isEmpty()) {
+      startDiscovery();
+      return;
+    }
+    reconnect_pending_ = true;
+    QTimer::singleShot(1000, this, [this]() {
+      reconnect_pending_ = false;
+      if (!finished_ &&
+          socket_->state() == QAbstractSocket::UnconnectedState) {
+        socket_->connectToHost(options_.host, options_.port);
+      }
+    });
+  }
+
+  void onReadyRead() {
+    std::array<uint8_t, 64 * 1024> buffer;
+    for (;;) {
+      const qint64 n = socket_->read(reinterpret_cast<char *>(buffer.data()),
+                                     buffer.size());
+      if (n <= 0) {
+        break;
+      }
+      total_.rx_bytes += static_cast<uint64_t>(n);
+      server_.ParseData({buffer.data(), static_cast<size_t>(n)});
+    }
+  }
+
+  /* 按速率与批次生成各通道数据 */
+  void generate() {
+    if (socket_->state() != QAbstractSocket::ConnectedState) {
+      return;
+    }
+    const uint64_t now = LibXR::QTTimebase::NowMicros();
+    const double elapsed = (now - last_tick_us_) / 1e6;
+    last_tick_us_ = now;
+
+    for (const auto &channel : channels_) {
+      if (options_.rate > 0) {
+        /* 积压上限为两批，链路阻塞时不无限累积 */
+        const double burst = options_.rate * options_.burst_ms / 1000.0;
+        channel->budget =
+            std::min(channel->budget + options_.rate * elapsed,
+                     std::max(burst, 1.0 * options_.max_packet) * 2);
+      }
+      for (;;) {
+        if (socket_->bytesToWrite() >= kMaxBacklog) {
+          return;
+        }
+        const size_t size = NextPacketSize();
+        if (options_.rate > 0 && channel->budget < size) {
+          break;
+        }
+        writePacket(*channel, size);
+        channel->budget -= size;
+        if (options_.rate <= 0 && socket_->bytesToWrite() >= kMaxBacklog) {
+          return;
+        }
+      }
+    }
+  }
+
+  void writePacket(Channel &channel, size_t size) {
+    /* 负载为一行可读文本："[uart1 000123] abcd...\r\n" */
+    const int header = std::snprintf(
+        reinterpret_cast<char *>(payload_.data()), payload_.size(),
+        "[%s %06llu] ", channel.name.constData(),
+        static_cast<unsigned long long>(channel.seq++));
+    for (size_t i = std::min<size_t>(header, size); i < size; ++i) {
+      payload_[i] = static_cast<uint8_t>('a' + i % 26);
+    }
+    if (size >= 2) {
+      payload_[size - 2] = '\r';
+      payload_[size - 1] = '\n';
+    }
+    writeFrame(channel.topic->GetKey(), payload_.data(), size);
+    ++total_.tx_packets;
+  }
+
+  void writeFrame(uint32_t key, const void *data, size_t size) {
+    LibXR::Topic::PackData(key, {frame_.data(), size + TopicEncoder::kOverhead},
+                           {const_cast<void *>(data), size});
+    socket_->write(reinterpret_cast<const char *>(frame_.data()),
+                   static_cast<qint64>(size + TopicEncoder::kOverhead));
+    total_.tx_bytes += size + TopicEncoder::kOverhead;
+  }
+
+  void writeCommand(const Command &cmd) {
+    writeFrame(command_topic_.GetKey(), &cmd, sizeof(cmd));
+  }
+
+  void sendPing() {
+    Command cmd{};
+    cmd.type = Command::Type::PING;
+    writeCommand(cmd);
+    if (options_.remote_ping) {
+      cmd.type = Command::Type::REMOTE_PING;
+      writeCommand(cmd);
+    }
+  }
+
+  void sendProbe() {
+    Command cmd{};
+    cmd.type = Command::Type::PROBE;
+    cmd.data.probe.seq = next_probe_++;
+    Probe &slot = probes_[cmd.data.probe.seq % probes_.size()];
+    if (slot.seq != 0 && !slot.acked) {
+      ++total_.probes_lost;
+      ++window_lost_;
+    }
+    slot = {cmd.data.probe.seq, LibXR::QTTimebase::NowMicros(), false};
+    ++total_.probes_sent;
+    writeCommand(cmd);
+    socket_->flush();
+  }
+
+  void onCommand(LibXR::RawData &data) {
+    if (data.size_ > sizeof(Command)) {
+      return;
+    }
+    Command cmd{};
+    std::memcpy(&cmd, data.addr_, data.size_);
+    switch (cmd.type) {
+    case Command::Type::PROBE: {
+      Command ack{};
+      ack.type = Command::Type::PROBE_ACK;
+      ack.data.probe.seq = cmd.data.probe.seq;
+      writeCommand(ack);
+      socket_->flush();
+      break;
+    }
+    case Command::Type::PROBE_ACK: {
+      Probe &slot = probes_[cmd.data.probe.seq % probes_.size()];
+      if (slot.seq == cmd.data.probe.seq && !slot.acked) {
+        slot.acked = true;
+        const uint64_t rtt = LibXR::QTTimebase::NowMicros() - slot.sent_us;
+        rtt_.Record(rtt);
+        window_rtt_.Record(rtt);
+      }
+      break;
+    }
+    case Command::Type::CONFIG_UART:
+      std::printf("[sim] CONFIG_UART %u: %u baud\n",
+                  cmd.data.uart_config.uart_index,
+                  static_cast<unsigned>(cmd.data.uart_config.config.baudrate));
+      break;
+    case Command::Type::REBOOT:
+      std::printf("[sim] REBOOT\n");
+      break;
+    case Command::Type::RENAME:
+      std::printf("[sim] RENAME %.32s\n", cmd.data.device_name);
+      break;
+    default:
+      break;
+    }
+  }
+
+  void onChannelData(Channel &channel, LibXR::RawData &data) {
+    if (!options_.echo) {
+      return;
+    }
+    /* 透传通道是两层封包，回传内层负载 */
+    const uint8_t *payload = static_cast<const uint8_t *>(data.addr_);
+    size_t size = data.size_;
+    if (channel.tunnel) {
+      if (size < TopicEncoder::kOverhead) {
+        return;
+      }
+      payload += TopicEncoder::kHeaderSize;
+      size -= TopicEncoder::kOverhead;
+    }
+    size = std::min(size, kMaxEcho);
+    writeFrame(channel.topic->GetKey(), payload, size);
+    total_.echo_bytes += size;
+  }
+
+  size_t NextPacketSize() {
+    rng_ ^= rng_ << 13;
+    rng_ ^= rng_ >> 17;
+    rng_ ^= rng_ << 5;
+    return options_.min_packet +
+           rng_ % (options_.max_packet - options_.min_packet + 1);
+  }
+
+  void report(bool final) {
+    const uint64_t now = LibXR::QTTimebase::NowMicros();
+    const uint64_t start = final ? connected_us_ : window_start_us_;
+    const double seconds = std::max(1e-6, (now - start) / 1e6);
+    const Totals &base = final ? Totals{} : window_base_;
+    const LatencyHistogram &rtt = final ? rtt_ : window_rtt_;
+    const uint64_t lost = final ? total_.probes_lost : window_lost_;
+
+    std::printf(
+        "[sim]%s tx %.1f KiB/s (%.0f pkt/s), rx %.1f KiB/s, rtt p50 %.2f / "
+        "p99 %.2f / max %.2f ms, probes lost %llu/%llu\n",
+        final ? " total:" : "",
+        (total_.tx_bytes - base.tx_bytes) / seconds / 1024.0,
+        (total_.tx_packets - base.tx_packets) / seconds,
+        (total_.rx_bytes - base.rx_bytes) / seconds / 1024.0,
+        rtt.Percentile(0.50) / 1000.0, rtt.Percentile(0.99) / 1000.0,
+        rtt.Max() / 1000.0, static_cast<unsigned long long>(lost),
+        static_cast<unsigned long long>(total_.probes_sent -
+                                        base.probes_sent));
+    std::fflush(stdout);
+
+    window_base_ = total_;
+    window_start_us_ = now;
+    window_rtt_.Reset();
+    window_lost_ = 0;
+  }
+
+  void finish() {
+    finished_ = true;
+    if (ever_connected_) {
+      report(true);
+    } else {
+      std::printf("[sim] never connected\n");
+    }
+    socket_->disconnectFromHost();
+    QCoreApplication::exit(ever_connected_ ? 0 : 1);
+  }
+
+  struct Probe {
+    uint32_t seq = 0;
+    uint64_t sent_us = 0;
+    bool acked = false;
+  };
+
+  static constexpr size_t kServerBuffer = 256 * 1024;
+  static constexpr size_t kMaxEcho = 4096;
+  static constexpr qint64 kMaxBacklog = 1024 * 1024;
+
+  SimOptions options_;
+  LibXR::Topic::Domain domain_;
+  LibXR::Topic command_topic_;
+  LibXR::Topic::Server server_;
+  std::vector<std::unique_ptr<Channel>> channels_;
+
+  QTcpSocket *socket_ = nullptr;
+  QUdpSocket *udp_ = nullptr;
+  QTimer *trafficTimer_ = nullptr;
+  QTimer *pingTimer_ = nullptr;
+  QTimer *probeTimer_ = nullptr;
+  QTimer *reportTimer_ = nullptr;
+  bool discovering_ = false;
+  bool ever_connected_ = false;
+  bool finished_ = false;
+  bool reconnect_pending_ = false;
+
+  std::vector<uint8_t> payload_;
+  std::vector<uint8_t> frame_;
+  uint32_t rng_ = 0x9e3779b9u;
+
+  uint64_t last_tick_us_ = 0;
+  uint64_t connected_us_ = 0;
+  uint64_t window_start_us_ = 0;
+  Totals total_;
+  Totals window_base_;
+  std::array<Probe, 64> probes_{};
+  uint32_t next_probe_ = 1;
+  uint64_t window_lost_ = 0;
+  LatencyHistogram rtt_;
+  LatencyHistogram window_rtt_;
+};
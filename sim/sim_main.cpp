@@ -0,0 +1,103 @@
+#include "LinkSimulator.hpp"
+#include "QTTimebase.hpp"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+
+#include <cstdio>
+
+/*
+ * NetDebugLinkSim 入口：
+ *  - 无 --host 时等待客户端的 UDP 发现广播，行为与真实设备一致；
+ *  - 例如 `NetDebugLinkSim --rate 0 --packet-size 64-1024 --duration 30`
+ *    以尽力速率压测 30 秒后输出汇总。
+ */
+int main(int argc, char *argv[]) {
+  /* 初始化 LibXR 时间基准（单调时钟，微秒精度） */
+  LibXR::QTTimebase timebase;
+
+  QCoreApplication app(argc, argv);
+  QCommandLineParser parser;
+  parser.setApplicationDescription("NetDebugLink device simulator");
+  parser.addHelpOption();
+
+  SimOptions defaults;
+  QCommandLineOption name_option(
+      "name", "Device name matched against filtered discovery.", "name");
+  QCommandLineOption host_option(
+      "host", "Connect to HOST directly instead of waiting for discovery.",
+      "host");
+  QCommandLineOption port_option("port", "Client TCP port.", "port",
+                                 QString::number(defaults.port));
+  QCommandLineOption discovery_port_option(
+      "discovery-port", "UDP discovery port.", "port",
+      QString::number(defaults.discovery_port));
+  parser.addOptions(
+      {name_option, host_option, port_option, discovery_port_option});
+
+  QCommandLineOption channels_option(
+      "channels", "Channel topic names.", "list",
+      defaults.channels.join(','));
+  QCommandLineOption tunnel_option(
+      "tunnel", "Tunnel channel name (nested outbound packets).", "name",
+      defaults.tunnel);
+  QCommandLineOption rate_option(
+      "rate", "Bytes per second per channel, 0 saturates the link.", "bytes",
+      QString::number(defaults.rate));
+  QCommandLineOption packet_size_option(
+      "packet-size", "Payload size, \"N\" or \"MIN-MAX\".", "size",
+      QString("%1-%2").arg(defaults.min_packet).arg(defaults.max_packet));
+  QCommandLineOption burst_option(
+      "burst-ms", "Generation period; each burst carries rate x period.",
+      "ms", QString::number(defaults.burst_ms));
+  parser.addOptions({channels_option, tunnel_option, rate_option,
+                     packet_size_option, burst_option});
+
+  QCommandLineOption ping_option("ping-interval", "PING period, 0 disables.",
+                                 "ms", QString::number(defaults.ping_ms));
+  QCommandLineOption probe_option("probe-interval",
+                                  "PROBE period, 0 disables.", "ms",
+                                  QString::number(defaults.probe_ms));
+  QCommandLineOption no_remote_ping_option(
+      "no-remote-ping", "Do not send REMOTE_PING (MiniPC offline).");
+  QCommandLineOption echo_option("echo",
+                                 "Echo client uart writes back to the client.");
+  QCommandLineOption duration_option(
+      "duration", "Run time in seconds, 0 runs until interrupted.", "s", "0");
+  QCommandLineOption report_option("report-interval",
+                                   "Report period in seconds.", "s", "1");
+  parser.addOptions({ping_option, probe_option, no_remote_ping_option,
+                     echo_option, duration_option, report_option});
+  parser.process(app);
+
+  SimOptions options;
+  options.name = parser.value(name_option);
+  options.host = parser.value(host_option);
+  options.port = static_cast<quint16>(parser.value(port_option).toUInt());
+  options.discovery_port =
+      static_cast<quint16>(parser.value(discovery_port_option).toUInt());
+  options.channels =
+      parser.value(channels_option).split(',', Qt::SkipEmptyParts);
+  options.tunnel = parser.value(tunnel_option);
+  options.rate = parser.value(rate_option).toDouble();
+  const QStringList sizes = parser.value(packet_size_option).split('-');
+  options.min_packet = sizes.value(0).toULongLong();
+  options.max_packet = sizes.size() > 1 ? sizes.value(1).toULongLong()
+                                        : options.min_packet;
+  options.burst_ms = parser.value(burst_option).toInt();
+  options.ping_ms = parser.value(ping_option).toInt();
+  options.probe_ms = parser.value(probe_option).toInt();
+  options.remote_ping = !parser.isSet(no_remote_ping_option);
+  options.echo = parser.isSet(echo_option);
+  options.duration_s = parser.value(duration_option).toInt();
+  options.report_s = parser.value(report_option).toInt();
+
+  if (options.channels.isEmpty() || options.min_packet == 0) {
+    std::fprintf(stderr, "invalid --channels or --packet-size\n");
+    return 2;
+  }
+
+  LinkSimulator simulator(options);
+  simulator.start();
+  return app.exec();
+}